@@ -10,8 +10,18 @@ pub fn build(b: *std.Build) void {
         .root_source_file = b.path("src/c_api.zig"),
         .target = target,
         .optimize = optimize,
+        // getenv must see the host process environment (ZREGEXP_CPU)
+        .link_libc = true,
     });
 
+    // Patterns compiled to specialized C functions: -Dcomptime-pattern=symbol=pattern
+    const comptime_patterns = b.option(
+        []const []const u8,
+        "comptime-pattern",
+        "Export a comptime-specialized matcher as C symbol (symbol=pattern, repeatable)",
+    ) orelse &.{};
+    c_api_module.addImport("comptime_patterns", comptimePatternsModule(b, comptime_patterns, target, optimize));
+
     // Create library module for main (for compatibility)
     const lib_module = b.createModule(.{
         .root_source_file = b.path("src/main.zig"),
@@ -19,6 +29,26 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
 
+    // SIMD kernels for CPU levels above the target, picked at runtime from CPUID
+    const simd_enabled = b.option(
+        bool,
+        "simd-variants",
+        "Link AVX2/AVX-512 kernel variants selected at runtime (default: true)",
+    ) orelse true;
+    const simd_variants = if (simd_enabled) simdVariants(b, target, optimize) else &.{};
+
+    var simd_names: std.ArrayList([]const u8) = .empty;
+    for (simd_variants) |variant| {
+        simd_names.append(b.allocator, variant.name) catch @panic("OOM");
+        c_api_module.addObject(variant.object);
+        lib_module.addObject(variant.object);
+    }
+
+    const build_options = b.addOptions();
+    build_options.addOption([]const []const u8, "simd_variants", simd_names.items);
+    c_api_module.addOptions("build_options", build_options);
+    lib_module.addOptions("build_options", build_options);
+
     // =============================================================================
     // Library Compilation
     // =============================================================================
@@ -91,6 +121,100 @@ pub fn build(b: *std.Build) void {
     const integration_test_step = b.step("test-integration", "Run integration tests only");
     integration_test_step.dependOn(&run_integration_tests.step);
 
+    // =============================================================================
+    // Benchmarks
+    // =============================================================================
+
+    // Benchmarks are only meaningful optimized, whatever -Doptimize says
+    const bench_optimize = b.option(
+        std.builtin.OptimizeMode,
+        "bench-optimize",
+        "Optimization mode for zig build bench (default: ReleaseFast)",
+    ) orelse .ReleaseFast;
+
+    const bench_lib_module = b.createModule(.{
+        .root_source_file = b.path("src/main.zig"),
+        .target = target,
+        .optimize = bench_optimize,
+    });
+    bench_lib_module.addOptions("build_options", build_options);
+    const bench_simd_variants = if (simd_enabled) simdVariants(b, target, bench_optimize) else &.{};
+    for (bench_simd_variants) |variant| bench_lib_module.addObject(variant.object);
+
+    const bench_module = b.createModule(.{
+        .root_source_file = b.path("tests/benchmarks/main.zig"),
+        .target = target,
+        .optimize = bench_optimize,
+    });
+    bench_module.addImport("zregexp", bench_lib_module);
+
+    const bench_exe = b.addExecutable(.{
+        .name = "zregexp-bench",
+        .root_module = bench_module,
+    });
+
+    const run_bench = b.addRunArtifact(bench_exe);
+    if (b.args) |args| run_bench.addArgs(args);
+
+    const bench_step = b.step("bench", "Run benchmarks (suites and options after --, JSON on stdout)");
+    bench_step.dependOn(&run_bench.step);
+
+    // C++ comparison with std::regex, through zregexp.hpp
+    const bench_c_api_module = b.createModule(.{
+        .root_source_file = b.path("src/c_api.zig"),
+        .target = target,
+        .optimize = bench_optimize,
+        .link_libc = true,
+    });
+    bench_c_api_module.addImport("comptime_patterns", comptimePatternsModule(b, &.{}, target, bench_optimize));
+    bench_c_api_module.addOptions("build_options", build_options);
+    for (bench_simd_variants) |variant| bench_c_api_module.addObject(variant.object);
+
+    const bench_lib = b.addLibrary(.{
+        .name = "zregexp-bench",
+        .root_module = bench_c_api_module,
+        .linkage = .static,
+    });
+
+    const compare_module = b.createModule(.{
+        .target = target,
+        .optimize = bench_optimize,
+        .link_libcpp = true,
+    });
+    compare_module.addCSourceFile(.{
+        .file = b.path("tests/benchmarks/comparison.cpp"),
+        .flags = &.{"-std=c++17"},
+    });
+    compare_module.addIncludePath(b.path("include"));
+    compare_module.linkLibrary(bench_lib);
+
+    const compare_exe = b.addExecutable(.{
+        .name = "zregexp-bench-compare",
+        .root_module = compare_module,
+    });
+
+    // Both engines see the corpora the Zig suites generate
+    const gen_corpus = b.addExecutable(.{
+        .name = "gen-corpus",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("tests/benchmarks/gen_corpus.zig"),
+            .target = b.graph.host,
+            .optimize = .ReleaseSafe,
+        }),
+    });
+
+    const run_compare = b.addRunArtifact(compare_exe);
+    for ([_][]const u8{ "weblog", "html", "prose", "dna" }) |kind| {
+        const gen = b.addRunArtifact(gen_corpus);
+        gen.addArgs(&.{ kind, "262144", "24301" });
+        const path = gen.addOutputFileArg(b.fmt("{s}.txt", .{kind}));
+        run_compare.addPrefixedFileArg(b.fmt("{s}=", .{kind}), path);
+    }
+    if (b.args) |args| run_compare.addArgs(args);
+
+    const compare_step = b.step("bench-compare", "Compare with std::regex from C++ (options after --, JSON on stdout)");
+    compare_step.dependOn(&run_compare.step);
+
     // =============================================================================
     // Library-specific build steps
     // =============================================================================
@@ -107,3 +231,88 @@ pub fn build(b: *std.Build) void {
     const shared_step = b.step("shared", "Build shared library only");
     shared_step.dependOn(&shared_lib.step);
 }
+
+/// Kernel object for one CPU level, exporting zregexp_simd_<name>_*
+const SimdVariant = struct {
+    name: []const u8,
+    object: *std.Build.Step.Compile,
+};
+
+/// x86_64 kernel objects for the levels `target` does not already guarantee
+fn simdVariants(
+    b: *std.Build,
+    target: std.Build.ResolvedTarget,
+    optimize: std.builtin.OptimizeMode,
+) []const SimdVariant {
+    if (target.result.cpu.arch != .x86_64) return &.{};
+
+    const levels = [_]struct { name: []const u8, width: usize, feature: std.Target.x86.Feature }{
+        .{ .name = "avx2", .width = 32, .feature = .avx2 },
+        .{ .name = "avx512", .width = 64, .feature = .avx512bw },
+    };
+
+    var variants: std.ArrayList(SimdVariant) = .empty;
+    for (levels) |level| {
+        // The in-unit baseline kernels already use this width
+        if (std.Target.x86.featureSetHas(target.result.cpu.features, level.feature)) continue;
+
+        var query = target.query;
+        query.cpu_features_add.addFeature(@intFromEnum(level.feature));
+
+        const options = b.addOptions();
+        options.addOption([]const u8, "name", level.name);
+        options.addOption(usize, "width", level.width);
+
+        const module = b.createModule(.{
+            .root_source_file = b.path("src/utils/simd_variant.zig"),
+            .target = b.resolveTargetQuery(query),
+            .optimize = optimize,
+            .pic = true,
+        });
+        module.addOptions("simd_variant_options", options);
+
+        const object = b.addObject(.{
+            .name = b.fmt("zregexp_simd_{s}", .{level.name}),
+            .root_module = module,
+        });
+        variants.append(b.allocator, .{ .name = level.name, .object = object }) catch @panic("OOM");
+    }
+    return variants.items;
+}
+
+/// Module listing the -Dcomptime-pattern entries; c_api.zig passes each to
+/// comptime_regex.exportC. It holds data only, so every source file stays
+/// in the one c_api module.
+fn comptimePatternsModule(
+    b: *std.Build,
+    patterns: []const []const u8,
+    target: std.Build.ResolvedTarget,
+    optimize: std.builtin.OptimizeMode,
+) *std.Build.Module {
+    var source: std.ArrayList(u8) = .empty;
+    const writer = source.writer(b.allocator);
+
+    writer.writeAll("pub const entries = [_]struct { []const u8, []const u8 }{\n") catch @panic("OOM");
+    for (patterns) |entry| {
+        const eq = std.mem.indexOfScalar(u8, entry, '=') orelse
+            std.debug.panic("-Dcomptime-pattern expects symbol=pattern, got '{s}'", .{entry});
+        for (entry[0..eq]) |c| {
+            if (!std.ascii.isAlphanumeric(c) and c != '_') {
+                std.debug.panic("-Dcomptime-pattern symbol '{s}' is not a C identifier", .{entry[0..eq]});
+            }
+        }
+
+        // Pattern bytes as an array literal, so no escaping is needed
+        writer.print("    .{{ \"{s}\", &[_]u8{{", .{entry[0..eq]}) catch @panic("OOM");
+        for (entry[eq + 1 ..]) |c| writer.print(" {d},", .{c}) catch @panic("OOM");
+        writer.writeAll(" } },\n") catch @panic("OOM");
+    }
+    writer.writeAll("};\n") catch @panic("OOM");
+
+    const files = b.addWriteFiles();
+    return b.createModule(.{
+        .root_source_file = files.add("comptime_patterns.zig", source.items),
+        .target = target,
+        .optimize = optimize,
+    });
+}
@@ -55,27 +55,71 @@ typedef struct ZMatch ZMatch;
  */
 typedef struct ZMatchList ZMatchList;
 
+/**
+ * Opaque handle to a hot-reloadable rule table.
+ */
+typedef struct ZRuleTable ZRuleTable;
+
+/**
+ * Opaque handle to a sharded rule set.
+ */
+typedef struct ZShardedSet ZShardedSet;
+
+/**
+ * Opaque handle to a mapped rule registry.
+ */
+typedef struct ZRegistry ZRegistry;
+
 /* =============================================================================
  * Compilation Options
  * ===========================================================================*/
 
 /**
  * Options for compiling a regular expression.
+ *
+ * A limit of 0 takes the library default, so a zero-initialized struct
+ * (`ZRegexOptions o = {0};`) keeps the default ReDoS protection. Set a limit
+ * to its type's maximum (UINT32_MAX / UINT64_MAX) to remove it.
  */
 typedef struct {
     /** Enable case-insensitive matching */
     bool case_insensitive;
 
-    /** Maximum recursion depth (default: 1000) */
+    /** Maximum recursion depth (default: 1000; 0 = default, UINT32_MAX = unlimited) */
     uint32_t max_recursion_depth;
 
-    /** Maximum execution steps (default: 1000000) */
+    /** Maximum execution steps (default: 1000000; 0 = default, UINT64_MAX = unlimited) */
     uint64_t max_steps;
 
+    /** Bitwise OR of ZREGEXP_OPT_* flags (default: 0) */
+    uint32_t flags;
+
+    /**
+     * Maximum compiled program size in bytes; larger patterns (e.g. nested
+     * counted repeats) fail with ZREGEXP_ERROR_PROGRAM_TOO_LARGE
+     * (default: unlimited; 0 = default)
+     */
+    uint32_t max_program_bytes;
+
+    /**
+     * Maximum stack a search may use for backtracking; deeper searches fail
+     * with ZREGEXP_ERROR_SCRATCH_LIMIT (default: unlimited; 0 = default)
+     */
+    uint32_t max_scratch_bytes;
+
     /** Reserved for future use */
-    uint32_t reserved[4];
+    uint32_t reserved[1];
 } ZRegexOptions;
 
+/** Count executions and backtracks per instruction (see zregexp_profile_dump) */
+#define ZREGEXP_OPT_PROFILE (1u << 0)
+
+/**
+ * Enable the result cache with its default size, as zregexp_cache_enable(re,
+ * 0, 0) does; rule tables and sharded sets get one cache per set (or shard)
+ */
+#define ZREGEXP_OPT_RESULT_CACHE (1u << 1)
+
 /**
  * Get default options.
  *
@@ -103,6 +147,33 @@ ZRegexOptions zregexp_default_options(void);
  */
 ZRegex* zregexp_compile(const char* pattern, const ZRegexOptions* options);
 
+/** Glob flag: match letters case-insensitively (ASCII) */
+#define ZREGEXP_GLOB_CASE_INSENSITIVE (1u << 0)
+
+/** Glob flag: let '*', '?' and negated brackets match '/' */
+#define ZREGEXP_GLOB_NO_PATHNAME (1u << 1)
+
+/**
+ * Compile a shell-style glob pattern.
+ *
+ * Supports '*' (within one path segment), '?', '**' (across segments,
+ * '**' followed by '/' also matches zero segments), bracket expressions
+ * ("[a-z]", "[!abc]") and backslash escapes. Globs are anchored at both ends.
+ * The result is an ordinary ZRegex usable with every matching function.
+ *
+ * @param pattern The glob pattern string (null-terminated)
+ * @param flags   Bitwise OR of ZREGEXP_GLOB_* flags (0 for defaults)
+ * @return Compiled regex handle, or NULL on error
+ *
+ * @example
+ *   ZRegex* re = zregexp_compile_glob("*.[ch]", 0);
+ *   if (re && zregexp_is_match(re, "util.c")) {
+ *       printf("Matched!\n");
+ *   }
+ *   zregexp_free(re);
+ */
+ZRegex* zregexp_compile_glob(const char* pattern, uint32_t flags);
+
 /**
  * Free a compiled regex.
  *
@@ -162,6 +233,77 @@ ZMatchList* zregexp_find_all(ZRegex* regex, const char* input);
  */
 bool zregexp_is_match(ZRegex* regex, const char* input);
 
+/* =============================================================================
+ * Execution Statistics
+ * ===========================================================================*/
+
+/**
+ * Engine that executed a matching call.
+ */
+typedef enum {
+    ZREGEXP_ENGINE_NONE = 0,      /**< No engine ran (prefilter rejected the input) */
+    ZREGEXP_ENGINE_BACKTRACK = 1, /**< Recursive backtracking matcher */
+    ZREGEXP_ENGINE_BACKTRACK_DECODED = 2 /**< Backtracking over the pre-decoded program (hot tier) */
+} ZRegexEngine;
+
+/**
+ * Work counters for a single matching call.
+ */
+typedef struct {
+    /** Instructions executed, summed over start positions */
+    uint64_t steps;
+
+    /** Times a failed branch fell back to an alternative */
+    uint64_t backtracks;
+
+    /** Deepest recursion reached */
+    uint64_t max_depth;
+
+    /** Start positions attempted */
+    uint64_t start_positions;
+
+    /** Calls whose input passed the literal prefilter */
+    uint64_t prefilter_candidates;
+
+    /** Calls rejected by the literal prefilter without running the matcher */
+    uint64_t prefilter_skips;
+
+    /** Input bytes examined (prefilter scan plus furthest matcher position) */
+    uint64_t bytes_scanned;
+
+    /** Engine used (ZRegexEngine) */
+    uint32_t engine;
+
+    /** 1 if the result (or, for find, the match start) came from the result cache */
+    uint32_t cache_hits;
+} ZExecStats;
+
+/**
+ * Find the first match and report execution statistics.
+ *
+ * @param regex Compiled regex
+ * @param input Input string to search (null-terminated)
+ * @param stats Receives the call's statistics, also on error (can be NULL)
+ * @return Match result, or NULL if no match found
+ *
+ * @example
+ *   ZExecStats stats;
+ *   ZMatch* match = zregexp_find_ex(re, input, &stats);
+ *   printf("steps=%llu backtracks=%llu\n",
+ *          (unsigned long long)stats.steps, (unsigned long long)stats.backtracks);
+ */
+ZMatch* zregexp_find_ex(ZRegex* regex, const char* input, ZExecStats* stats);
+
+/**
+ * Test if the pattern matches the input and report execution statistics.
+ *
+ * @param regex Compiled regex
+ * @param input Input string to test (null-terminated)
+ * @param stats Receives the call's statistics, also on error (can be NULL)
+ * @return true if match found, false otherwise
+ */
+bool zregexp_is_match_ex(ZRegex* regex, const char* input, ZExecStats* stats);
+
 /* =============================================================================
  * Match Result Functions
  * ===========================================================================*/
@@ -267,6 +409,669 @@ char* zregexp_replace(ZRegex* regex, const char* input, const char* replacement)
  */
 void zregexp_string_free(char* str);
 
+/* =============================================================================
+ * Profiling
+ *
+ * A regex compiled with ZREGEXP_OPT_PROFILE counts, for every bytecode
+ * instruction, how often it was executed and how often it returned without
+ * a match. Counting adds a small cost to every step, so leave it off in
+ * production builds.
+ * ===========================================================================*/
+
+/**
+ * Render the profile of a regex compiled with ZREGEXP_OPT_PROFILE.
+ *
+ * Each line shows the instruction offset, execution count, backtrack count,
+ * a heatmap bar relative to the hottest instruction, the disassembled
+ * instruction, and the pattern byte range it was generated from.
+ *
+ * @param regex Compiled regex
+ * @return Profile text (must be freed with zregexp_string_free), or NULL if
+ *         the regex was not compiled with profiling
+ *
+ * @example
+ *   ZRegexOptions opts = zregexp_default_options();
+ *   opts.flags |= ZREGEXP_OPT_PROFILE;
+ *   ZRegex* re = zregexp_compile("(a|b)*c", &opts);
+ *   zregexp_is_match(re, "ababab");
+ *   char* dump = zregexp_profile_dump(re);
+ *   printf("%s", dump);
+ *   zregexp_string_free(dump);
+ */
+char* zregexp_profile_dump(ZRegex* regex);
+
+/**
+ * Clear the profile counters (no-op if the regex is not profiled).
+ *
+ * @param regex Compiled regex
+ */
+void zregexp_profile_reset(ZRegex* regex);
+
+/**
+ * Export the alternation branch counters of a profiled regex.
+ *
+ * For each alternation, the profile counts how many matches went through
+ * its first and its second branch. The text can be saved and imported with
+ * zregexp_branch_profile_import into a regex compiled from the same pattern
+ * and options, e.g. by a build that was not compiled with profiling.
+ *
+ * @param regex Compiled regex (with ZREGEXP_OPT_PROFILE)
+ * @return Profile text (must be freed with zregexp_string_free), or NULL if
+ *         the regex was not compiled with profiling
+ */
+char* zregexp_branch_profile_export(ZRegex* regex);
+
+/**
+ * Reorder alternations by an exported branch profile.
+ *
+ * zregexp_is_match then tries the branch of each alternation that matched
+ * more often first. Answers do not change; only the backtracking needed to
+ * reach them does. zregexp_find and zregexp_find_all keep leftmost-first
+ * order. Programs with possessive quantifiers are never reordered.
+ * Call before sharing the regex between threads.
+ *
+ * @param regex Compiled regex
+ * @param profile Text from zregexp_branch_profile_export
+ * @return true on success; false with ZREGEXP_ERROR_INVALID_PROFILE if the
+ *         profile is malformed or was recorded for a different program
+ */
+bool zregexp_branch_profile_import(ZRegex* regex, const char* profile);
+
+/**
+ * Reorder alternations by the regex's own profile counters.
+ *
+ * Same as exporting and importing the profile in one step.
+ *
+ * @param regex Compiled regex (with ZREGEXP_OPT_PROFILE)
+ * @return true on success, false if the regex is not profiled
+ */
+bool zregexp_branch_reorder(ZRegex* regex);
+
+/* =============================================================================
+ * Slow Log
+ *
+ * A process-wide ring buffer of searches that crossed a step or latency
+ * threshold. Matching threads append without locking; when the ring is full
+ * new entries are dropped and counted. Disabled until a threshold is set.
+ * ===========================================================================*/
+
+/** Maximum number of input bytes sampled per slow-log entry */
+#define ZREGEXP_SLOW_SAMPLE_CAPACITY 64
+
+/**
+ * One slow search.
+ */
+typedef struct {
+    /** Id of the pattern (see zregexp_regex_id) */
+    uint64_t pattern_id;
+
+    /** Length of the searched input in bytes */
+    uint64_t input_len;
+
+    /** Instructions executed */
+    uint64_t steps;
+
+    /** Wall-clock duration in nanoseconds */
+    uint64_t duration_ns;
+
+    /** Engine that ran the search (ZRegexEngine) */
+    uint32_t engine;
+
+    /** Bytes of sample in use */
+    uint32_t sample_len;
+
+    /** Leading bytes of the input (not null-terminated) */
+    uint8_t sample[ZREGEXP_SLOW_SAMPLE_CAPACITY];
+} ZSlowEntry;
+
+/**
+ * Get the process-unique id of a compiled regex, as reported in slow-log entries.
+ *
+ * @param regex Compiled regex
+ * @return Pattern id
+ */
+uint64_t zregexp_regex_id(const ZRegex* regex);
+
+/**
+ * Configure the slow log.
+ *
+ * A search is recorded when it executes at least step_threshold steps or
+ * takes at least latency_threshold_ns nanoseconds. A zero threshold is
+ * ignored; both zero disables logging.
+ *
+ * @param step_threshold Step threshold (0 = off)
+ * @param latency_threshold_ns Latency threshold in nanoseconds (0 = off)
+ * @param sample_bytes Input bytes to copy into each entry (at most ZREGEXP_SLOW_SAMPLE_CAPACITY)
+ */
+void zregexp_slow_log_configure(uint64_t step_threshold, uint64_t latency_threshold_ns, size_t sample_bytes);
+
+/**
+ * Move recorded entries out of the slow log, oldest first.
+ *
+ * @param entries Output array
+ * @param max_entries Capacity of entries
+ * @return Number of entries written
+ *
+ * @example
+ *   ZSlowEntry entries[128];
+ *   size_t n = zregexp_slow_log_drain(entries, 128);
+ *   for (size_t i = 0; i < n; i++) {
+ *       printf("pattern %llu: %llu steps\n", entries[i].pattern_id, entries[i].steps);
+ *   }
+ */
+size_t zregexp_slow_log_drain(ZSlowEntry* entries, size_t max_entries);
+
+/**
+ * Number of entries dropped because the slow log was full.
+ */
+uint64_t zregexp_slow_log_dropped(void);
+
+/* =============================================================================
+ * Metrics
+ *
+ * Opt-in per-regex counters (calls, matches, errors by kind, bytes scanned)
+ * and a log-linear latency histogram, rendered for all regexes at once in
+ * the Prometheus text exposition format.
+ * ===========================================================================*/
+
+/**
+ * Start collecting metrics for a regex.
+ *
+ * Call before sharing the regex between threads. Calling again renames the
+ * series without resetting them. Metrics are removed when the regex is freed.
+ *
+ * @param regex Compiled regex
+ * @param name Value of the "regex" label (null-terminated); copied
+ * @return true on success, false on allocation failure
+ */
+bool zregexp_metrics_enable(ZRegex* regex, const char* name);
+
+/**
+ * Render the metrics of every regex with metrics enabled.
+ *
+ * Works like snprintf: writes at most buf_len - 1 bytes plus a terminating
+ * null and returns the full length of the output, so a return value
+ * >= buf_len means the buffer was too small.
+ *
+ * @param buf Output buffer (may be NULL when buf_len is 0)
+ * @param buf_len Size of buf in bytes
+ * @return Length of the complete output, excluding the terminating null
+ *
+ * @example
+ *   size_t len = zregexp_metrics_render(NULL, 0);
+ *   char* text = malloc(len + 1);
+ *   zregexp_metrics_render(text, len + 1);
+ */
+size_t zregexp_metrics_render(char* buf, size_t buf_len);
+
+/* =============================================================================
+ * Memory Accounting
+ *
+ * Every allocation the C API makes goes through a counting wrapper around
+ * the library allocator, so the process-wide footprint and its high-water
+ * mark can be read at any time. Counters are read without locking; a
+ * snapshot taken while other threads allocate is approximate.
+ * ===========================================================================*/
+
+/** Heap bytes owned by one regex */
+typedef struct {
+    /** Bytecode, prefilter literal and source map */
+    size_t program_bytes;
+
+    /** Profile counters (ZREGEXP_OPT_PROFILE) */
+    size_t profile_bytes;
+
+    /** Metrics counters and histogram (zregexp_metrics_enable) */
+    size_t metrics_bytes;
+
+    /** Result cache (zregexp_cache_enable) */
+    size_t cache_bytes;
+
+    /** Tiering counters and the pre-decoded program once promoted */
+    size_t tier_bytes;
+
+    /** Sum of the above plus the ZRegex handle */
+    size_t total_bytes;
+} ZMemoryUsage;
+
+/** Process-wide memory use of the library */
+typedef struct {
+    /** Bytes currently allocated by the library */
+    size_t heap_bytes;
+
+    /** Highest heap_bytes has been since startup */
+    size_t peak_heap_bytes;
+
+    /** Allocations not yet freed */
+    size_t live_allocations;
+
+    /** Bytecode, prefilters and source maps of all live regexes */
+    size_t program_bytes;
+
+    /** Result caches of all live regexes and rule sets */
+    size_t cache_bytes;
+
+    /**
+     * Remainder of heap_bytes not covered by the fields above: handles,
+     * profiles, metrics, tier state, rule sets and search scratch of calls in
+     * progress. Not a separate counter, so no single category.
+     */
+    size_t other_bytes;
+
+    /** Bytes held by live ZMatch and ZMatchList objects */
+    size_t result_bytes;
+
+    /** ZMatch objects not yet freed with zregexp_match_free */
+    size_t live_matches;
+
+    /** ZMatchList objects not yet freed with zregexp_match_list_free */
+    size_t live_match_lists;
+} ZMemoryStats;
+
+/**
+ * Heap bytes owned by a regex.
+ *
+ * @param regex Compiled regex
+ * @param usage Receives the breakdown by category (can be NULL)
+ * @return Total bytes, same as usage->total_bytes
+ */
+size_t zregexp_memory_usage(const ZRegex* regex, ZMemoryUsage* usage);
+
+/**
+ * Read the library's process-wide memory counters.
+ *
+ * @param stats Receives the counters
+ *
+ * @example
+ *   ZMemoryStats mem;
+ *   zregexp_memory_stats(&mem);
+ *   printf("%zu bytes live, peak %zu\n", mem.heap_bytes, mem.peak_heap_bytes);
+ */
+void zregexp_memory_stats(ZMemoryStats* stats);
+
+/* =============================================================================
+ * Result Cache
+ *
+ * For workloads that see the same short values again and again (user
+ * agents, referrers, header values), a regex can remember recent results
+ * keyed by the input bytes. A repeated zregexp_is_match() is answered
+ * without running the matcher; a repeated zregexp_find() only retries the
+ * known start position to rebuild the captures. Inputs are compared
+ * byte for byte, so results are always exact. The cache has a fixed size
+ * and is sharded, so it is safe and cheap to use from many threads.
+ * ===========================================================================*/
+
+/** Result cache counters */
+typedef struct {
+    uint64_t hits;      /**< Lookups that found the input */
+    uint64_t misses;    /**< Lookups of cacheable inputs that did not */
+    uint64_t evictions; /**< Entries replaced by a different input */
+} ZCacheStats;
+
+/**
+ * Enable (or replace) the result cache of a regex.
+ *
+ * Call before sharing the regex between threads.
+ *
+ * @param regex Compiled regex
+ * @param max_bytes Cache size in bytes (0 for default: 256 KiB)
+ * @param max_input_len Longer inputs are not cached (0 for default: 256)
+ * @return true on success, false on error (see zregexp_last_error)
+ */
+bool zregexp_cache_enable(ZRegex* regex, size_t max_bytes, size_t max_input_len);
+
+/**
+ * Read the result cache counters of a regex.
+ *
+ * @param regex Compiled regex
+ * @param stats Output counters
+ * @return false if the regex has no cache
+ *
+ * @example
+ *   ZCacheStats cs;
+ *   if (zregexp_cache_stats(re, &cs) && cs.hits + cs.misses > 0) {
+ *       printf("hit rate %.1f%%\n", 100.0 * cs.hits / (cs.hits + cs.misses));
+ *   }
+ */
+bool zregexp_cache_stats(const ZRegex* regex, ZCacheStats* stats);
+
+/* =============================================================================
+ * Tiered Execution
+ *
+ * Regexes start out interpreted. Once tiering is configured, each regex
+ * counts its calls and input bytes; when either crosses its threshold a
+ * background thread pre-decodes the program and later searches use it.
+ * Results are identical in every tier. Tiering is off by default.
+ * ===========================================================================*/
+
+/** Execution tier of a regex */
+typedef enum {
+    ZREGEXP_TIER_INTERPRETED = 0, /**< Bytecode decoded on every step */
+    ZREGEXP_TIER_DECODED = 1      /**< Pre-decoded instruction table */
+} ZRegexTier;
+
+/**
+ * Set the process-wide promotion thresholds.
+ *
+ * A regex is promoted once it has been called call_threshold times or has
+ * been given byte_threshold input bytes. A zero threshold is ignored;
+ * both zero disables tiering. Only regexes compiled while tiering is enabled
+ * count their uses; zregexp_prepare promotes any regex.
+ *
+ * @param call_threshold Calls before promotion (0 = ignore)
+ * @param byte_threshold Input bytes before promotion (0 = ignore)
+ */
+void zregexp_tiering_configure(uint64_t call_threshold, uint64_t byte_threshold);
+
+/**
+ * Current execution tier of a regex.
+ *
+ * @param regex Compiled regex
+ * @return One of ZRegexTier
+ */
+uint32_t zregexp_tier(const ZRegex* regex);
+
+/* =============================================================================
+ * CPU Dispatch
+ *
+ * Byte scans (prefilter literal search, runs of a character range, memchr)
+ * run in SIMD kernels. One library binary carries several variants and uses
+ * the widest the CPU supports, chosen once on first use. Setting the
+ * environment variable ZREGEXP_CPU to scalar, baseline, avx2 or avx512 caps
+ * the choice, e.g. to test the SSE2 path on an AVX-512 host.
+ * ===========================================================================*/
+
+/** CPU features (bits of zregexp_cpu_features) */
+typedef enum {
+    ZREGEXP_CPU_SSE2 = 1 << 0,
+    ZREGEXP_CPU_SSE42 = 1 << 1,
+    ZREGEXP_CPU_AVX2 = 1 << 2,     /**< Reported only if the OS enables YMM state */
+    ZREGEXP_CPU_AVX512BW = 1 << 3, /**< Reported only if the OS enables ZMM state */
+    ZREGEXP_CPU_NEON = 1 << 4
+} ZCpuFeature;
+
+/** Kernel variant in use (zregexp_simd_level) */
+typedef enum {
+    ZREGEXP_SIMD_SCALAR = 0,   /**< Byte-at-a-time loops */
+    ZREGEXP_SIMD_BASELINE = 1, /**< Vectors of the build target (SSE2, NEON) */
+    ZREGEXP_SIMD_AVX2 = 2,     /**< 32-byte vectors */
+    ZREGEXP_SIMD_AVX512 = 3    /**< 64-byte vectors */
+} ZSimdLevel;
+
+/**
+ * SIMD features of the CPU the process runs on.
+ *
+ * @return Bitmask of ZCpuFeature
+ */
+uint32_t zregexp_cpu_features(void);
+
+/**
+ * Kernel variant the library selected.
+ *
+ * @return One of ZSimdLevel
+ */
+uint32_t zregexp_simd_level(void);
+
+/* =============================================================================
+ * Warm-up
+ *
+ * Work a regex would otherwise do on its first searches (or once it gets
+ * hot) can be done up front, at startup, so the first requests do not pay
+ * for it. Preparing is idempotent and safe to run from several threads at
+ * once, e.g. one thread per slice of a rule list.
+ * ===========================================================================*/
+
+/** Prepare flag: build the pre-decoded program now (see Tiered Execution) */
+#define ZREGEXP_PREPARE_DECODE (1u << 0)
+
+/** Prepare flag: detect the CPU and select the SIMD kernels now */
+#define ZREGEXP_PREPARE_KERNELS (1u << 1)
+
+/** Prepare flags: everything */
+#define ZREGEXP_PREPARE_ALL (ZREGEXP_PREPARE_DECODE | ZREGEXP_PREPARE_KERNELS)
+
+/**
+ * Build the lazily constructed state of a regex now.
+ *
+ * Searches return the same results whether or not a regex was prepared.
+ * The decoded program is kept even while tiering is disabled.
+ *
+ * @param regex Compiled regex
+ * @param flags Bitmask of ZREGEXP_PREPARE_* flags
+ * @return true on success, false on error (see zregexp_last_error)
+ *
+ * @example
+ *   for (size_t i = 0; i < n; i++) {
+ *       zregexp_prepare(rules[i], ZREGEXP_PREPARE_ALL);
+ *   }
+ */
+bool zregexp_prepare(ZRegex* regex, uint32_t flags);
+
+/* =============================================================================
+ * Rule Tables
+ *
+ * A rule table holds a set of patterns that can be replaced while other
+ * threads are matching against it. Matching never takes a lock: readers pin
+ * the current set, an update compiles the new set and publishes it with one
+ * atomic pointer swap, and the old set is freed once the last reader that
+ * could see it has finished.
+ * ===========================================================================*/
+
+/**
+ * Create a rule table from an array of patterns.
+ *
+ * @param patterns Array of pattern strings (null-terminated); copied
+ * @param count Number of patterns
+ * @param options Compilation options and limits applied to every pattern (NULL for defaults)
+ * @return Rule table handle, or NULL on error
+ *
+ * @example
+ *   const char* rules[] = { "error", "timeout after [0-9]+ms" };
+ *   ZRuleTable* table = zregexp_rule_table_create(rules, 2, NULL);
+ */
+ZRuleTable* zregexp_rule_table_create(const char* const* patterns, size_t count, const ZRegexOptions* options);
+
+/**
+ * Compile a new set of patterns and atomically replace the current one.
+ *
+ * Safe to call while other threads are matching. Updates are serialized;
+ * the call returns after the previous set has been reclaimed.
+ *
+ * @param table Rule table
+ * @param patterns Array of pattern strings (null-terminated); copied
+ * @param count Number of patterns
+ * @param options Compilation options and limits (NULL for defaults)
+ * @return true on success; on error the current set is left in place
+ */
+bool zregexp_rule_table_update(ZRuleTable* table, const char* const* patterns, size_t count, const ZRegexOptions* options);
+
+/**
+ * Find which rules match the input. Safe to call from any number of threads.
+ *
+ * @param table Rule table
+ * @param input Input string (null-terminated)
+ * @param ids Output buffer for matching rule indices, ascending (can be NULL)
+ * @param max_ids Capacity of ids
+ * @return Number of matching rules (may exceed max_ids); 0 on error
+ *
+ * @example
+ *   size_t ids[16];
+ *   size_t n = zregexp_rule_table_match(table, line, ids, 16);
+ */
+size_t zregexp_rule_table_match(ZRuleTable* table, const char* input, size_t* ids, size_t max_ids);
+
+/**
+ * Test whether any rule matches the input.
+ *
+ * @param table Rule table
+ * @param input Input string (null-terminated)
+ * @return true if at least one rule matches
+ */
+bool zregexp_rule_table_is_match(ZRuleTable* table, const char* input);
+
+/**
+ * Prepare every rule of the current set (see zregexp_prepare).
+ *
+ * Sets published by a later zregexp_rule_table_update() start unprepared.
+ *
+ * @param table Rule table
+ * @param flags Bitmask of ZREGEXP_PREPARE_* flags
+ * @return true on success, false on error (see zregexp_last_error)
+ */
+bool zregexp_rule_table_prepare(ZRuleTable* table, uint32_t flags);
+
+/**
+ * Get the number of rule sets published so far (1 after creation).
+ *
+ * @param table Rule table
+ * @return Generation counter
+ */
+uint64_t zregexp_rule_table_generation(ZRuleTable* table);
+
+/**
+ * Free a rule table. No other thread may be using it.
+ *
+ * @param table The rule table to free (can be NULL)
+ */
+void zregexp_rule_table_free(ZRuleTable* table);
+
+/* =============================================================================
+ * Sharded Sets
+ *
+ * For very large rule lists. Rules are grouped by the first byte of their
+ * required literal and split into shards; shards whose literals cannot occur
+ * in the input are skipped and the rest run on a worker pool. Results are
+ * bitmaps of zregexp_sharded_set_bitmap_words() uint64_t words where bit
+ * (i % 64) of word (i / 64) is set when rule i matches.
+ * ===========================================================================*/
+
+/**
+ * Compile a sharded rule set.
+ *
+ * @param patterns Array of pattern strings (null-terminated); copied
+ * @param count Number of patterns
+ * @param options Compilation options and limits applied to every pattern (NULL for defaults)
+ * @param max_shard_size Maximum rules per shard (0 for default: 512)
+ * @param n_threads Worker threads (0 for one per CPU)
+ * @return Sharded set handle, or NULL on error
+ */
+ZShardedSet* zregexp_sharded_set_create(const char* const* patterns, size_t count, const ZRegexOptions* options,
+                                        size_t max_shard_size, size_t n_threads);
+
+/**
+ * Get the number of uint64_t words in one match bitmap.
+ */
+size_t zregexp_sharded_set_bitmap_words(ZShardedSet* set);
+
+/**
+ * Latency mode: match one input, evaluating shards in parallel.
+ *
+ * @param set Sharded set
+ * @param input Input string (null-terminated)
+ * @param bitmap Output bitmap of zregexp_sharded_set_bitmap_words() words
+ * @return true on success, false on error (see zregexp_last_error)
+ *
+ * @example
+ *   size_t words = zregexp_sharded_set_bitmap_words(set);
+ *   uint64_t* hits = calloc(words, sizeof(uint64_t));
+ *   if (zregexp_sharded_set_match(set, line, hits) && (hits[7 / 64] >> (7 % 64)) & 1) {
+ *       printf("rule 7 matched\n");
+ *   }
+ */
+bool zregexp_sharded_set_match(ZShardedSet* set, const char* input, uint64_t* bitmap);
+
+/**
+ * Throughput mode: match several inputs, evaluating inputs in parallel.
+ *
+ * @param set Sharded set
+ * @param inputs Array of input strings (null-terminated)
+ * @param count Number of inputs
+ * @param bitmaps Output: count bitmaps of zregexp_sharded_set_bitmap_words() words, back to back
+ * @return true on success, false on error (see zregexp_last_error)
+ */
+bool zregexp_sharded_set_match_batch(ZShardedSet* set, const char* const* inputs, size_t count, uint64_t* bitmaps);
+
+/**
+ * Prepare every rule (see zregexp_prepare), shards in parallel on the
+ * set's worker pool.
+ *
+ * @param set Sharded set
+ * @param flags Bitmask of ZREGEXP_PREPARE_* flags
+ * @return true on success, false on error (see zregexp_last_error)
+ */
+bool zregexp_sharded_set_prepare(ZShardedSet* set, uint32_t flags);
+
+/**
+ * Free a sharded set.
+ *
+ * @param set The sharded set to free (can be NULL)
+ */
+void zregexp_sharded_set_free(ZShardedSet* set);
+
+/* =============================================================================
+ * Registries
+ *
+ * A registry file holds many compiled regexes behind an index and is used in
+ * place through a read-only shared mapping. Worker processes that open the
+ * same file share one physical copy of the programs via the page cache;
+ * each process only allocates a small handle per rule, on first use.
+ * Registries are replaced atomically (written to "<path>.tmp", then
+ * renamed), so processes still mapping an older file are unaffected.
+ * Execution limits are not stored; registry regexes use the defaults.
+ * ===========================================================================*/
+
+/**
+ * Write compiled regexes to a registry file. Rule ids are array indices.
+ *
+ * @param regexes Array of compiled regexes
+ * @param count Number of regexes
+ * @param path Destination file
+ * @return true on success, false on error (see zregexp_last_error)
+ *
+ * @example
+ *   // At build time or in the master process, before forking
+ *   zregexp_registry_save(rules, n, "/var/lib/app/rules.zrx");
+ */
+bool zregexp_registry_save(const ZRegex* const* regexes, size_t count, const char* path);
+
+/**
+ * Map a registry file read-only (POSIX only).
+ *
+ * @param path Registry file
+ * @return Registry handle, or NULL on error
+ */
+ZRegistry* zregexp_registry_open(const char* path);
+
+/**
+ * Get the number of rules in a registry.
+ */
+size_t zregexp_registry_count(const ZRegistry* registry);
+
+/**
+ * Get the regex for a rule id, materializing it on first use.
+ *
+ * Safe to call from any number of threads. The regex is owned by the
+ * registry: do not pass it to zregexp_free(); it stays valid until
+ * zregexp_registry_free().
+ *
+ * @param registry Registry
+ * @param id Rule id (index passed to zregexp_registry_save)
+ * @return Regex, or NULL on error
+ *
+ * @example
+ *   ZRegistry* rules = zregexp_registry_open("/var/lib/app/rules.zrx");
+ *   ZRegex* re = zregexp_registry_get(rules, 42);
+ *   if (re && zregexp_is_match(re, line)) { ... }
+ */
+ZRegex* zregexp_registry_get(ZRegistry* registry, size_t id);
+
+/**
+ * Free a registry, its materialized regexes and its mapping.
+ *
+ * @param registry The registry to free (can be NULL)
+ */
+void zregexp_registry_free(ZRegistry* registry);
+
 /* =============================================================================
  * Error Handling
  * ===========================================================================*/
@@ -283,7 +1088,12 @@ typedef enum {
     ZREGEXP_ERROR_INVALID_GROUP,    /** Invalid group number */
     ZREGEXP_ERROR_UNMATCHED_PAREN,  /** Unmatched parenthesis */
     ZREGEXP_ERROR_INVALID_RANGE,    /** Invalid character range */
-    ZREGEXP_ERROR_UNKNOWN           /** Unknown error */
+    ZREGEXP_ERROR_UNKNOWN,          /** Unknown error */
+    ZREGEXP_ERROR_PROGRAM_TOO_LARGE, /** Compiled program exceeds max_program_bytes */
+    ZREGEXP_ERROR_SCRATCH_LIMIT,    /** Search exceeded max_scratch_bytes */
+    ZREGEXP_ERROR_INVALID_PROFILE,  /** Branch profile malformed or for another pattern */
+    ZREGEXP_ERROR_INVALID_REGISTRY, /** Registry file malformed, or rule id out of range */
+    ZREGEXP_ERROR_IO                /** Registry file could not be read or written */
 } ZRegexError;
 
 /**
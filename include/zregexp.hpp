@@ -14,6 +14,7 @@
 
 #include "zregexp.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <stdexcept>
@@ -71,6 +72,10 @@ struct Options {
     bool case_insensitive = false;
     uint32_t max_recursion_depth = 1000;
     uint64_t max_steps = 1000000;
+    uint32_t max_program_bytes = 0;
+    uint32_t max_scratch_bytes = 0;
+    bool profile = false;
+    bool result_cache = false;
 
     /**
      * Create default options.
@@ -87,10 +92,48 @@ struct Options {
         opts.case_insensitive = case_insensitive;
         opts.max_recursion_depth = max_recursion_depth;
         opts.max_steps = max_steps;
+        opts.max_program_bytes = max_program_bytes;
+        opts.max_scratch_bytes = max_scratch_bytes;
+        if (profile) opts.flags |= ZREGEXP_OPT_PROFILE;
+        if (result_cache) opts.flags |= ZREGEXP_OPT_RESULT_CACHE;
         return opts;
     }
 };
 
+// =============================================================================
+// Execution Statistics
+// =============================================================================
+
+/**
+ * Work counters for a single matching call.
+ */
+struct Stats {
+    uint64_t steps = 0;
+    uint64_t backtracks = 0;
+    uint64_t max_depth = 0;
+    uint64_t start_positions = 0;
+    uint64_t prefilter_candidates = 0;
+    uint64_t prefilter_skips = 0;
+    uint64_t bytes_scanned = 0;
+    ZRegexEngine engine = ZREGEXP_ENGINE_NONE;
+
+    /**
+     * Convert from C statistics structure.
+     */
+    static Stats from_c(const ZExecStats& c) {
+        Stats stats;
+        stats.steps = c.steps;
+        stats.backtracks = c.backtracks;
+        stats.max_depth = c.max_depth;
+        stats.start_positions = c.start_positions;
+        stats.prefilter_candidates = c.prefilter_candidates;
+        stats.prefilter_skips = c.prefilter_skips;
+        stats.bytes_scanned = c.bytes_scanned;
+        stats.engine = static_cast<ZRegexEngine>(c.engine);
+        return stats;
+    }
+};
+
 // =============================================================================
 // Forward Declarations
 // =============================================================================
@@ -134,6 +177,25 @@ public:
         return Regex(re);
     }
 
+    /**
+     * Compile a shell-style glob pattern (e.g. "*.log" or "[a-z]?.txt").
+     *
+     * @param pattern The glob pattern string
+     * @param flags Bitwise OR of ZREGEXP_GLOB_* flags
+     * @return Compiled Regex object
+     * @throws RegexError if compilation fails
+     */
+    static Regex compileGlob(const std::string& pattern, uint32_t flags = 0) {
+        ZRegex* re = zregexp_compile_glob(pattern.c_str(), flags);
+
+        if (!re) {
+            auto error = zregexp_last_error();
+            throw RegexError(error, zregexp_error_message(error));
+        }
+
+        return Regex(re);
+    }
+
     /**
      * Move constructor.
      */
@@ -176,6 +238,15 @@ public:
      */
     std::optional<Match> find(const std::string& input) const;
 
+    /**
+     * Find the first match and report execution statistics.
+     *
+     * @param input Input string to search
+     * @param stats Receives the call's statistics
+     * @return Match object if found, empty optional otherwise
+     */
+    std::optional<Match> find(std::string_view input, Stats& stats) const;
+
     /**
      * Find all matches in the input string.
      *
@@ -194,6 +265,21 @@ public:
         return zregexp_is_match(regex_, input.c_str());
     }
 
+    /**
+     * Test if the pattern matches the input and report execution statistics.
+     *
+     * @param input Input string to test
+     * @param stats Receives the call's statistics
+     * @return true if match found, false otherwise
+     */
+    bool isMatch(std::string_view input, Stats& stats) const {
+        std::string owned(input);
+        ZExecStats c_stats{};
+        bool matched = zregexp_is_match_ex(regex_, owned.c_str(), &c_stats);
+        stats = Stats::from_c(c_stats);
+        return matched;
+    }
+
     /**
      * Replace all matches with a replacement string.
      *
@@ -213,6 +299,107 @@ public:
         return str;
     }
 
+    /**
+     * Render the per-instruction profile (requires Options::profile).
+     *
+     * @return Annotated disassembly with execution/backtrack counts
+     */
+    std::string profileDump() const {
+        char* result = zregexp_profile_dump(regex_);
+        if (!result) {
+            auto error = zregexp_last_error();
+            throw RegexError(error, "regex was not compiled with profiling");
+        }
+
+        std::string str(result);
+        zregexp_string_free(result);
+        return str;
+    }
+
+    /**
+     * Clear the profile counters.
+     */
+    void profileReset() { zregexp_profile_reset(regex_); }
+
+    /**
+     * Export the alternation branch counters (requires Options::profile).
+     *
+     * @return Text accepted by importBranchProfile()
+     */
+    std::string exportBranchProfile() const {
+        char* result = zregexp_branch_profile_export(regex_);
+        if (!result) {
+            auto error = zregexp_last_error();
+            throw RegexError(error, "regex was not compiled with profiling");
+        }
+
+        std::string str(result);
+        zregexp_string_free(result);
+        return str;
+    }
+
+    /**
+     * Let isMatch() try the more successful branch of each alternation first.
+     *
+     * @param profile Text from exportBranchProfile() for the same pattern and options
+     */
+    void importBranchProfile(const std::string& profile) {
+        if (!zregexp_branch_profile_import(regex_, profile.c_str())) {
+            throw RegexError(zregexp_last_error(), "invalid branch profile");
+        }
+    }
+
+    /**
+     * Reorder alternations by this regex's own profile (requires Options::profile).
+     */
+    void reorderBranches() {
+        if (!zregexp_branch_reorder(regex_)) {
+            throw RegexError(zregexp_last_error(), "regex was not compiled with profiling");
+        }
+    }
+
+    /**
+     * Start collecting metrics labelled with the given name.
+     */
+    void enableMetrics(const std::string& name) {
+        if (!zregexp_metrics_enable(regex_, name.c_str())) {
+            throw RegexError(ZREGEXP_ERROR_OUT_OF_MEMORY, "failed to enable metrics");
+        }
+    }
+
+    /**
+     * Process-unique id of this regex, as reported by the slow log.
+     */
+    uint64_t id() const { return zregexp_regex_id(regex_); }
+
+    /**
+     * Heap bytes owned by this regex (program, profile, metrics).
+     */
+    size_t memoryUsage() const { return zregexp_memory_usage(regex_, nullptr); }
+
+    /**
+     * Execution tier searches currently run in.
+     */
+    ZRegexTier tier() const { return static_cast<ZRegexTier>(zregexp_tier(regex_)); }
+
+    /**
+     * Cache results for repeated inputs (0 selects the default size / length).
+     */
+    void enableCache(size_t max_bytes = 0, size_t max_input_len = 0) {
+        if (!zregexp_cache_enable(regex_, max_bytes, max_input_len)) {
+            throw RegexError(zregexp_last_error(), "failed to enable result cache");
+        }
+    }
+
+    /**
+     * Build lazily constructed state now (ZREGEXP_PREPARE_* flags).
+     */
+    void prepare(uint32_t flags = ZREGEXP_PREPARE_ALL) {
+        if (!zregexp_prepare(regex_, flags)) {
+            throw RegexError(zregexp_last_error(), "failed to prepare regex");
+        }
+    }
+
     /**
      * Get the underlying C regex handle (for advanced use).
      */
@@ -326,6 +513,137 @@ private:
     std::string input_;
 };
 
+// =============================================================================
+// RuleTable Class
+// =============================================================================
+
+/**
+ * Hot-reloadable pattern set with RAII semantics.
+ *
+ * match() and isMatch() may be called from any number of threads while
+ * another thread calls update(); readers never block.
+ *
+ * @example
+ *   auto table = RuleTable::create({"error", "timeout after [0-9]+ms"});
+ *   auto ids = table.match(line);
+ *   table.update({"error", "warn(ing)?"});
+ */
+class RuleTable {
+public:
+    /**
+     * Create a rule table from a list of patterns.
+     *
+     * @throws RegexError if any pattern fails to compile
+     */
+    static RuleTable create(const std::vector<std::string>& patterns, const Options& options = Options::defaults()) {
+        auto c_patterns = c_strings(patterns);
+        auto c_options = options.to_c();
+        ZRuleTable* table = zregexp_rule_table_create(c_patterns.data(), c_patterns.size(), &c_options);
+
+        if (!table) {
+            auto error = zregexp_last_error();
+            throw RegexError(error, zregexp_error_message(error));
+        }
+
+        return RuleTable(table);
+    }
+
+    RuleTable(RuleTable&& other) noexcept : table_(other.table_) {
+        other.table_ = nullptr;
+    }
+
+    RuleTable& operator=(RuleTable&& other) noexcept {
+        if (this != &other) {
+            if (table_) {
+                zregexp_rule_table_free(table_);
+            }
+            table_ = other.table_;
+            other.table_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~RuleTable() {
+        if (table_) {
+            zregexp_rule_table_free(table_);
+        }
+    }
+
+    // Delete copy operations
+    RuleTable(const RuleTable&) = delete;
+    RuleTable& operator=(const RuleTable&) = delete;
+
+    /**
+     * Atomically replace the rules. On error the current rules stay in place.
+     *
+     * @throws RegexError if any pattern fails to compile
+     */
+    void update(const std::vector<std::string>& patterns, const Options& options = Options::defaults()) {
+        auto c_patterns = c_strings(patterns);
+        auto c_options = options.to_c();
+        if (!zregexp_rule_table_update(table_, c_patterns.data(), c_patterns.size(), &c_options)) {
+            auto error = zregexp_last_error();
+            throw RegexError(error, zregexp_error_message(error));
+        }
+    }
+
+    /**
+     * Get the indices of all rules matching the input, ascending.
+     */
+    std::vector<size_t> match(const std::string& input) const {
+        std::vector<size_t> ids(16);
+        size_t count = zregexp_rule_table_match(table_, input.c_str(), ids.data(), ids.size());
+        if (count > ids.size()) {
+            ids.resize(count);
+            count = zregexp_rule_table_match(table_, input.c_str(), ids.data(), ids.size());
+        }
+        ids.resize(count < ids.size() ? count : ids.size());
+        return ids;
+    }
+
+    /**
+     * Test whether any rule matches the input.
+     */
+    bool isMatch(const std::string& input) const {
+        return zregexp_rule_table_is_match(table_, input.c_str());
+    }
+
+    /**
+     * Prepare every rule of the current set (ZREGEXP_PREPARE_* flags).
+     */
+    void prepare(uint32_t flags = ZREGEXP_PREPARE_ALL) {
+        if (!zregexp_rule_table_prepare(table_, flags)) {
+            throw RegexError(zregexp_last_error(), "failed to prepare rule table");
+        }
+    }
+
+    /**
+     * Number of rule sets published so far (1 after creation).
+     */
+    uint64_t generation() const {
+        return zregexp_rule_table_generation(table_);
+    }
+
+    /**
+     * Get the underlying C rule table handle (for advanced use).
+     */
+    ZRuleTable* c_ptr() const { return table_; }
+
+private:
+    explicit RuleTable(ZRuleTable* table) : table_(table) {}
+
+    static std::vector<const char*> c_strings(const std::vector<std::string>& patterns) {
+        std::vector<const char*> result;
+        result.reserve(patterns.size());
+        for (const auto& pattern : patterns) {
+            result.push_back(pattern.c_str());
+        }
+        return result;
+    }
+
+    ZRuleTable* table_;
+};
+
 // =============================================================================
 // Inline Implementations
 // =============================================================================
@@ -338,6 +656,17 @@ inline std::optional<Match> Regex::find(const std::string& input) const {
     return std::nullopt;
 }
 
+inline std::optional<Match> Regex::find(std::string_view input, Stats& stats) const {
+    std::string owned(input);
+    ZExecStats c_stats{};
+    ZMatch* c_match = zregexp_find_ex(regex_, owned.c_str(), &c_stats);
+    stats = Stats::from_c(c_stats);
+    if (c_match) {
+        return Match(c_match, std::move(owned));
+    }
+    return std::nullopt;
+}
+
 inline std::vector<Match> Regex::findAll(const std::string& input) const {
     std::vector<Match> matches;
 
@@ -403,6 +732,41 @@ inline bool isValidPattern(const std::string& pattern) {
     return zregexp_is_valid_pattern(pattern.c_str());
 }
 
+/**
+ * Read the library's process-wide memory counters.
+ *
+ * @return Heap, peak, per-category and live result-object counts
+ */
+inline ZMemoryStats memoryStats() {
+    ZMemoryStats stats{};
+    zregexp_memory_stats(&stats);
+    return stats;
+}
+
+/**
+ * Set the process-wide tiering thresholds (0 ignores a threshold).
+ *
+ * @param call_threshold Calls before a regex is promoted
+ * @param byte_threshold Input bytes before a regex is promoted
+ */
+inline void configureTiering(uint64_t call_threshold, uint64_t byte_threshold = 0) {
+    zregexp_tiering_configure(call_threshold, byte_threshold);
+}
+
+/**
+ * SIMD features of the running CPU (bitmask of ZCpuFeature).
+ */
+inline uint32_t cpuFeatures() {
+    return zregexp_cpu_features();
+}
+
+/**
+ * Kernel variant the library selected for this CPU.
+ */
+inline ZSimdLevel simdLevel() {
+    return static_cast<ZSimdLevel>(zregexp_simd_level());
+}
+
 /**
  * Get the library version.
  *
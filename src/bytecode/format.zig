@@ -7,6 +7,11 @@ const std = @import("std");
 const opcodes = @import("opcodes.zig");
 const Opcode = opcodes.Opcode;
 
+/// Alignment of program buffers and pre-decoded tables, one cache line
+/// Keeps an instruction stream from starting mid-line and spreading a short
+/// program over one more line than it needs.
+pub const program_alignment = std.mem.Alignment.fromByteUnits(std.atomic.cache_line);
+
 /// Instruction represents a decoded bytecode instruction
 pub const Instruction = struct {
     /// The opcode
@@ -115,38 +115,43 @@ pub fn disassemble(bytecode: []const u8, writer: anytype) !void {
 
     while (try reader.next()) |inst| {
         const offset = reader.offset - inst.size;
-        try writer.print("{x:04}: {s}", .{ offset, inst.opcode.name() });
-
-        // Print operands
-        if (inst.operand_count > 0) {
-            try writer.writeAll(" ");
-            for (inst.operands[0..inst.operand_count], 0..) |operand, i| {
-                if (i > 0) try writer.writeAll(", ");
-
-                // Format based on opcode
-                switch (inst.opcode) {
-                    .CHAR32 => {
-                        // Print as character if printable
-                        if (operand < 128 and std.ascii.isPrint(@intCast(operand))) {
-                            try writer.print("'{c}'", .{@as(u8, @intCast(operand))});
-                        } else {
-                            try writer.print("U+{X:04}", .{operand});
-                        }
-                    },
-                    .GOTO, .SPLIT, .SPLIT_GREEDY, .SPLIT_LAZY => {
-                        // Print as signed offset
-                        const signed = @as(i32, @bitCast(operand));
-                        const target = @as(i32, @intCast(offset)) + signed;
-                        try writer.print("{d} -> {x:04}", .{ signed, target });
-                    },
-                    else => {
-                        try writer.print("{}", .{operand});
-                    },
-                }
+        try writer.print("{x:04}: ", .{offset});
+        try formatInstruction(inst, offset, writer);
+        try writer.writeAll("\n");
+    }
+}
+
+/// Write one instruction (opcode and operands, no offset or newline)
+pub fn formatInstruction(inst: Instruction, offset: usize, writer: anytype) !void {
+    try writer.writeAll(inst.opcode.name());
+
+    // Print operands
+    if (inst.operand_count > 0) {
+        try writer.writeAll(" ");
+        for (inst.operands[0..inst.operand_count], 0..) |operand, i| {
+            if (i > 0) try writer.writeAll(", ");
+
+            // Format based on opcode
+            switch (inst.opcode) {
+                .CHAR32 => {
+                    // Print as character if printable
+                    if (operand < 128 and std.ascii.isPrint(@intCast(operand))) {
+                        try writer.print("'{c}'", .{@as(u8, @intCast(operand))});
+                    } else {
+                        try writer.print("U+{X:04}", .{operand});
+                    }
+                },
+                .GOTO, .SPLIT, .SPLIT_GREEDY, .SPLIT_LAZY => {
+                    // Print as signed offset
+                    const signed = @as(i32, @bitCast(operand));
+                    const target = @as(i32, @intCast(offset)) + signed;
+                    try writer.print("{d} -> {x:04}", .{ signed, target });
+                },
+                else => {
+                    try writer.print("{}", .{operand});
+                },
             }
         }
-
-        try writer.writeAll("\n");
     }
 }
 
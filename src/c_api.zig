@@ -5,17 +5,47 @@
 
 const std = @import("std");
 const regex = @import("regex.zig");
+const rule_table = @import("rule_table.zig");
+const sharded_set = @import("sharded_set.zig");
+const registry = @import("registry.zig");
+const slow_log = @import("slow_log.zig");
+const metrics = @import("metrics.zig");
+const tiering = @import("tiering.zig");
+const counting_allocator = @import("utils/counting_allocator.zig");
+const cpu = @import("utils/cpu.zig");
+const dispatch = @import("utils/dispatch.zig");
+const comptime_regex = @import("comptime_regex.zig");
 const Regex = regex.Regex;
 const MatchResult = regex.MatchResult;
+const ExecStats = regex.ExecStats;
+const RuleTable = rule_table.RuleTable;
+const RegexSet = @import("regex_set.zig").RegexSet;
+const ShardedSet = sharded_set.ShardedSet;
+const Registry = registry.Registry;
+const CompileOptions = @import("codegen/compiler.zig").CompileOptions;
+const ExecOptions = regex.ExecOptions;
+const PrepareOptions = regex.PrepareOptions;
 const Allocator = std.mem.Allocator;
+const CountingAllocator = counting_allocator.CountingAllocator;
+
+// Specialized matchers requested with -Dcomptime-pattern (see build.zig)
+comptime {
+    for (@import("comptime_patterns").entries) |entry| comptime_regex.exportC(entry[0], entry[1]);
+}
 
 // =============================================================================
 // Global State
 // =============================================================================
 
-/// Global allocator for FFI operations
+/// Global allocator for FFI operations, counted for zregexp_memory_stats
 var gpa: std.heap.DebugAllocator(.{}) = .init;
-const allocator = gpa.allocator();
+var counting: CountingAllocator = .init(gpa.allocator());
+const allocator = counting.allocator();
+
+/// Live result handles and the bytes they hold
+var live_matches = std.atomic.Value(usize).init(0);
+var live_match_lists = std.atomic.Value(usize).init(0);
+var result_bytes = std.atomic.Value(usize).init(0);
 
 /// Thread-local error state
 threadlocal var last_error: ZRegexError = .ZREGEXP_OK;
@@ -39,6 +69,15 @@ pub const ZMatchList = struct {
     matches: std.ArrayList(ZMatch),
 };
 
+/// Opaque handle to a hot-reloadable rule table (maps to rule_table.RuleTable)
+pub const ZRuleTable = RuleTable;
+
+/// Opaque handle to a sharded rule set (maps to sharded_set.ShardedSet)
+pub const ZShardedSet = ShardedSet;
+
+/// Opaque handle to a mapped rule registry (maps to registry.Registry)
+pub const ZRegistry = Registry;
+
 // =============================================================================
 // Error Codes (must match zregexp.h)
 // =============================================================================
@@ -53,6 +92,11 @@ pub const ZRegexError = enum(c_int) {
     ZREGEXP_ERROR_UNMATCHED_PAREN = 6,
     ZREGEXP_ERROR_INVALID_RANGE = 7,
     ZREGEXP_ERROR_UNKNOWN = 8,
+    ZREGEXP_ERROR_PROGRAM_TOO_LARGE = 9,
+    ZREGEXP_ERROR_SCRATCH_LIMIT = 10,
+    ZREGEXP_ERROR_INVALID_PROFILE = 11,
+    ZREGEXP_ERROR_INVALID_REGISTRY = 12,
+    ZREGEXP_ERROR_IO = 13,
 };
 
 // =============================================================================
@@ -63,9 +107,104 @@ pub const ZRegexOptions = extern struct {
     case_insensitive: bool,
     max_recursion_depth: u32,
     max_steps: u64,
-    reserved: [4]u32,
+    flags: u32,
+    max_program_bytes: u32,
+    max_scratch_bytes: u32,
+    reserved: [1]u32,
+};
+
+// Same size as the first release's struct, so a caller built against an
+// older header passes a struct the library reads in full
+comptime {
+    std.debug.assert(@sizeOf(ZRegexOptions) == 32);
+}
+
+/// Compile flags for ZRegexOptions.flags (must match zregexp.h)
+pub const ZREGEXP_OPT_PROFILE: u32 = 1 << 0;
+pub const ZREGEXP_OPT_RESULT_CACHE: u32 = 1 << 1;
+
+// =============================================================================
+// Execution Statistics (must match zregexp.h)
+// =============================================================================
+
+pub const ZExecStats = extern struct {
+    steps: u64,
+    backtracks: u64,
+    max_depth: u64,
+    start_positions: u64,
+    prefilter_candidates: u64,
+    prefilter_skips: u64,
+    bytes_scanned: u64,
+    engine: u32,
+    cache_hits: u32,
+};
+
+fn statsToC(stats: ExecStats) ZExecStats {
+    return .{
+        .steps = stats.steps,
+        .backtracks = stats.backtracks,
+        .max_depth = stats.max_depth,
+        .start_positions = stats.start_positions,
+        .prefilter_candidates = stats.prefilter_candidates,
+        .prefilter_skips = stats.prefilter_skips,
+        .bytes_scanned = stats.bytes_scanned,
+        .engine = @intFromEnum(stats.engine),
+        .cache_hits = std.math.lossyCast(u32, stats.cache_hits),
+    };
+}
+
+// =============================================================================
+// Slow Log Entries (must match zregexp.h)
+// =============================================================================
+
+pub const ZSlowEntry = extern struct {
+    pattern_id: u64,
+    input_len: u64,
+    steps: u64,
+    duration_ns: u64,
+    engine: u32,
+    sample_len: u32,
+    sample: [slow_log.SAMPLE_CAPACITY]u8,
+};
+
+// =============================================================================
+// Memory Accounting (must match zregexp.h)
+// =============================================================================
+
+pub const ZMemoryUsage = extern struct {
+    program_bytes: usize,
+    profile_bytes: usize,
+    metrics_bytes: usize,
+    cache_bytes: usize,
+    tier_bytes: usize,
+    total_bytes: usize,
+};
+
+pub const ZMemoryStats = extern struct {
+    heap_bytes: usize,
+    peak_heap_bytes: usize,
+    live_allocations: usize,
+    program_bytes: usize,
+    cache_bytes: usize,
+    other_bytes: usize,
+    result_bytes: usize,
+    live_matches: usize,
+    live_match_lists: usize,
 };
 
+/// Bytes held by a heap ZMatch, including the handle
+fn matchBytes(m: *const ZMatch) usize {
+    return @sizeOf(ZMatch) + m.input.len + std.mem.sliceAsBytes(m.result.captures).len;
+}
+
+/// Bytes held by a heap ZMatchList, including the handle and shared input
+fn matchListBytes(l: *const ZMatchList) usize {
+    var bytes = @sizeOf(ZMatchList) + l.matches.capacity * @sizeOf(ZMatch);
+    if (l.matches.items.len > 0) bytes += l.matches.items[0].input.len;
+    for (l.matches.items) |m| bytes += std.mem.sliceAsBytes(m.result.captures).len;
+    return bytes;
+}
+
 // =============================================================================
 // Helper Functions
 // =============================================================================
@@ -83,6 +222,8 @@ fn zigErrorToC(err: anytype) ZRegexError {
         error.OutOfMemory => .ZREGEXP_ERROR_OUT_OF_MEMORY,
         error.RecursionLimitExceeded => .ZREGEXP_ERROR_RECURSION_LIMIT,
         error.StepLimitExceeded => .ZREGEXP_ERROR_STEP_LIMIT,
+        error.ScratchLimitExceeded => .ZREGEXP_ERROR_SCRATCH_LIMIT,
+        error.ProgramTooLarge => .ZREGEXP_ERROR_PROGRAM_TOO_LARGE,
         error.UnmatchedParen => .ZREGEXP_ERROR_UNMATCHED_PAREN,
         error.InvalidEscape, error.InvalidQuantifier => .ZREGEXP_ERROR_SYNTAX,
         error.InvalidCharRange => .ZREGEXP_ERROR_INVALID_RANGE,
@@ -90,6 +231,66 @@ fn zigErrorToC(err: anytype) ZRegexError {
     };
 }
 
+/// A ZRegexOptions limit: 0 takes the library default (so a zeroed struct
+/// keeps the protection), the type's maximum means unlimited
+fn limitFromC(comptime T: type, value: T, default: usize) usize {
+    if (value == 0) return default;
+    if (value == std.math.maxInt(T)) return 0;
+    return std.math.cast(usize, value) orelse 0;
+}
+
+fn compileOptionsFromC(options: ?*const ZRegexOptions) CompileOptions {
+    const opts = options orelse return .{};
+    const defaults: CompileOptions = .{};
+    return .{
+        .case_insensitive = opts.case_insensitive,
+        .profile = (opts.flags & ZREGEXP_OPT_PROFILE) != 0,
+        .max_program_bytes = limitFromC(u32, opts.max_program_bytes, defaults.max_program_bytes),
+    };
+}
+
+fn execOptionsFromC(options: ?*const ZRegexOptions) ExecOptions {
+    const opts = options orelse return .{};
+    const defaults: ExecOptions = .{};
+    return .{
+        .max_recursion_depth = limitFromC(u32, opts.max_recursion_depth, defaults.max_recursion_depth),
+        .max_steps = limitFromC(u64, opts.max_steps, defaults.max_steps),
+        .max_scratch_bytes = limitFromC(u32, opts.max_scratch_bytes, defaults.max_scratch_bytes),
+    };
+}
+
+/// Whether `options` asks for a result cache (ZREGEXP_OPT_RESULT_CACHE)
+fn cacheFromC(options: ?*const ZRegexOptions) bool {
+    const opts = options orelse return false;
+    return (opts.flags & ZREGEXP_OPT_RESULT_CACHE) != 0;
+}
+
+/// Compile a rule set with the compile and execution options of `options`
+fn createSetFromC(slices: []const []const u8, options: ?*const ZRegexOptions) regex.RegexError!*RegexSet {
+    const set = try allocator.create(RegexSet);
+    errdefer allocator.destroy(set);
+    set.* = try RegexSet.compile(allocator, slices, compileOptionsFromC(options));
+    errdefer set.deinit();
+    set.setExecOptions(execOptionsFromC(options));
+    if (cacheFromC(options)) try set.enableCache(.{});
+    return set;
+}
+
+/// Borrow a C array of strings as slices (caller frees the outer slice)
+fn patternsFromC(patterns: ?[*]const [*:0]const u8, count: usize) regex.RegexError![]const []const u8 {
+    const slices = try allocator.alloc([]const u8, count);
+    if (count > 0) {
+        const items = patterns orelse {
+            allocator.free(slices);
+            return error.InvalidPattern;
+        };
+        for (slices, 0..) |*slice, i| {
+            slice.* = cStringToSlice(items[i]);
+        }
+    }
+    return slices;
+}
+
 fn cStringToSlice(str: [*:0]const u8) []const u8 {
     return std.mem.span(str);
 }
@@ -120,7 +321,10 @@ export fn zregexp_default_options() ZRegexOptions {
         .case_insensitive = false,
         .max_recursion_depth = 1000,
         .max_steps = 1000000,
-        .reserved = [_]u32{0} ** 4,
+        .flags = 0,
+        .max_program_bytes = 0,
+        .max_scratch_bytes = 0,
+        .reserved = [_]u32{0} ** 1,
     };
 }
 
@@ -133,17 +337,22 @@ export fn zregexp_compile(pattern: [*:0]const u8, options: ?*const ZRegexOptions
 
     const pattern_slice = cStringToSlice(pattern);
 
-    // Compile regex
-    // Note: max_recursion_depth and max_steps are runtime execution limits,
-    // not compilation options. They are handled by the Matcher, not the compiler.
+    // Compile regex; the execution limits are stored on the regex for the matcher
     const re = if (options) |opts| blk: {
-        const compile_opts = @import("codegen/compiler.zig").CompileOptions{
-            .case_insensitive = opts.case_insensitive,
-        };
-        break :blk Regex.compileWithOptions(allocator, pattern_slice, compile_opts) catch |err| {
+        const compile_opts = compileOptionsFromC(opts);
+        var compiled = Regex.compileWithOptions(allocator, pattern_slice, compile_opts) catch |err| {
             setError(zigErrorToC(err));
             return null;
         };
+        compiled.exec_options = execOptionsFromC(opts);
+        if (cacheFromC(opts)) {
+            compiled.enableCache(.{}) catch {
+                compiled.deinit();
+                setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+                return null;
+            };
+        }
+        break :blk compiled;
     } else blk: {
         break :blk Regex.compile(allocator, pattern_slice) catch |err| {
             setError(zigErrorToC(err));
@@ -162,6 +371,34 @@ export fn zregexp_compile(pattern: [*:0]const u8, options: ?*const ZRegexOptions
     return heap_re;
 }
 
+/// Glob flags (must match zregexp.h)
+pub const ZREGEXP_GLOB_CASE_INSENSITIVE: u32 = 1 << 0;
+pub const ZREGEXP_GLOB_NO_PATHNAME: u32 = 1 << 1;
+
+export fn zregexp_compile_glob(pattern: [*:0]const u8, flags: u32) ?*ZRegex {
+    clearError();
+
+    const pattern_slice = cStringToSlice(pattern);
+
+    const re = Regex.compileGlob(allocator, pattern_slice, .{
+        .case_insensitive = (flags & ZREGEXP_GLOB_CASE_INSENSITIVE) != 0,
+        .pathname = (flags & ZREGEXP_GLOB_NO_PATHNAME) == 0,
+    }) catch |err| {
+        setError(zigErrorToC(err));
+        return null;
+    };
+
+    // Allocate on heap
+    const heap_re = allocator.create(Regex) catch {
+        re.deinit();
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+    heap_re.* = re;
+
+    return heap_re;
+}
+
 export fn zregexp_free(re: ?*ZRegex) void {
     if (re) |r| {
         r.deinit();
@@ -174,11 +411,20 @@ export fn zregexp_free(re: ?*ZRegex) void {
 // =============================================================================
 
 export fn zregexp_find(re: *ZRegex, input: [*:0]const u8) ?*ZMatch {
+    return zregexp_find_ex(re, input, null);
+}
+
+export fn zregexp_find_ex(re: *ZRegex, input: [*:0]const u8, stats_out: ?*ZExecStats) ?*ZMatch {
     clearError();
 
     const input_slice = cStringToSlice(input);
 
-    const result = re.find(input_slice) catch |err| {
+    var stats = ExecStats{};
+    defer if (stats_out) |out| {
+        out.* = statsToC(stats);
+    };
+
+    const result = re.findWithStats(input_slice, if (stats_out != null) &stats else null) catch |err| {
         setError(zigErrorToC(err));
         return null;
     };
@@ -203,6 +449,8 @@ export fn zregexp_find(re: *ZRegex, input: [*:0]const u8) ?*ZMatch {
             .input = input_dup,
         };
 
+        _ = live_matches.fetchAdd(1, .monotonic);
+        _ = result_bytes.fetchAdd(matchBytes(heap_match), .monotonic);
         return heap_match;
     }
 
@@ -254,25 +502,30 @@ export fn zregexp_find_all(re: *ZRegex, input: [*:0]const u8) ?*ZMatchList {
     };
 
     heap_list.* = .{ .matches = match_list };
+
+    _ = live_match_lists.fetchAdd(1, .monotonic);
+    _ = result_bytes.fetchAdd(matchListBytes(heap_list), .monotonic);
     return heap_list;
 }
 
 export fn zregexp_is_match(re: *ZRegex, input: [*:0]const u8) bool {
+    return zregexp_is_match_ex(re, input, null);
+}
+
+export fn zregexp_is_match_ex(re: *ZRegex, input: [*:0]const u8, stats_out: ?*ZExecStats) bool {
     clearError();
 
     const input_slice = cStringToSlice(input);
 
-    const match = re.find(input_slice) catch |err| {
+    var stats = ExecStats{};
+    defer if (stats_out) |out| {
+        out.* = statsToC(stats);
+    };
+
+    return re.isMatchWithStats(input_slice, if (stats_out != null) &stats else null) catch |err| {
         setError(zigErrorToC(err));
         return false;
     };
-
-    if (match) |m| {
-        m.deinit();
-        return true;
-    }
-
-    return false;
 }
 
 // =============================================================================
@@ -316,6 +569,9 @@ export fn zregexp_match_group(match: *ZMatch, group_index: u8) ?[*:0]u8 {
 
 export fn zregexp_match_free(match: ?*ZMatch) void {
     if (match) |m| {
+        _ = live_matches.fetchSub(1, .monotonic);
+        _ = result_bytes.fetchSub(matchBytes(m), .monotonic);
+
         m.result.deinit();
         allocator.free(m.input);
         allocator.destroy(m);
@@ -339,6 +595,9 @@ export fn zregexp_match_list_get(list: *ZMatchList, index: usize) ?*ZMatch {
 
 export fn zregexp_match_list_free(list: ?*ZMatchList) void {
     if (list) |l| {
+        _ = live_match_lists.fetchSub(1, .monotonic);
+        _ = result_bytes.fetchSub(matchListBytes(l), .monotonic);
+
         // Free input (shared by all matches in list)
         if (l.matches.items.len > 0) {
             allocator.free(l.matches.items[0].input);
@@ -429,6 +688,554 @@ export fn zregexp_string_free(str: ?[*:0]u8) void {
     }
 }
 
+// =============================================================================
+// Profiling
+// =============================================================================
+
+export fn zregexp_profile_dump(re: *ZRegex) ?[*:0]u8 {
+    clearError();
+
+    if (re.profile == null) {
+        setError(.ZREGEXP_ERROR_UNKNOWN);
+        return null;
+    }
+
+    var output: std.ArrayList(u8) = .empty;
+    defer output.deinit(allocator);
+
+    re.dumpProfile(output.writer(allocator)) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    // Convert to C string
+    const buf = sliceToCString(output.items) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    return @ptrCast(@constCast(buf.ptr));
+}
+
+export fn zregexp_profile_reset(re: *ZRegex) void {
+    re.resetProfile();
+}
+
+export fn zregexp_branch_profile_export(re: *ZRegex) ?[*:0]u8 {
+    clearError();
+
+    if (re.profile == null) {
+        setError(.ZREGEXP_ERROR_UNKNOWN);
+        return null;
+    }
+
+    var output: std.ArrayList(u8) = .empty;
+    defer output.deinit(allocator);
+
+    re.exportBranchProfile(output.writer(allocator)) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    const buf = sliceToCString(output.items) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    return @ptrCast(@constCast(buf.ptr));
+}
+
+export fn zregexp_branch_profile_import(re: *ZRegex, profile: [*:0]const u8) bool {
+    clearError();
+
+    re.importBranchProfile(cStringToSlice(profile)) catch |err| {
+        setError(switch (err) {
+            error.OutOfMemory => .ZREGEXP_ERROR_OUT_OF_MEMORY,
+            error.InvalidBranchProfile, error.BranchProfileMismatch => .ZREGEXP_ERROR_INVALID_PROFILE,
+        });
+        return false;
+    };
+    return true;
+}
+
+export fn zregexp_branch_reorder(re: *ZRegex) bool {
+    clearError();
+
+    re.reorderBranches() catch |err| {
+        setError(switch (err) {
+            error.OutOfMemory => .ZREGEXP_ERROR_OUT_OF_MEMORY,
+            error.ProfilingDisabled => .ZREGEXP_ERROR_UNKNOWN,
+        });
+        return false;
+    };
+    return true;
+}
+
+// =============================================================================
+// Slow Log
+// =============================================================================
+
+export fn zregexp_regex_id(re: *const ZRegex) u64 {
+    return re.id;
+}
+
+export fn zregexp_slow_log_configure(step_threshold: u64, latency_threshold_ns: u64, sample_bytes: usize) void {
+    slow_log.global.configure(.{
+        .step_threshold = step_threshold,
+        .latency_threshold_ns = latency_threshold_ns,
+        .sample_bytes = sample_bytes,
+    });
+}
+
+export fn zregexp_slow_log_drain(entries: [*]ZSlowEntry, max_entries: usize) usize {
+    var buf: [64]slow_log.SlowEntry = undefined;
+    var total: usize = 0;
+
+    while (total < max_entries) {
+        const want = @min(buf.len, max_entries - total);
+        const n = slow_log.global.drain(buf[0..want]);
+        for (buf[0..n], entries[total..][0..n]) |entry, *out| {
+            out.* = .{
+                .pattern_id = entry.pattern_id,
+                .input_len = entry.input_len,
+                .steps = entry.steps,
+                .duration_ns = entry.duration_ns,
+                .engine = @intFromEnum(entry.engine),
+                .sample_len = entry.sample_len,
+                .sample = entry.sample,
+            };
+        }
+        total += n;
+        if (n < want) break;
+    }
+
+    return total;
+}
+
+export fn zregexp_slow_log_dropped() u64 {
+    return slow_log.global.droppedCount();
+}
+
+// =============================================================================
+// Metrics
+// =============================================================================
+
+export fn zregexp_metrics_enable(re: *ZRegex, name: [*:0]const u8) bool {
+    clearError();
+
+    re.enableMetrics(cStringToSlice(name)) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return false;
+    };
+    return true;
+}
+
+export fn zregexp_metrics_render(buf: ?[*]u8, buf_len: usize) usize {
+    clearError();
+
+    var output: std.ArrayList(u8) = .empty;
+    defer output.deinit(allocator);
+
+    metrics.global.render(output.writer(allocator)) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return 0;
+    };
+
+    // snprintf-style: copy what fits, always terminate, report the full length
+    if (buf) |out| {
+        if (buf_len > 0) {
+            const n = @min(output.items.len, buf_len - 1);
+            @memcpy(out[0..n], output.items[0..n]);
+            out[n] = 0;
+        }
+    }
+    return output.items.len;
+}
+
+// =============================================================================
+// Memory Accounting
+// =============================================================================
+
+export fn zregexp_memory_usage(re: *const ZRegex, usage_out: ?*ZMemoryUsage) usize {
+    const usage = re.memoryUsage();
+    const total = @sizeOf(ZRegex) + usage.total();
+
+    if (usage_out) |out| {
+        out.* = .{
+            .program_bytes = usage.program_bytes,
+            .profile_bytes = usage.profile_bytes,
+            .metrics_bytes = usage.metrics_bytes,
+            .cache_bytes = usage.cache_bytes,
+            .tier_bytes = usage.tier_bytes,
+            .total_bytes = total,
+        };
+    }
+    return total;
+}
+
+export fn zregexp_memory_stats(stats_out: *ZMemoryStats) void {
+    const heap = counting.stats();
+    const program_bytes = regex.processProgramBytes();
+    const held_by_results = result_bytes.load(.monotonic);
+    const cache_bytes = regex.processCacheBytes();
+
+    stats_out.* = .{
+        .heap_bytes = heap.live_bytes,
+        .peak_heap_bytes = heap.peak_bytes,
+        .live_allocations = heap.live_allocations,
+        .program_bytes = program_bytes,
+        .cache_bytes = cache_bytes,
+        // Remainder, not a counter of its own; counters are read independently,
+        // so clamp rather than underflow
+        .other_bytes = heap.live_bytes -| (program_bytes + cache_bytes + held_by_results),
+        .result_bytes = held_by_results,
+        .live_matches = live_matches.load(.monotonic),
+        .live_match_lists = live_match_lists.load(.monotonic),
+    };
+}
+
+// =============================================================================
+// Result Cache
+// =============================================================================
+
+pub const ZCacheStats = extern struct {
+    hits: u64,
+    misses: u64,
+    evictions: u64,
+};
+
+export fn zregexp_cache_enable(re: *ZRegex, max_bytes: usize, max_input_len: usize) bool {
+    clearError();
+
+    const defaults = regex.CacheConfig{};
+    re.enableCache(.{
+        .max_bytes = if (max_bytes == 0) defaults.max_bytes else max_bytes,
+        .max_input_len = if (max_input_len == 0) defaults.max_input_len else max_input_len,
+    }) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return false;
+    };
+    return true;
+}
+
+export fn zregexp_cache_stats(re: *const ZRegex, stats_out: *ZCacheStats) bool {
+    const stats = re.cacheStats() orelse return false;
+    stats_out.* = .{
+        .hits = stats.hits,
+        .misses = stats.misses,
+        .evictions = stats.evictions,
+    };
+    return true;
+}
+
+// =============================================================================
+// Tiered Execution
+// =============================================================================
+
+export fn zregexp_tiering_configure(call_threshold: u64, byte_threshold: u64) void {
+    tiering.policy.configure(.{
+        .call_threshold = call_threshold,
+        .byte_threshold = byte_threshold,
+    });
+}
+
+export fn zregexp_tier(re: *const ZRegex) u32 {
+    return @intFromEnum(re.currentTier());
+}
+
+// =============================================================================
+// CPU Dispatch
+// =============================================================================
+
+export fn zregexp_cpu_features() u32 {
+    return cpu.detect().toBits();
+}
+
+export fn zregexp_simd_level() u32 {
+    return @intFromEnum(dispatch.activeLevel());
+}
+
+// =============================================================================
+// Warm-up
+// =============================================================================
+
+/// Prepare flags (must match zregexp.h)
+pub const ZREGEXP_PREPARE_DECODE: u32 = 1 << 0;
+pub const ZREGEXP_PREPARE_KERNELS: u32 = 1 << 1;
+
+fn prepareOptionsFromC(flags: u32) PrepareOptions {
+    return .{
+        .decode = (flags & ZREGEXP_PREPARE_DECODE) != 0,
+        .kernels = (flags & ZREGEXP_PREPARE_KERNELS) != 0,
+    };
+}
+
+export fn zregexp_prepare(re: *ZRegex, flags: u32) bool {
+    clearError();
+
+    re.prepare(prepareOptionsFromC(flags)) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+    return true;
+}
+
+// =============================================================================
+// Rule Tables
+// =============================================================================
+
+export fn zregexp_rule_table_create(patterns: ?[*]const [*:0]const u8, count: usize, options: ?*const ZRegexOptions) ?*ZRuleTable {
+    clearError();
+
+    const slices = patternsFromC(patterns, count) catch |err| {
+        setError(zigErrorToC(err));
+        return null;
+    };
+    defer allocator.free(slices);
+
+    const heap_table = allocator.create(RuleTable) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    const set = createSetFromC(slices, options) catch |err| {
+        allocator.destroy(heap_table);
+        setError(zigErrorToC(err));
+        return null;
+    };
+    heap_table.* = RuleTable.initOwned(allocator, set);
+
+    return heap_table;
+}
+
+export fn zregexp_rule_table_update(table: *ZRuleTable, patterns: ?[*]const [*:0]const u8, count: usize, options: ?*const ZRegexOptions) bool {
+    clearError();
+
+    const slices = patternsFromC(patterns, count) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+    defer allocator.free(slices);
+
+    // Limits are applied before publishing, while no reader can see the set
+    const set = createSetFromC(slices, options) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+    table.publish(set);
+
+    return true;
+}
+
+export fn zregexp_rule_table_match(table: *ZRuleTable, input: [*:0]const u8, ids: ?[*]usize, max_ids: usize) usize {
+    clearError();
+
+    const input_slice = cStringToSlice(input);
+    const out: []usize = if (ids) |buf| buf[0..max_ids] else &.{};
+
+    return table.matchIds(input_slice, out) catch |err| {
+        setError(zigErrorToC(err));
+        return 0;
+    };
+}
+
+export fn zregexp_rule_table_is_match(table: *ZRuleTable, input: [*:0]const u8) bool {
+    clearError();
+
+    const input_slice = cStringToSlice(input);
+
+    return table.isMatch(input_slice) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+}
+
+export fn zregexp_rule_table_prepare(table: *ZRuleTable, flags: u32) bool {
+    clearError();
+
+    table.prepare(prepareOptionsFromC(flags)) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+    return true;
+}
+
+export fn zregexp_rule_table_generation(table: *ZRuleTable) u64 {
+    return table.getGeneration();
+}
+
+export fn zregexp_rule_table_free(table: ?*ZRuleTable) void {
+    if (table) |t| {
+        t.deinit();
+        allocator.destroy(t);
+    }
+}
+
+// =============================================================================
+// Sharded Sets
+// =============================================================================
+
+export fn zregexp_sharded_set_create(patterns: ?[*]const [*:0]const u8, count: usize, options: ?*const ZRegexOptions, max_shard_size: usize, n_threads: usize) ?*ZShardedSet {
+    clearError();
+
+    const slices = patternsFromC(patterns, count) catch |err| {
+        setError(zigErrorToC(err));
+        return null;
+    };
+    defer allocator.free(slices);
+
+    const heap_set = allocator.create(ShardedSet) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    const shard_options = sharded_set.ShardOptions{
+        .max_shard_size = if (max_shard_size == 0) (sharded_set.ShardOptions{}).max_shard_size else max_shard_size,
+        .n_jobs = n_threads,
+    };
+
+    heap_set.* = ShardedSet.compile(allocator, slices, compileOptionsFromC(options), shard_options) catch |err| {
+        allocator.destroy(heap_set);
+        setError(zigErrorToC(err));
+        return null;
+    };
+    heap_set.setExecOptions(execOptionsFromC(options));
+    if (cacheFromC(options)) {
+        heap_set.enableCache(.{}) catch {
+            heap_set.deinit();
+            allocator.destroy(heap_set);
+            setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+            return null;
+        };
+    }
+
+    return heap_set;
+}
+
+export fn zregexp_sharded_set_bitmap_words(set: *ZShardedSet) usize {
+    return set.bitmapWords();
+}
+
+export fn zregexp_sharded_set_match(set: *ZShardedSet, input: [*:0]const u8, bitmap: [*]u64) bool {
+    clearError();
+
+    const input_slice = cStringToSlice(input);
+
+    set.matchBitmap(input_slice, bitmap[0..set.bitmapWords()]) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+
+    return true;
+}
+
+export fn zregexp_sharded_set_match_batch(set: *ZShardedSet, inputs: [*]const [*:0]const u8, count: usize, bitmaps: [*]u64) bool {
+    clearError();
+
+    const slices = patternsFromC(inputs, count) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+    defer allocator.free(slices);
+
+    set.matchBitmapBatch(slices, bitmaps[0 .. count * set.bitmapWords()]) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+
+    return true;
+}
+
+export fn zregexp_sharded_set_prepare(set: *ZShardedSet, flags: u32) bool {
+    clearError();
+
+    set.prepare(prepareOptionsFromC(flags)) catch |err| {
+        setError(zigErrorToC(err));
+        return false;
+    };
+    return true;
+}
+
+export fn zregexp_sharded_set_free(set: ?*ZShardedSet) void {
+    if (set) |s| {
+        s.deinit();
+        allocator.destroy(s);
+    }
+}
+
+// =============================================================================
+// Registries
+// =============================================================================
+
+fn registryErrorToC(err: anyerror) ZRegexError {
+    return switch (err) {
+        error.OutOfMemory => .ZREGEXP_ERROR_OUT_OF_MEMORY,
+        error.InvalidRegistry, error.InvalidRuleId => .ZREGEXP_ERROR_INVALID_REGISTRY,
+        error.EntryTooLarge => .ZREGEXP_ERROR_PROGRAM_TOO_LARGE,
+        else => .ZREGEXP_ERROR_IO,
+    };
+}
+
+export fn zregexp_registry_save(regexes: ?[*]const *const ZRegex, count: usize, path: [*:0]const u8) bool {
+    clearError();
+
+    const copies = allocator.alloc(Regex, count) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return false;
+    };
+    defer allocator.free(copies);
+    if (count > 0) {
+        const items = regexes orelse {
+            setError(.ZREGEXP_ERROR_UNKNOWN);
+            return false;
+        };
+        for (copies, 0..) |*copy, i| copy.* = items[i].*;
+    }
+
+    registry.save(allocator, std.fs.cwd(), cStringToSlice(path), copies) catch |err| {
+        setError(registryErrorToC(err));
+        return false;
+    };
+    return true;
+}
+
+export fn zregexp_registry_open(path: [*:0]const u8) ?*ZRegistry {
+    clearError();
+
+    const heap_registry = allocator.create(Registry) catch {
+        setError(.ZREGEXP_ERROR_OUT_OF_MEMORY);
+        return null;
+    };
+
+    heap_registry.* = Registry.open(allocator, std.fs.cwd(), cStringToSlice(path)) catch |err| {
+        allocator.destroy(heap_registry);
+        setError(registryErrorToC(err));
+        return null;
+    };
+
+    return heap_registry;
+}
+
+export fn zregexp_registry_count(reg: *const ZRegistry) usize {
+    return reg.len();
+}
+
+export fn zregexp_registry_get(reg: *ZRegistry, id: usize) ?*ZRegex {
+    clearError();
+
+    return reg.get(id) catch |err| {
+        setError(registryErrorToC(err));
+        return null;
+    };
+}
+
+export fn zregexp_registry_free(reg: ?*ZRegistry) void {
+    if (reg) |r| {
+        r.deinit();
+        allocator.destroy(r);
+    }
+}
+
 // =============================================================================
 // Error Handling
 // =============================================================================
@@ -448,6 +1255,11 @@ export fn zregexp_error_message(err: ZRegexError) [*:0]const u8 {
         .ZREGEXP_ERROR_UNMATCHED_PAREN => "Unmatched parenthesis",
         .ZREGEXP_ERROR_INVALID_RANGE => "Invalid character range",
         .ZREGEXP_ERROR_UNKNOWN => "Unknown error",
+        .ZREGEXP_ERROR_PROGRAM_TOO_LARGE => "Compiled program exceeds size limit",
+        .ZREGEXP_ERROR_SCRATCH_LIMIT => "Match scratch memory limit exceeded",
+        .ZREGEXP_ERROR_INVALID_PROFILE => "Branch profile is malformed or was recorded for another pattern",
+        .ZREGEXP_ERROR_INVALID_REGISTRY => "Registry file is malformed or the rule id is out of range",
+        .ZREGEXP_ERROR_IO => "Registry file could not be read or written",
     };
 }
 
@@ -7,4 +7,5 @@ test {
     _ = @import("generator.zig");
     _ = @import("optimizer.zig");
     _ = @import("compiler.zig");
+    _ = @import("glob.zig");
 }
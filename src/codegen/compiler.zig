@@ -12,6 +12,8 @@ const ast_mod = @import("../parser/ast.zig");
 const generator_mod = @import("generator.zig");
 const optimizer_mod = @import("optimizer.zig");
 const bytecode_writer = @import("../bytecode/writer.zig");
+const format = @import("../bytecode/format.zig");
+const probes = @import("../utils/probes.zig");
 
 const Lexer = lexer_mod.Lexer;
 const Parser = parser_mod.Parser;
@@ -20,14 +22,59 @@ const Optimizer = optimizer_mod.Optimizer;
 const OptLevel = optimizer_mod.OptLevel;
 const BytecodeWriter = bytecode_writer.BytecodeWriter;
 
+/// Bytecode range generated from a range of pattern bytes
+pub const SourceSpan = struct {
+    pc_start: usize,
+    pc_end: usize,
+    src_start: usize,
+    src_end: usize,
+};
+
 /// Compilation result
 pub const CompileResult = struct {
+    /// Program, allocated with format.program_alignment unless borrowed
     bytecode: []const u8,
     allocator: Allocator,
 
+    /// Literal every match must contain (owned), used to reject inputs early
+    prefilter: ?[]const u8 = null,
+
+    /// Per-node bytecode/pattern spans (owned), recorded when profiling
+    source_map: ?[]const SourceSpan = null,
+
+    /// Bytecode and prefilter live elsewhere (e.g. a mapped registry) and are not freed
+    borrowed: bool = false,
+
     /// Free the compilation result
     pub fn deinit(self: CompileResult) void {
-        self.allocator.free(self.bytecode);
+        if (self.borrowed) return;
+        const program: []align(format.program_alignment.toByteUnits()) const u8 = @alignCast(self.bytecode);
+        self.allocator.free(program);
+        if (self.prefilter) |literal| self.allocator.free(literal);
+        if (self.source_map) |map| self.allocator.free(map);
+    }
+
+    /// Heap bytes owned by this result
+    pub fn memoryUsage(self: CompileResult) usize {
+        if (self.borrowed) return 0;
+        var bytes = self.bytecode.len;
+        if (self.prefilter) |literal| bytes += literal.len;
+        if (self.source_map) |map| bytes += map.len * @sizeOf(SourceSpan);
+        return bytes;
+    }
+
+    /// Innermost pattern span that generated the instruction at `pc`
+    pub fn sourceSpanAt(self: CompileResult, pc: usize) ?SourceSpan {
+        const map = self.source_map orelse return null;
+
+        var best: ?SourceSpan = null;
+        for (map) |span| {
+            if (pc < span.pc_start or pc >= span.pc_end) continue;
+            if (best == null or span.pc_end - span.pc_start < best.?.pc_end - best.?.pc_start) {
+                best = span;
+            }
+        }
+        return best;
     }
 };
 
@@ -44,10 +91,20 @@ pub const CompileOptions = struct {
 
     /// Dot matches newline
     dot_all: bool = false,
+
+    /// Record a source map and per-instruction execution counters
+    profile: bool = false,
+
+    /// Fail with error.ProgramTooLarge beyond this many bytecode bytes
+    /// (0 = unlimited). Set it when compiling untrusted patterns: nested
+    /// counted repeats such as (a{1000}){1000} grow the program multiplicatively.
+    max_program_bytes: usize = 0,
 };
 
 /// Compile a regex pattern to bytecode
 pub fn compile(allocator: Allocator, pattern: []const u8, options: CompileOptions) !CompileResult {
+    probes.probe1("compile__start", pattern.len);
+
     // Phase 1: Lexing
     var lexer = Lexer.init(pattern);
 
@@ -56,26 +113,80 @@ pub fn compile(allocator: Allocator, pattern: []const u8, options: CompileOption
     const ast = try parser.parse();
     defer ast.deinit();
 
+    const prefilter = try requiredLiteral(allocator, ast, options);
+    errdefer if (prefilter) |literal| allocator.free(literal);
+
     // Phase 3: Code generation
     var writer = BytecodeWriter.init(allocator);
     defer writer.deinit();
 
+    var spans: std.ArrayListUnmanaged(SourceSpan) = .empty;
+    defer spans.deinit(allocator);
+
     var generator = CodeGenerator.init(allocator, &writer, options);
+    if (options.profile) generator.source_map = &spans;
     try generator.generate(ast);
 
     const unoptimized = try writer.finalize();
     // Note: unoptimized is owned by writer, will be freed by writer.deinit()
 
     // Phase 4: Optimization
+    // The optimizer preserves instruction offsets, so the source map stays valid
     var optimizer = Optimizer.init(allocator, options.opt_level);
     const optimized = try optimizer.optimize(unoptimized);
+    errdefer allocator.free(optimized);
+
+    const source_map: ?[]const SourceSpan = if (options.profile) try spans.toOwnedSlice(allocator) else null;
+
+    probes.probe2("compile__done", pattern.len, optimized.len);
 
     return CompileResult{
         .bytecode = optimized,
         .allocator = allocator,
+        .prefilter = prefilter,
+        .source_map = source_map,
     };
 }
 
+/// Longest run of literal characters in the top-level sequence
+/// Every match contains it, so it can serve as a substring prefilter.
+fn requiredLiteral(allocator: Allocator, root: *ast_mod.Node, options: CompileOptions) !?[]const u8 {
+    if (options.case_insensitive) return null;
+
+    const single = [_]*ast_mod.Node{root};
+    const items: []const *ast_mod.Node = switch (root.type) {
+        .sequence => root.children.items,
+        .char => &single,
+        else => return null,
+    };
+
+    var best_start: usize = 0;
+    var best_len: usize = 0;
+    var run_start: usize = 0;
+    var run_len: usize = 0;
+
+    for (items, 0..) |node, i| {
+        if (node.type == .char and node.char_value <= 0xFF) {
+            if (run_len == 0) run_start = i;
+            run_len += 1;
+            if (run_len > best_len) {
+                best_start = run_start;
+                best_len = run_len;
+            }
+        } else {
+            run_len = 0;
+        }
+    }
+
+    if (best_len == 0) return null;
+
+    const literal = try allocator.alloc(u8, best_len);
+    for (literal, items[best_start..][0..best_len]) |*byte, node| {
+        byte.* = @intCast(node.char_value);
+    }
+    return literal;
+}
+
 /// Compile with default options
 pub fn compileSimple(allocator: Allocator, pattern: []const u8) !CompileResult {
     return compile(allocator, pattern, .{});
@@ -194,9 +305,53 @@ test "compile: escaped characters" {
     try std.testing.expect(result.bytecode.len > 0);
 }
 
+test "compile: required literal prefilter" {
+    {
+        const result = try compileSimple(std.testing.allocator, "[0-9]+ms timeout");
+        defer result.deinit();
+        try std.testing.expectEqualStrings("ms timeout", result.prefilter.?);
+    }
+
+    {
+        const result = try compileSimple(std.testing.allocator, "a|b");
+        defer result.deinit();
+        try std.testing.expect(result.prefilter == null);
+    }
+
+    {
+        const result = try compile(std.testing.allocator, "abc", .{ .case_insensitive = true });
+        defer result.deinit();
+        try std.testing.expect(result.prefilter == null);
+    }
+}
+
+test "compile: program size cap" {
+    try std.testing.expectError(error.ProgramTooLarge, compile(std.testing.allocator, "(a{1000}){1000}", .{ .max_program_bytes = 1 << 20 }));
+    try std.testing.expectError(error.ProgramTooLarge, compile(std.testing.allocator, "a{100}", .{ .max_program_bytes = 64 }));
+
+    const result = try compile(std.testing.allocator, "a{10}", .{ .max_program_bytes = 64 });
+    defer result.deinit();
+    try std.testing.expect(result.bytecode.len <= 64);
+}
+
 test "compile: word boundaries" {
     const result = try compileSimple(std.testing.allocator, "\\bword\\b");
     defer result.deinit();
 
     try std.testing.expect(result.bytecode.len > 0);
 }
+
+test "compile: source map with profile option" {
+    const pattern = "ab+c";
+    const result = try compile(std.testing.allocator, pattern, .{ .profile = true });
+    defer result.deinit();
+
+    // First instruction is CHAR32 'a'
+    const first = result.sourceSpanAt(0).?;
+    try std.testing.expectEqualStrings("a", pattern[first.src_start..first.src_end]);
+
+    // Without profiling there is no map
+    const plain = try compileSimple(std.testing.allocator, pattern);
+    defer plain.deinit();
+    try std.testing.expectEqual(@as(?SourceSpan, null), plain.sourceSpanAt(0));
+}
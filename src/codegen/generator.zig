@@ -16,12 +16,14 @@ const BytecodeWriter = bytecode.BytecodeWriter;
 const Label = bytecode.Label;
 const Opcode = opcodes.Opcode;
 const CompileOptions = compiler.CompileOptions;
+const SourceSpan = compiler.SourceSpan;
 
 /// Code generation error
 pub const CodegenError = error{
     UnsupportedNode,
     InvalidPattern,
     TooManyGroups,
+    ProgramTooLarge,
     OutOfMemory,
     // BytecodeWriter errors
     BufferTooSmall,
@@ -35,6 +37,9 @@ pub const CodeGenerator = struct {
     group_count: u8,
     options: CompileOptions,
 
+    /// When set, receives one span per generated node (children before parents)
+    source_map: ?*std.ArrayListUnmanaged(SourceSpan) = null,
+
     const Self = @This();
 
     /// Maximum ASCII character value
@@ -62,6 +67,28 @@ pub const CodeGenerator = struct {
 
     /// Generate code for a node
     fn generateNode(self: *Self, node: *Node) CodegenError!void {
+        const pc_start = self.writer.offset();
+        try self.emitNode(node);
+
+        // Checked per node, so nested repeats stop within one node of the cap
+        const limit = self.options.max_program_bytes;
+        if (limit > 0 and self.writer.offset() > limit) return error.ProgramTooLarge;
+
+        if (self.source_map) |map| {
+            // Synthesized nodes (e.g. members of \w) have no span of their own
+            if (node.src_end > node.src_start) {
+                try map.append(self.allocator, .{
+                    .pc_start = pc_start,
+                    .pc_end = self.writer.offset(),
+                    .src_start = node.src_start,
+                    .src_end = node.src_end,
+                });
+            }
+        }
+    }
+
+    /// Emit the instructions for a node
+    fn emitNode(self: *Self, node: *Node) CodegenError!void {
         switch (node.type) {
             .char => try self.generateChar(node),
             .char_range => try self.generateCharRange(node),
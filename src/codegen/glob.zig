@@ -0,0 +1,412 @@
+//! Glob front-end - Translates shell-style globs to bytecode
+//!
+//! This module compiles glob patterns (`*.log`, `src/**/*.zig`, `file?.[ch]`)
+//! directly into an AST and runs it through the regular code generator, so
+//! globs execute on the same bytecode engine as regex patterns without a
+//! string round-trip through regex syntax.
+//!
+//! Supported syntax:
+//! - `*`     any run of characters within one path segment (never `/`)
+//! - `?`     any single character except `/`
+//! - `**`    any run of characters across segments; `**/` also matches zero segments
+//! - `[...]` bracket expression, negated with `[!...]` or `[^...]`
+//! - `\x`    literal `x`
+//!
+//! Globs are always anchored at both ends. With `pathname = false`, `*` and
+//! `?` also match `/`.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+const ast = @import("../parser/ast.zig");
+const compiler = @import("compiler.zig");
+const generator_mod = @import("generator.zig");
+const optimizer_mod = @import("optimizer.zig");
+const bytecode_writer = @import("../bytecode/writer.zig");
+
+const Node = ast.Node;
+const CompileResult = compiler.CompileResult;
+const CodeGenerator = generator_mod.CodeGenerator;
+const Optimizer = optimizer_mod.Optimizer;
+const OptLevel = optimizer_mod.OptLevel;
+const BytecodeWriter = bytecode_writer.BytecodeWriter;
+
+/// Glob compiler options
+pub const GlobOptions = struct {
+    /// Optimization level
+    opt_level: OptLevel = .basic,
+
+    /// Case insensitive matching (ASCII letters)
+    case_insensitive: bool = false,
+
+    /// `*`, `?` and negated brackets never match `/` (like FNM_PATHNAME)
+    pathname: bool = true,
+};
+
+/// Compile a glob pattern to bytecode
+///
+/// The result carries a `prefilter`: the longest literal run every match must
+/// contain, so callers can reject inputs with a substring search before running
+/// the matcher. No prefilter is produced for case-insensitive globs.
+pub fn compileGlob(allocator: Allocator, pattern: []const u8, options: GlobOptions) !CompileResult {
+    // Phase 1: Glob -> AST
+    var builder = GlobBuilder.init(allocator, pattern, options);
+    defer builder.deinit();
+
+    const root = try builder.build();
+    defer root.deinit();
+
+    // Phase 2: Code generation
+    var writer = BytecodeWriter.init(allocator);
+    defer writer.deinit();
+
+    var generator = CodeGenerator.init(allocator, &writer, .{
+        .opt_level = options.opt_level,
+        .case_insensitive = options.case_insensitive,
+    });
+    try generator.generate(root);
+
+    const unoptimized = try writer.finalize();
+
+    // Phase 3: Optimization
+    var optimizer = Optimizer.init(allocator, options.opt_level);
+    const optimized = try optimizer.optimize(unoptimized);
+    errdefer allocator.free(optimized);
+
+    const prefilter: ?[]const u8 = if (!options.case_insensitive and builder.best_literal.items.len > 0)
+        try allocator.dupe(u8, builder.best_literal.items)
+    else
+        null;
+
+    return CompileResult{
+        .bytecode = optimized,
+        .allocator = allocator,
+        .prefilter = prefilter,
+    };
+}
+
+/// Builds an anchored sequence AST from a glob pattern
+const GlobBuilder = struct {
+    allocator: Allocator,
+    pattern: []const u8,
+    pos: usize,
+    options: GlobOptions,
+
+    /// Literal run currently being scanned
+    literal: std.ArrayList(u8),
+
+    /// Longest literal run seen so far (prefilter candidate)
+    best_literal: std.ArrayList(u8),
+
+    const Self = @This();
+
+    /// Difference between uppercase and lowercase ASCII letters
+    const CASE_DIFF = 32;
+
+    fn init(allocator: Allocator, pattern: []const u8, options: GlobOptions) Self {
+        return .{
+            .allocator = allocator,
+            .pattern = pattern,
+            .pos = 0,
+            .options = options,
+            .literal = .empty,
+            .best_literal = .empty,
+        };
+    }
+
+    fn deinit(self: *Self) void {
+        self.literal.deinit(self.allocator);
+        self.best_literal.deinit(self.allocator);
+    }
+
+    /// Build the AST: ^ item* $
+    fn build(self: *Self) !*Node {
+        const seq = try Node.createSequence(self.allocator);
+        errdefer seq.deinit();
+
+        try appendOwned(seq, try Node.createAnchor(self.allocator, .anchor_start));
+
+        while (self.pos < self.pattern.len) {
+            const c = self.pattern[self.pos];
+            switch (c) {
+                '*' => {
+                    try self.endLiteral();
+                    try appendOwned(seq, try self.parseStar());
+                },
+                '?' => {
+                    self.pos += 1;
+                    try self.endLiteral();
+                    try appendOwned(seq, try self.segmentChar());
+                },
+                '[' => {
+                    if (try self.parseBracket()) |class| {
+                        self.endLiteral() catch |err| {
+                            class.deinit();
+                            return err;
+                        };
+                        try appendOwned(seq, class);
+                    } else {
+                        // Unterminated bracket: '[' is literal
+                        self.pos += 1;
+                        try self.appendLiteral(seq, '[');
+                    }
+                },
+                '\\' => {
+                    self.pos += 1;
+                    if (self.pos < self.pattern.len) {
+                        const escaped = self.pattern[self.pos];
+                        self.pos += 1;
+                        try self.appendLiteral(seq, escaped);
+                    } else {
+                        // Trailing backslash matches itself
+                        try self.appendLiteral(seq, '\\');
+                    }
+                },
+                else => {
+                    self.pos += 1;
+                    try self.appendLiteral(seq, c);
+                },
+            }
+        }
+
+        try self.endLiteral();
+        try appendOwned(seq, try Node.createAnchor(self.allocator, .anchor_end));
+
+        return seq;
+    }
+
+    /// Parse a run of `*` starting at the current position
+    fn parseStar(self: *Self) !*Node {
+        const at_segment_start = self.pos == 0 or self.pattern[self.pos - 1] == '/';
+
+        var count: usize = 0;
+        while (self.pos < self.pattern.len and self.pattern[self.pos] == '*') {
+            self.pos += 1;
+            count += 1;
+        }
+
+        // Single star (or any star without pathname semantics)
+        if (count == 1 or !self.options.pathname) {
+            return self.createStar(try self.segmentChar());
+        }
+
+        // `**/` at the start of a segment: zero or more whole segments, (?:.*/)?
+        if (at_segment_start and self.pos < self.pattern.len and self.pattern[self.pos] == '/') {
+            self.pos += 1;
+
+            const group = blk: {
+                const inner = try Node.createSequence(self.allocator);
+                errdefer inner.deinit();
+                try appendOwned(inner, try self.createStar(try Node.createDot(self.allocator)));
+                try appendOwned(inner, try Node.createChar(self.allocator, '/'));
+                break :blk try Node.createNonCapturingGroup(self.allocator, inner);
+            };
+            errdefer group.deinit();
+            return Node.createQuantifier(self.allocator, .question, group);
+        }
+
+        // Bare `**`: any run of characters, crossing segments
+        return self.createStar(try Node.createDot(self.allocator));
+    }
+
+    /// Parse a bracket expression at `[`; returns null when it is unterminated
+    fn parseBracket(self: *Self) !?*Node {
+        var i = self.pos + 1;
+        var negated = false;
+        if (i < self.pattern.len and (self.pattern[i] == '!' or self.pattern[i] == '^')) {
+            negated = true;
+            i += 1;
+        }
+
+        const body_start = i;
+
+        // ']' right after the opening bracket is a member, not the terminator
+        if (i < self.pattern.len and self.pattern[i] == ']') i += 1;
+
+        while (i < self.pattern.len and self.pattern[i] != ']') : (i += 1) {
+            if (self.pattern[i] == '\\' and i + 1 < self.pattern.len) i += 1;
+        }
+        if (i >= self.pattern.len) return null;
+
+        const body = self.pattern[body_start..i];
+        self.pos = i + 1;
+
+        const class = try Node.createCharClass(self.allocator);
+        errdefer class.deinit();
+        class.inverted = negated;
+
+        var j: usize = 0;
+        while (j < body.len) {
+            var first = body[j];
+            j += 1;
+            if (first == '\\' and j < body.len) {
+                first = body[j];
+                j += 1;
+            }
+
+            var last = first;
+            if (j + 1 < body.len and body[j] == '-') {
+                last = body[j + 1];
+                j += 2;
+                if (last == '\\' and j < body.len) {
+                    last = body[j];
+                    j += 1;
+                }
+                if (last < first) return error.InvalidCharRange;
+            }
+
+            try self.addClassRange(class, first, last);
+        }
+
+        // A negated bracket must not let a path separator through
+        if (negated and self.options.pathname) {
+            try self.addClassRange(class, '/', '/');
+        }
+
+        return class;
+    }
+
+    /// Single character that stays inside a path segment
+    fn segmentChar(self: *Self) !*Node {
+        if (!self.options.pathname) {
+            return Node.createDot(self.allocator);
+        }
+
+        const node = try Node.createCharRange(self.allocator, '/', '/');
+        node.inverted = true;
+        return node;
+    }
+
+    /// Wrap a node in a greedy star
+    fn createStar(self: *Self, child: *Node) !*Node {
+        errdefer child.deinit();
+        return Node.createQuantifier(self.allocator, .star, child);
+    }
+
+    /// Add [first-last] to a class, plus its other-case counterpart when folding
+    fn addClassRange(self: *Self, class: *Node, first: u8, last: u8) !void {
+        try self.appendRange(class, first, last);
+
+        if (!self.options.case_insensitive) return;
+
+        const lower_lo = @max(first, 'a');
+        const lower_hi = @min(last, 'z');
+        if (lower_lo <= lower_hi) {
+            try self.appendRange(class, lower_lo - CASE_DIFF, lower_hi - CASE_DIFF);
+        }
+
+        const upper_lo = @max(first, 'A');
+        const upper_hi = @min(last, 'Z');
+        if (upper_lo <= upper_hi) {
+            try self.appendRange(class, upper_lo + CASE_DIFF, upper_hi + CASE_DIFF);
+        }
+    }
+
+    fn appendRange(self: *Self, class: *Node, first: u8, last: u8) !void {
+        const node = if (first == last)
+            try Node.createChar(self.allocator, first)
+        else
+            try Node.createCharRange(self.allocator, first, last);
+        try appendOwned(class, node);
+    }
+
+    /// Append a literal character and track it for the prefilter
+    fn appendLiteral(self: *Self, seq: *Node, c: u8) !void {
+        try self.literal.append(self.allocator, c);
+        try appendOwned(seq, try Node.createChar(self.allocator, c));
+    }
+
+    /// Close the current literal run, keeping it if it is the longest so far
+    fn endLiteral(self: *Self) !void {
+        if (self.literal.items.len > self.best_literal.items.len) {
+            self.best_literal.clearRetainingCapacity();
+            try self.best_literal.appendSlice(self.allocator, self.literal.items);
+        }
+        self.literal.clearRetainingCapacity();
+    }
+
+    /// Append a child, freeing it if the append fails
+    fn appendOwned(parent: *Node, child: *Node) !void {
+        errdefer child.deinit();
+        try parent.appendChild(child);
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+const Matcher = @import("../executor/matcher.zig").Matcher;
+
+fn expectGlob(pattern: []const u8, options: GlobOptions, input: []const u8, expected: bool) !void {
+    const compiled = try compileGlob(std.testing.allocator, pattern, options);
+    defer compiled.deinit();
+
+    const matcher = Matcher.init(std.testing.allocator, compiled.bytecode);
+    try std.testing.expectEqual(expected, try matcher.matchFull(input));
+}
+
+test "glob: star stays within a segment" {
+    try expectGlob("*.zig", .{}, "main.zig", true);
+    try expectGlob("*.zig", .{}, ".zig", true);
+    try expectGlob("*.zig", .{}, "src/main.zig", false);
+    try expectGlob("*.zig", .{}, "main.zi", false);
+    try expectGlob("a*b*c", .{}, "axxbyyc", true);
+}
+
+test "glob: globstar crosses segments" {
+    try expectGlob("src/**/*.zig", .{}, "src/a.zig", true);
+    try expectGlob("src/**/*.zig", .{}, "src/x/y/a.zig", true);
+    try expectGlob("src/**/*.zig", .{}, "lib/a.zig", false);
+    try expectGlob("**", .{}, "a/b/c", true);
+    try expectGlob("logs/**", .{}, "logs/2024/01.txt", true);
+}
+
+test "glob: question mark and brackets" {
+    try expectGlob("file?.[ch]", .{}, "file1.c", true);
+    try expectGlob("file?.[ch]", .{}, "fileA.h", true);
+    try expectGlob("file?.[ch]", .{}, "file12.c", false);
+    try expectGlob("file?.[ch]", .{}, "file/.c", false);
+    try expectGlob("[!abc]x", .{}, "dx", true);
+    try expectGlob("[!abc]x", .{}, "ax", false);
+    try expectGlob("[!abc]x", .{}, "/x", false);
+    try expectGlob("[]a]", .{}, "]", true);
+    try expectGlob("[a-c0-9]", .{}, "7", true);
+}
+
+test "glob: escapes and literal brackets" {
+    try expectGlob("\\*", .{}, "*", true);
+    try expectGlob("\\*", .{}, "a", false);
+    try expectGlob("[abc", .{}, "[abc", true);
+}
+
+test "glob: options" {
+    try expectGlob("*.TXT", .{ .case_insensitive = true }, "notes.txt", true);
+    try expectGlob("[a-c].log", .{ .case_insensitive = true }, "B.log", true);
+    try expectGlob("*", .{ .pathname = false }, "a/b", true);
+    try expectGlob("*", .{}, "a/b", false);
+}
+
+test "glob: invalid range" {
+    try std.testing.expectError(error.InvalidCharRange, compileGlob(std.testing.allocator, "[z-a]", .{}));
+}
+
+test "glob: literal prefilter" {
+    {
+        const compiled = try compileGlob(std.testing.allocator, "src/**/*.zig", .{});
+        defer compiled.deinit();
+        try std.testing.expectEqualStrings("src/", compiled.prefilter.?);
+    }
+
+    {
+        const compiled = try compileGlob(std.testing.allocator, "*.tar.gz", .{});
+        defer compiled.deinit();
+        try std.testing.expectEqualStrings(".tar.gz", compiled.prefilter.?);
+    }
+
+    {
+        const compiled = try compileGlob(std.testing.allocator, "*", .{});
+        defer compiled.deinit();
+        try std.testing.expect(compiled.prefilter == null);
+    }
+}
@@ -33,11 +33,11 @@ pub const Optimizer = struct {
         };
     }
 
-    /// Optimize bytecode
-    pub fn optimize(self: Self, bytecode: []const u8) ![]u8 {
+    /// Optimize bytecode into a cache-line aligned buffer (see format.program_alignment)
+    pub fn optimize(self: Self, bytecode: []const u8) ![]align(format.program_alignment.toByteUnits()) u8 {
         if (self.level == .none) {
             // No optimization, just copy
-            return try self.allocator.dupe(u8, bytecode);
+            return try self.alignedDupe(bytecode);
         }
 
         // For now, just return a copy
@@ -47,7 +47,13 @@ pub const Optimizer = struct {
         // - Optimize quantifier patterns
         // - Dead code elimination
 
-        return try self.allocator.dupe(u8, bytecode);
+        return try self.alignedDupe(bytecode);
+    }
+
+    fn alignedDupe(self: Self, bytecode: []const u8) ![]align(format.program_alignment.toByteUnits()) u8 {
+        const program = try self.allocator.alignedAlloc(u8, format.program_alignment, bytecode.len);
+        @memcpy(program, bytecode);
+        return program;
     }
 
     /// Peephole optimization: look at small windows of instructions
@@ -111,3 +117,13 @@ test "Optimizer: preserves valid bytecode" {
 
     try std.testing.expect(result.len > 0);
 }
+
+test "Optimizer: program buffer is cache-line aligned" {
+    const test_bytecode = [_]u8{ 0x01, 0x61, 0x00, 0x00, 0x00, 0x10 };
+
+    var opt = Optimizer.init(std.testing.allocator, .basic);
+    const result = try opt.optimize(&test_bytecode);
+    defer std.testing.allocator.free(result);
+
+    try std.testing.expect(format.program_alignment.check(@intFromPtr(result.ptr)));
+}
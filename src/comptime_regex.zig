@@ -0,0 +1,816 @@
+//! Comptime-specialized regular expressions
+//!
+//! comptimeRegex("pattern") parses the pattern while the program is being
+//! compiled and turns every pattern node into a type whose match function
+//! has its operands baked in: literals compare against constant strings,
+//! classes index a constant 256-entry table, and repeats of a single-byte
+//! element become a native scan loop. There is no runtime compile step and
+//! no bytecode dispatch.
+//!
+//! Nodes are chained in continuation-passing style: each node's match takes
+//! the continuation for the rest of the pattern and returns the end of the
+//! overall match, so backtracking is plain control flow through the call
+//! stack.
+//! Each search counts its backtracking steps and the repeat iterations on
+//! the stack against the limits in ComptimeOptions, like ExecOptions does for
+//! Regex, and fails with error.StepLimitExceeded or RecursionLimitExceeded.
+//!
+//!     const date = zregexp.comptimeRegex("[0-9]{4}-[0-9]{2}-[0-9]{2}");
+//!     if (date.find(line)) |span| { ... }
+//!
+//! Patterns are read with the runtime lexer (parser/lexer.zig) and follow
+//! the runtime parser's grammar, so escapes, classes and \d \w \s mean
+//! what they mean to Regex; a differential test below holds the two to the
+//! same matches. Everything Regex accepts is supported except lookaround,
+//! backreferences and possessive quantifiers, which are compile errors.
+//! Groups are non-capturing in effect; spans report the whole match only.
+//!
+//! exportC() publishes a pattern as C functions; the build option
+//! -Dcomptime-pattern=symbol=pattern does this for the shared library.
+
+const std = @import("std");
+const lexer_mod = @import("parser/lexer.zig");
+const exec = @import("executor/recursive_matcher.zig");
+
+const Lexer = lexer_mod.Lexer;
+const Token = lexer_mod.Token;
+const TokenType = lexer_mod.TokenType;
+
+/// Options fixed at comptime
+pub const ComptimeOptions = struct {
+    /// Case insensitive matching of ASCII letters in literals (classes are
+    /// not folded, as in Regex)
+    case_insensitive: bool = false,
+
+    /// Backtracking steps per search (0 = unlimited), as in ExecOptions
+    max_steps: usize = exec.DEFAULT_MAX_STEPS,
+
+    /// Iterations of a multi-byte repeat body on the stack at once
+    /// (0 = unlimited); each one recurses, as in ExecOptions
+    max_recursion_depth: usize = exec.DEFAULT_MAX_RECURSION_DEPTH,
+};
+
+/// A search ran out of its budget
+pub const Error = error{
+    StepLimitExceeded,
+    RecursionLimitExceeded,
+};
+
+/// Byte range of a match
+pub const Span = struct {
+    start: usize,
+    end: usize,
+};
+
+/// Matcher type for `pattern`; its values are zero-sized
+pub fn ComptimeRegex(comptime pattern: []const u8, comptime options: ComptimeOptions) type {
+    const Root = comptime blk: {
+        @setEvalBranchQuota(2000 + pattern.len * 2000);
+        var parser = Parser.init(pattern, options);
+        const node = parser.parseAlternation();
+        if (!parser.check(.eof)) parser.fail("unmatched ')'");
+        break :blk node;
+    };
+
+    return struct {
+        /// Pattern the matcher was generated from
+        pub const source = pattern;
+
+        const Self = @This();
+
+        fn begin(input: []const u8) Search {
+            return .{ .input = input, .max_steps = options.max_steps, .max_depth = options.max_recursion_depth };
+        }
+
+        /// Test if pattern matches entire input
+        pub fn matchFull(_: Self, input: []const u8) Error!bool {
+            var search = begin(input);
+            const end = Root.match(&search, 0, AcceptAtEnd{});
+            if (search.err) |err| return err;
+            return end != null;
+        }
+
+        /// Find the leftmost match
+        pub fn find(_: Self, input: []const u8) Error!?Span {
+            // One budget for the whole search, across start positions
+            var search = begin(input);
+            var start: usize = 0;
+            while (start <= input.len) : (start += 1) {
+                const end = Root.match(&search, start, Accept{});
+                if (search.err) |err| return err;
+                if (end) |e| return .{ .start = start, .end = e };
+            }
+            return null;
+        }
+
+        /// Test if pattern matches anywhere in input
+        pub fn isMatch(self: Self, input: []const u8) Error!bool {
+            return try self.find(input) != null;
+        }
+    };
+}
+
+/// Matcher for `pattern`, specialized at comptime
+pub fn comptimeRegex(comptime pattern: []const u8) ComptimeRegex(pattern, .{}) {
+    return .{};
+}
+
+/// Export `pattern` as C functions named `symbol` and `symbol_find`:
+///
+///     int symbol(const char* input, size_t len);
+///     int symbol_find(const char* input, size_t len, size_t* start, size_t* end);
+///
+/// Both return 1 on a match, 0 on none, and -1 when the search ran out of
+/// its step or recursion budget. Call from a comptime block.
+pub fn exportC(comptime symbol: []const u8, comptime pattern: []const u8) void {
+    const Re = ComptimeRegex(pattern, .{});
+    const Exports = struct {
+        fn isMatch(input: [*]const u8, len: usize) callconv(.c) c_int {
+            const matched = (Re{}).isMatch(input[0..len]) catch return -1;
+            return @intFromBool(matched);
+        }
+
+        fn find(input: [*]const u8, len: usize, start: *usize, end: *usize) callconv(.c) c_int {
+            const found = (Re{}).find(input[0..len]) catch return -1;
+            const span = found orelse return 0;
+            start.* = span.start;
+            end.* = span.end;
+            return 1;
+        }
+    };
+    @export(&Exports.isMatch, .{ .name = symbol });
+    @export(&Exports.find, .{ .name = symbol ++ "_find" });
+}
+
+// =============================================================================
+// Search state
+// =============================================================================
+
+/// One search: the input and the work done against the options' limits.
+/// Once a limit is hit every step fails, so the backtracking unwinds
+/// without trying further alternatives.
+const Search = struct {
+    input: []const u8,
+    steps: usize = 0,
+    depth: usize = 0,
+    max_steps: usize,
+    max_depth: usize,
+    err: ?Error = null,
+
+    /// Count one backtracking step (a branch, or a repeat count tried)
+    fn step(self: *Search) bool {
+        if (self.err != null) return false;
+        self.steps += 1;
+        if (self.max_steps != 0 and self.steps > self.max_steps) {
+            self.err = error.StepLimitExceeded;
+            return false;
+        }
+        return true;
+    }
+
+    /// Enter one more nested repeat iteration; pair with `leave`
+    fn enter(self: *Search) bool {
+        if (self.err != null) return false;
+        if (self.max_depth != 0 and self.depth >= self.max_depth) {
+            self.err = error.RecursionLimitExceeded;
+            return false;
+        }
+        self.depth += 1;
+        return true;
+    }
+
+    fn leave(self: *Search) void {
+        self.depth -= 1;
+    }
+};
+
+// =============================================================================
+// Continuations
+// =============================================================================
+
+/// Accept wherever the pattern ends
+const Accept = struct {
+    fn run(_: Accept, _: *Search, pos: usize) ?usize {
+        return pos;
+    }
+};
+
+/// Accept only at the end of input
+const AcceptAtEnd = struct {
+    fn run(_: AcceptAtEnd, search: *Search, pos: usize) ?usize {
+        return if (pos == search.input.len) pos else null;
+    }
+};
+
+/// Continue with `Rest`, then `k`
+fn Then(comptime Rest: type, comptime K: type) type {
+    return struct {
+        k: K,
+
+        fn run(self: @This(), search: *Search, pos: usize) ?usize {
+            return Rest.match(search, pos, self.k);
+        }
+    };
+}
+
+// =============================================================================
+// Nodes
+// =============================================================================
+
+/// One byte from a constant table (literal, class, dot)
+fn ByteSet(comptime table: [256]bool) type {
+    return struct {
+        fn accepts(c: u8) bool {
+            return table[c];
+        }
+
+        fn match(search: *Search, pos: usize, k: anytype) ?usize {
+            const input = search.input;
+            if (pos < input.len and table[input[pos]]) return k.run(search, pos + 1);
+            return null;
+        }
+    };
+}
+
+/// A run of literal bytes
+fn Literal(comptime bytes: []const u8) type {
+    return struct {
+        fn match(search: *Search, pos: usize, k: anytype) ?usize {
+            const input = search.input;
+            if (input.len - pos < bytes.len) return null;
+            if (!std.mem.eql(u8, input[pos..][0..bytes.len], bytes)) return null;
+            return k.run(search, pos + bytes.len);
+        }
+    };
+}
+
+/// Nodes in order
+fn Sequence(comptime nodes: []const type) type {
+    return struct {
+        fn match(search: *Search, pos: usize, k: anytype) ?usize {
+            if (nodes.len == 1) {
+                return nodes[0].match(search, pos, k);
+            } else {
+                const rest = Then(Sequence(nodes[1..]), @TypeOf(k)){ .k = k };
+                return nodes[0].match(search, pos, rest);
+            }
+        }
+    };
+}
+
+/// First branch that leads to an overall match
+fn Alternation(comptime branches: []const type) type {
+    return struct {
+        fn match(search: *Search, pos: usize, k: anytype) ?usize {
+            inline for (branches) |Branch| {
+                if (!search.step()) return null;
+                if (Branch.match(search, pos, k)) |end| return end;
+            }
+            return null;
+        }
+    };
+}
+
+/// Matches the empty string
+const Empty = struct {
+    fn match(search: *Search, pos: usize, k: anytype) ?usize {
+        return k.run(search, pos);
+    }
+};
+
+/// `Body` repeated min..max times (max null = unbounded)
+fn Repeat(comptime Body: type, comptime min: usize, comptime max: ?usize, comptime greedy: bool) type {
+    return struct {
+        fn match(search: *Search, pos: usize, k: anytype) ?usize {
+            if (@hasDecl(Body, "accepts")) {
+                return matchRun(search, pos, k);
+            } else {
+                return matchCount(search, pos, 0, k);
+            }
+        }
+
+        /// Single-byte body: the candidate ends are a contiguous range
+        fn matchRun(search: *Search, pos: usize, k: anytype) ?usize {
+            const input = search.input;
+            const limit = if (max) |m| @min(input.len, pos +| m) else input.len;
+            var end = pos;
+
+            if (greedy) {
+                while (end < limit and Body.accepts(input[end])) end += 1;
+                if (end - pos < min) return null;
+                while (search.step()) {
+                    if (k.run(search, end)) |result| return result;
+                    if (end == pos + min) return null;
+                    end -= 1;
+                }
+            } else {
+                while (end < pos + min) : (end += 1) {
+                    if (end >= input.len or !Body.accepts(input[end])) return null;
+                }
+                while (search.step()) {
+                    if (k.run(search, end)) |result| return result;
+                    if (end >= limit or !Body.accepts(input[end])) return null;
+                    end += 1;
+                }
+            }
+            return null;
+        }
+
+        /// General body: one recursion per iteration, bounded by max_recursion_depth
+        fn matchCount(search: *Search, pos: usize, count: usize, k: anytype) ?usize {
+            if (!search.step()) return null;
+            const can_stop = count >= min;
+            const can_continue = if (max) |m| count < m else true;
+
+            if (!greedy and can_stop) {
+                if (k.run(search, pos)) |result| return result;
+            }
+            if (can_continue) {
+                const next = Next(@TypeOf(k)){ .count = count + 1, .start = pos, .k = k };
+                if (Body.match(search, pos, next)) |result| return result;
+            }
+            if (greedy and can_stop) return k.run(search, pos);
+            return null;
+        }
+
+        fn Next(comptime K: type) type {
+            return struct {
+                count: usize,
+                start: usize,
+                k: K,
+
+                fn run(self: @This(), search: *Search, pos: usize) ?usize {
+                    // An empty iteration beyond the minimum can never make progress
+                    if (pos == self.start and self.count > min) return null;
+                    if (!search.enter()) return null;
+                    defer search.leave();
+                    return matchCount(search, pos, self.count, self.k);
+                }
+            };
+        }
+    };
+}
+
+/// `^`
+const AnchorStart = struct {
+    fn match(search: *Search, pos: usize, k: anytype) ?usize {
+        return if (pos == 0) k.run(search, pos) else null;
+    }
+};
+
+/// `$`
+const AnchorEnd = struct {
+    fn match(search: *Search, pos: usize, k: anytype) ?usize {
+        return if (pos == search.input.len) k.run(search, pos) else null;
+    }
+};
+
+/// `\b` (or `\B` when negated)
+fn WordBoundary(comptime negated: bool) type {
+    return struct {
+        fn match(search: *Search, pos: usize, k: anytype) ?usize {
+            const input = search.input;
+            const before = pos > 0 and word_table[input[pos - 1]];
+            const after = pos < input.len and word_table[input[pos]];
+            if ((before != after) == negated) return null;
+            return k.run(search, pos);
+        }
+    };
+}
+
+// =============================================================================
+// Byte tables
+// =============================================================================
+
+const word_table = tableOfRanges(&lexer_mod.word_ranges);
+const digit_table = tableOfRanges(&lexer_mod.digit_ranges);
+const space_table = tableOfRanges(&lexer_mod.space_ranges);
+
+fn tableOf(comptime bytes: []const u8) [256]bool {
+    var table = [_]bool{false} ** 256;
+    for (bytes) |c| table[c] = true;
+    return table;
+}
+
+fn tableOfRanges(comptime ranges: []const [2]u8) [256]bool {
+    var table = [_]bool{false} ** 256;
+    for (ranges) |range| {
+        for (@as(usize, range[0])..@as(usize, range[1]) + 1) |i| table[i] = true;
+    }
+    return table;
+}
+
+fn invert(table: [256]bool) [256]bool {
+    var result: [256]bool = undefined;
+    for (table, 0..) |set, i| result[i] = !set;
+    return result;
+}
+
+/// Add the other case of every ASCII letter in the table
+fn foldCase(table: [256]bool) [256]bool {
+    var result = table;
+    for (table, 0..) |set, i| {
+        if (!set) continue;
+        const c: u8 = @intCast(i);
+        if (std.ascii.isAlphabetic(c)) {
+            result[std.ascii.toLower(c)] = true;
+            result[std.ascii.toUpper(c)] = true;
+        }
+    }
+    return result;
+}
+
+// =============================================================================
+// Parser (comptime only)
+// =============================================================================
+
+const Parser = struct {
+    lexer: Lexer,
+    token: Token,
+    options: ComptimeOptions,
+
+    fn init(pattern: []const u8, options: ComptimeOptions) Parser {
+        var p = Parser{ .lexer = Lexer.init(pattern), .token = undefined, .options = options };
+        p.advance();
+        return p;
+    }
+
+    fn fail(p: *const Parser, comptime msg: []const u8) noreturn {
+        p.failAt(p.token.position, msg);
+    }
+
+    fn failAt(p: *const Parser, pos: usize, comptime msg: []const u8) noreturn {
+        @compileError(std.fmt.comptimePrint("comptimeRegex(\"{s}\"): {s} at offset {d}", .{ p.lexer.pattern, msg, pos }));
+    }
+
+    fn advance(p: *Parser) void {
+        p.token = p.lexer.next() catch |err| p.failAt(p.lexer.pos, @errorName(err));
+    }
+
+    fn check(p: *const Parser, token_type: TokenType) bool {
+        return p.token.type == token_type;
+    }
+
+    fn expect(p: *Parser, token_type: TokenType, comptime msg: []const u8) void {
+        if (!p.check(token_type)) p.fail(msg);
+        p.advance();
+    }
+
+    fn parseAlternation(p: *Parser) type {
+        var branches: []const type = &.{p.parseSequence()};
+        while (p.check(.pipe)) {
+            p.advance();
+            branches = branches ++ &[_]type{p.parseSequence()};
+        }
+        return if (branches.len == 1) branches[0] else Alternation(branches);
+    }
+
+    fn parseSequence(p: *Parser) type {
+        var nodes: []const type = &.{};
+        var literal: []const u8 = "";
+
+        while (!p.check(.pipe) and !p.check(.rparen) and !p.check(.eof)) {
+            const atom = p.parseAtom();
+            if (atom.byte != null and !p.atQuantifier()) {
+                literal = literal ++ &[_]u8{atom.byte.?};
+                continue;
+            }
+
+            if (literal.len > 0) {
+                nodes = nodes ++ &[_]type{Literal(literal)};
+                literal = "";
+            }
+            nodes = nodes ++ &[_]type{p.parseQuantifier(atom.node)};
+        }
+
+        if (literal.len > 0) nodes = nodes ++ &[_]type{Literal(literal)};
+
+        return switch (nodes.len) {
+            0 => Empty,
+            1 => nodes[0],
+            else => Sequence(nodes),
+        };
+    }
+
+    const Atom = struct {
+        node: type,
+
+        /// Set for a plain literal byte that may join a Literal run
+        byte: ?u8 = null,
+    };
+
+    /// Literal byte; case folding applies to ASCII letters, as in the runtime generator
+    fn byteAtom(p: *Parser, c: u8) Atom {
+        if (p.options.case_insensitive and std.ascii.isAlphabetic(c)) {
+            return .{ .node = ByteSet(foldCase(tableOf(&.{c}))) };
+        }
+        return .{ .node = ByteSet(tableOf(&.{c})), .byte = c };
+    }
+
+    fn parseAtom(p: *Parser) Atom {
+        const token = p.token;
+        p.advance();
+        return switch (token.type) {
+            .char, .escaped_char => p.byteAtom(@intCast(token.char_value)),
+            .dot => .{ .node = ByteSet(invert(tableOf(""))) },
+            .digit => .{ .node = ByteSet(digit_table) },
+            .not_digit => .{ .node = ByteSet(invert(digit_table)) },
+            .word => .{ .node = ByteSet(word_table) },
+            .not_word => .{ .node = ByteSet(invert(word_table)) },
+            .whitespace => .{ .node = ByteSet(space_table) },
+            .not_whitespace => .{ .node = ByteSet(invert(space_table)) },
+            .line_start => .{ .node = AnchorStart },
+            .line_end => .{ .node = AnchorEnd },
+            .word_boundary => .{ .node = WordBoundary(false) },
+            .not_word_boundary => .{ .node = WordBoundary(true) },
+            .lparen, .non_capturing_group_start => blk: {
+                const inner = p.parseAlternation();
+                p.expect(.rparen, "missing ')'");
+                break :blk .{ .node = inner };
+            },
+            .lbracket => p.parseClass(),
+            .lookahead_start,
+            .negative_lookahead_start,
+            .lookbehind_start,
+            .negative_lookbehind_start,
+            => p.failAt(token.position, "lookaround is not supported"),
+            .back_ref => p.failAt(token.position, "backreferences are not supported"),
+            else => p.failAt(token.position, "unexpected " ++ @tagName(token.type)),
+        };
+    }
+
+    /// Class after its '[', with the runtime parser's grammar: single bytes
+    /// and ranges only
+    fn parseClass(p: *Parser) Atom {
+        // The lexer reports a leading '^' as line_start
+        const negated = p.check(.line_start);
+        if (negated) p.advance();
+
+        var table = tableOf("");
+        var items: usize = 0;
+        var last_byte: ?u8 = null;
+        while (!p.check(.rbracket) and !p.check(.eof)) : (items += 1) {
+            if (p.check(.hyphen)) {
+                p.advance();
+                table['-'] = true;
+                last_byte = '-';
+                continue;
+            }
+            if (!p.check(.char) and !p.check(.escaped_char)) p.fail("unexpected " ++ @tagName(p.token.type) ++ " in class");
+
+            const lo: u8 = @intCast(p.token.char_value);
+            p.advance();
+            last_byte = lo;
+            if (!p.check(.hyphen)) {
+                table[lo] = true;
+                continue;
+            }
+
+            p.advance();
+            if (p.check(.char) or p.check(.escaped_char)) {
+                const hi: u8 = @intCast(p.token.char_value);
+                if (hi < lo) p.fail("invalid class range");
+                p.advance();
+                for (@as(usize, lo)..@as(usize, hi) + 1) |i| table[i] = true;
+                last_byte = null;
+            } else {
+                // Hyphen before ']': both bytes are literal
+                table[lo] = true;
+                table['-'] = true;
+                items += 1;
+            }
+        }
+        p.expect(.rbracket, "missing ']'");
+        if (items == 0) p.fail("empty class");
+
+        // Regex compiles a one-byte class as the byte itself (folded like a literal)
+        if (!negated and items == 1) {
+            if (last_byte) |c| return .{ .node = p.byteAtom(c).node };
+        }
+        return .{ .node = ByteSet(if (negated) invert(table) else table) };
+    }
+
+    fn atQuantifier(p: *const Parser) bool {
+        return switch (p.token.type) {
+            .star,
+            .plus,
+            .question,
+            .repeat,
+            .lazy_star,
+            .lazy_plus,
+            .lazy_question,
+            .possessive_star,
+            .possessive_plus,
+            .possessive_question,
+            => true,
+            else => false,
+        };
+    }
+
+    fn parseQuantifier(p: *Parser, comptime node: type) type {
+        const token = p.token;
+        var min: usize = 0;
+        var max: ?usize = null;
+        var greedy = true;
+        switch (token.type) {
+            .star => {},
+            .plus => min = 1,
+            .question => max = 1,
+            .lazy_star => greedy = false,
+            .lazy_plus => {
+                min = 1;
+                greedy = false;
+            },
+            .lazy_question => {
+                max = 1;
+                greedy = false;
+            },
+            .repeat => {
+                // The lexer reports {n,} with max = maxInt(u32)
+                min = token.repeat_min;
+                if (token.repeat_max != std.math.maxInt(u32)) max = token.repeat_max;
+                if (max != null and max.? < min) p.fail("repeat max is less than min");
+            },
+            .possessive_star,
+            .possessive_plus,
+            .possessive_question,
+            => p.fail("possessive quantifiers are not supported"),
+            else => return node,
+        }
+        p.advance();
+
+        // {n,m}? is lazy; the other lazy forms are tokens of their own
+        if (token.type == .repeat and p.check(.question)) {
+            greedy = false;
+            p.advance();
+        }
+        return Repeat(node, min, max, greedy);
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "comptimeRegex: literals" {
+    const re = comptimeRegex("hello");
+    try std.testing.expect(try re.matchFull("hello"));
+    try std.testing.expect(!try re.matchFull("hello!"));
+
+    const span = (try re.find("say hello there")).?;
+    try std.testing.expectEqual(@as(usize, 4), span.start);
+    try std.testing.expectEqual(@as(usize, 9), span.end);
+    try std.testing.expect(try re.find("help") == null);
+}
+
+test "comptimeRegex: classes and repeats" {
+    const re = comptimeRegex("[0-9]{4}-[0-9]{2}-[0-9]{2}");
+    try std.testing.expect(try re.matchFull("2024-01-31"));
+    try std.testing.expect(!try re.matchFull("2024-1-31"));
+    try std.testing.expect(try re.isMatch("released on 2024-01-31."));
+
+    const word = comptimeRegex("\\w+@\\w+\\.com");
+    try std.testing.expect(try word.isMatch("mail bob@example.com now"));
+    try std.testing.expect(!try word.isMatch("bob at example.com"));
+}
+
+test "comptimeRegex: greedy and lazy" {
+    const greedy = comptimeRegex("<.+>");
+    const lazy = comptimeRegex("<.+?>");
+    const input = "<a><b>";
+
+    try std.testing.expectEqual(@as(usize, 6), (try greedy.find(input)).?.end);
+    try std.testing.expectEqual(@as(usize, 3), (try lazy.find(input)).?.end);
+}
+
+test "comptimeRegex: groups and alternation" {
+    const re = comptimeRegex("(ab|cd)+e");
+    try std.testing.expect(try re.matchFull("abcdabe"));
+    try std.testing.expect(!try re.matchFull("abce"));
+    try std.testing.expect(!try re.matchFull("e"));
+
+    const opt = comptimeRegex("colou?r");
+    try std.testing.expect(try opt.matchFull("color"));
+    try std.testing.expect(try opt.matchFull("colour"));
+}
+
+test "comptimeRegex: empty iterations terminate" {
+    const re = comptimeRegex("(a*)*b");
+    try std.testing.expect(try re.matchFull("aaab"));
+    try std.testing.expect(!try re.matchFull("aaac"));
+}
+
+test "comptimeRegex: anchors and boundaries" {
+    const re = comptimeRegex("^\\bfoo\\b");
+    try std.testing.expect(try re.isMatch("foo bar"));
+    try std.testing.expect(!try re.isMatch("food"));
+    try std.testing.expect(!try re.isMatch(" foo"));
+}
+
+test "comptimeRegex: case insensitive" {
+    const re = ComptimeRegex("get [a-c]+", .{ .case_insensitive = true }){};
+    try std.testing.expect(try re.matchFull("GET abc"));
+    try std.testing.expect(try re.matchFull("Get cab"));
+    try std.testing.expect(!try re.matchFull("GET d"));
+}
+
+/// Every span `Re` reports over `inputs` must equal Regex's for the same pattern
+fn expectSameAsRegex(comptime Re: type, options: @import("codegen/compiler.zig").CompileOptions, inputs: []const []const u8) !void {
+    const Regex = @import("regex.zig").Regex;
+    const re = try Regex.compileWithOptions(std.testing.allocator, Re.source, options);
+    defer re.deinit();
+
+    for (inputs) |input| {
+        const expected = try re.find(input);
+        defer if (expected) |m| m.deinit();
+        const actual = try (Re{}).find(input);
+
+        errdefer std.debug.print("pattern \"{s}\" input \"{s}\"\n", .{ Re.source, input });
+        try std.testing.expectEqual(expected != null, actual != null);
+        if (expected) |m| {
+            try std.testing.expectEqual(m.start, actual.?.start);
+            try std.testing.expectEqual(m.end, actual.?.end);
+        }
+        try std.testing.expectEqual(try re.isMatch(input), try (Re{}).isMatch(input));
+    }
+}
+
+test "comptimeRegex: agrees with Regex" {
+    // The benchmark catalogue patterns without lookaround or backreferences,
+    // then the escapes, anchors and quantifier forms they leave out
+    const patterns = .{
+        "Mozilla",
+        "Sherlock",
+        "GATTACA",
+        "\x7fELF",
+        "[0-9]+",
+        "[A-Z][a-z]+",
+        "<[a-z]+",
+        "[GC]{6}",
+        "[\x00-\x08]{4}",
+        "Sherlock|Holmes|Watson|Moriarty",
+        "GET|POST|PUT|DELETE",
+        "AGT(A|C)GT|TTT(G|T)AA",
+        "^[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+",
+        "^>seq[0-9]+",
+        "\\b\\w+\\b",
+        "a\\s+b",
+        "\\S+\\s\\D\\W",
+        "x.*y$",
+        "<.+?>",
+        "[^ab-]+",
+        "[0-9]{2,4}",
+        "[0-9]{2,}?x",
+        "colou?r",
+        "(?:ab|cd)*e",
+        "\\Bo+\\B",
+        "a\\.b\\t",
+    };
+    const inputs = [_][]const u8{
+        "",
+        "GET /index.html HTTP/1.1\" 200 512 \"Mozilla/5.0\"",
+        "10.0.0.1 - - [31/Jan/2024] \"POST /api\" 201",
+        "Sherlock Holmes and Dr. Watson met Moriarty.",
+        ">seq42\nAGTCGTTTTGAAGATTACAGGCCGC",
+        "\x7fELF\x01\x02\x03\x04\x05\x00\x00",
+        "a \t\r\nb a\x0bb a\x0cb",
+        "x\ny xyz yy",
+        "<a><b> <tag attr>",
+        "abcd-ef ba",
+        "1 12 123 12345 1x 12x 123x",
+        "color colour colouur abcdcde e",
+        "foo boot o oo",
+        "a.b\t a.b ",
+    };
+    inline for (patterns) |pattern| {
+        try expectSameAsRegex(ComptimeRegex(pattern, .{}), .{}, &inputs);
+    }
+    try expectSameAsRegex(ComptimeRegex("get [a-c]+|post [x]", .{ .case_insensitive = true }), .{ .case_insensitive = true }, &.{
+        "GET abc",
+        "GET ABC",
+        "POST X",
+        "post x",
+    });
+}
+
+test "comptimeRegex: step budget stops catastrophic backtracking" {
+    const re = comptimeRegex("(a+)+b");
+    try std.testing.expect(try re.matchFull("aaab"));
+    try std.testing.expectError(error.StepLimitExceeded, re.isMatch("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"));
+
+    const small = ComptimeRegex("(a+)+b", .{ .max_steps = 100 }){};
+    try std.testing.expectError(error.StepLimitExceeded, small.matchFull("aaaaaaaaaaaa"));
+}
+
+test "comptimeRegex: recursion budget bounds repeat depth" {
+    const pairs = "ab" ** 1500;
+    const re = comptimeRegex("(ab)*");
+    try std.testing.expectError(error.RecursionLimitExceeded, re.matchFull(pairs));
+
+    const deep = ComptimeRegex("(ab)*", .{ .max_recursion_depth = 2000 }){};
+    try std.testing.expect(try deep.matchFull(pairs));
+
+    // Single-byte bodies loop instead of recursing
+    const run = comptimeRegex("[ab]*");
+    try std.testing.expect(try run.matchFull(pairs));
+}
@@ -0,0 +1,262 @@
+//! Profile-guided branch order
+//!
+//! When a query only asks whether a pattern matches anywhere, the order in
+//! which an alternation tries its branches cannot change the answer, only
+//! how much backtracking it takes to find it. A BranchOrder flags the
+//! alternation SPLITs whose second branch has matched more often than the
+//! first in a profile; Matcher.isMatch then tries that branch first. Searches
+//! that report a match (find, findAll, matchFull) keep leftmost-first order.
+//!
+//! Branch counts can be exported as text and imported by another process
+//! that compiled the same pattern with the same options, so statistics
+//! gathered in production can be applied to regexes compiled without
+//! profiling. A checksum of the program rejects profiles of anything else.
+//!
+//! Possessive quantifiers commit to the first way their body matches, so
+//! programs that contain them are never reordered.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const format = @import("../bytecode/format.zig");
+const opcodes = @import("../bytecode/opcodes.zig");
+const profile_mod = @import("profile.zig");
+
+const Opcode = opcodes.Opcode;
+const Profile = profile_mod.Profile;
+
+/// First line of an exported branch profile
+pub const HEADER = "zregexp-branch-profile v1";
+
+/// Errors from importing a branch profile
+pub const BranchProfileError = Allocator.Error || error{
+    /// Text is not a branch profile
+    InvalidBranchProfile,
+
+    /// Profile was recorded for a different program
+    BranchProfileMismatch,
+};
+
+/// Per-PC flags: try the second branch of the alternation first
+pub const BranchOrder = struct {
+    allocator: Allocator,
+
+    /// Set at alternation SPLITs whose second branch wins more often
+    swapped: []bool,
+
+    const Self = @This();
+
+    /// Order from per-PC win counts (read atomically, so a live Profile works)
+    pub fn fromCounts(allocator: Allocator, bytecode: []const u8, first_wins: []const u64, second_wins: []const u64) Allocator.Error!Self {
+        const swapped = try allocator.alloc(bool, bytecode.len);
+        @memset(swapped, false);
+
+        if (isReorderable(bytecode)) {
+            var pc: usize = 0;
+            while (pc < bytecode.len) {
+                const inst = format.decodeInstruction(bytecode, pc) catch break;
+                if (isSplit(inst.opcode)) {
+                    const first = @atomicLoad(u64, &first_wins[pc], .monotonic);
+                    const second = @atomicLoad(u64, &second_wins[pc], .monotonic);
+                    swapped[pc] = second > first;
+                }
+                pc += inst.size;
+            }
+        }
+
+        return .{
+            .allocator = allocator,
+            .swapped = swapped,
+        };
+    }
+
+    /// Order from the branch counters of a profile
+    pub fn fromProfile(allocator: Allocator, bytecode: []const u8, profile: *const Profile) Allocator.Error!Self {
+        return fromCounts(allocator, bytecode, profile.first_wins, profile.second_wins);
+    }
+
+    /// Order from an exported branch profile (see writeProfile)
+    pub fn parse(allocator: Allocator, bytecode: []const u8, text: []const u8) BranchProfileError!Self {
+        var lines = std.mem.tokenizeScalar(u8, text, '\n');
+
+        const header = std.mem.trimRight(u8, lines.next() orelse "", "\r");
+        if (!std.mem.startsWith(u8, header, HEADER ++ " ")) return error.InvalidBranchProfile;
+
+        var fields = std.mem.tokenizeScalar(u8, header[HEADER.len..], ' ');
+        const checksum = try parseField(fields.next(), "crc=", 16);
+        const len = try parseField(fields.next(), "len=", 10);
+        if (checksum != std.hash.Crc32.hash(bytecode) or len != bytecode.len) return error.BranchProfileMismatch;
+
+        const first_wins = try allocator.alloc(u64, bytecode.len);
+        defer allocator.free(first_wins);
+        const second_wins = try allocator.alloc(u64, bytecode.len);
+        defer allocator.free(second_wins);
+        @memset(first_wins, 0);
+        @memset(second_wins, 0);
+
+        while (lines.next()) |raw| {
+            const line = std.mem.trimRight(u8, raw, "\r");
+            if (line.len == 0 or line[0] == '#') continue;
+
+            var values = std.mem.tokenizeScalar(u8, line, ' ');
+            const pc = try parseNumber(values.next());
+            const first = try parseNumber(values.next());
+            const second = try parseNumber(values.next());
+            if (values.next() != null) return error.InvalidBranchProfile;
+            if (pc >= bytecode.len) return error.BranchProfileMismatch;
+
+            first_wins[pc] +|= first;
+            second_wins[pc] +|= second;
+        }
+
+        return fromCounts(allocator, bytecode, first_wins, second_wins);
+    }
+
+    /// Free the flags
+    pub fn deinit(self: Self) void {
+        self.allocator.free(self.swapped);
+    }
+
+    /// Heap bytes owned, including the BranchOrder itself
+    pub fn memoryUsage(self: Self) usize {
+        return @sizeOf(Self) + self.swapped.len;
+    }
+
+    /// Number of alternations tried second branch first
+    pub fn swappedCount(self: Self) usize {
+        var count: usize = 0;
+        for (self.swapped) |swapped| count += @intFromBool(swapped);
+        return count;
+    }
+};
+
+/// Write the branch counters of `profile` for `bytecode` in the import format
+///
+///     zregexp-branch-profile v1 crc=<program crc32, hex> len=<program bytes>
+///     <pc> <first branch wins> <second branch wins>
+///     ...
+pub fn writeProfile(bytecode: []const u8, profile: *const Profile, writer: anytype) !void {
+    try writer.print("{s} crc={x:0>8} len={d}\n", .{ HEADER, std.hash.Crc32.hash(bytecode), bytecode.len });
+
+    var pc: usize = 0;
+    while (pc < bytecode.len) {
+        const inst = try format.decodeInstruction(bytecode, pc);
+        if (isSplit(inst.opcode)) {
+            const first = @atomicLoad(u64, &profile.first_wins[pc], .monotonic);
+            const second = @atomicLoad(u64, &profile.second_wins[pc], .monotonic);
+            if (first != 0 or second != 0) try writer.print("{d} {d} {d}\n", .{ pc, first, second });
+        }
+        pc += inst.size;
+    }
+}
+
+/// Whether the answer of a boolean query is independent of branch order
+pub fn isReorderable(bytecode: []const u8) bool {
+    var pc: usize = 0;
+    while (pc < bytecode.len) {
+        const inst = format.decodeInstruction(bytecode, pc) catch return false;
+        if (inst.opcode == .SPLIT_POSSESSIVE) return false;
+        pc += inst.size;
+    }
+    return true;
+}
+
+fn isSplit(opcode: Opcode) bool {
+    return switch (opcode) {
+        .SPLIT, .SPLIT_GREEDY, .SPLIT_LAZY => true,
+        else => false,
+    };
+}
+
+fn parseField(field: ?[]const u8, prefix: []const u8, base: u8) error{InvalidBranchProfile}!u64 {
+    const text = field orelse return error.InvalidBranchProfile;
+    if (!std.mem.startsWith(u8, text, prefix)) return error.InvalidBranchProfile;
+    return std.fmt.parseInt(u64, text[prefix.len..], base) catch error.InvalidBranchProfile;
+}
+
+fn parseNumber(field: ?[]const u8) error{InvalidBranchProfile}!u64 {
+    const text = field orelse return error.InvalidBranchProfile;
+    return std.fmt.parseInt(u64, text, 10) catch error.InvalidBranchProfile;
+}
+
+/// PC of the first alternation SPLIT (tests)
+fn firstSplit(bytecode: []const u8) !usize {
+    var pc: usize = 0;
+    while (pc < bytecode.len) {
+        const inst = try format.decodeInstruction(bytecode, pc);
+        if (isSplit(inst.opcode)) return pc;
+        pc += inst.size;
+    }
+    return error.TestUnexpectedResult;
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "BranchOrder: swaps alternations whose second branch wins" {
+    const compiler = @import("../codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "cat|dog");
+    defer compiled.deinit();
+
+    const split = try firstSplit(compiled.bytecode);
+
+    var profile = try Profile.init(std.testing.allocator, compiled.bytecode.len);
+    defer profile.deinit();
+    profile.recordBranchWin(split, false);
+    profile.recordBranchWin(split, true);
+    profile.recordBranchWin(split, true);
+
+    const order = try BranchOrder.fromProfile(std.testing.allocator, compiled.bytecode, &profile);
+    defer order.deinit();
+    try std.testing.expect(order.swapped[split]);
+    try std.testing.expectEqual(@as(usize, 1), order.swappedCount());
+}
+
+test "BranchOrder: export and import round trip" {
+    const compiler = @import("../codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "cat|dog");
+    defer compiled.deinit();
+
+    const split = try firstSplit(compiled.bytecode);
+
+    var profile = try Profile.init(std.testing.allocator, compiled.bytecode.len);
+    defer profile.deinit();
+    profile.recordBranchWin(split, true);
+
+    var text: std.ArrayListUnmanaged(u8) = .empty;
+    defer text.deinit(std.testing.allocator);
+    try writeProfile(compiled.bytecode, &profile, text.writer(std.testing.allocator));
+    try std.testing.expect(std.mem.startsWith(u8, text.items, HEADER ++ " crc="));
+    var line_buf: [32]u8 = undefined;
+    const line = try std.fmt.bufPrint(&line_buf, "\n{d} 0 1\n", .{split});
+    try std.testing.expect(std.mem.endsWith(u8, text.items, line));
+
+    const order = try BranchOrder.parse(std.testing.allocator, compiled.bytecode, text.items);
+    defer order.deinit();
+    try std.testing.expect(order.swapped[split]);
+
+    // A different program rejects the profile
+    const other = try compiler.compileSimple(std.testing.allocator, "cow|dog");
+    defer other.deinit();
+    try std.testing.expectError(error.BranchProfileMismatch, BranchOrder.parse(std.testing.allocator, other.bytecode, text.items));
+    try std.testing.expectError(error.InvalidBranchProfile, BranchOrder.parse(std.testing.allocator, compiled.bytecode, "hello\n"));
+}
+
+test "BranchOrder: possessive programs keep their order" {
+    const compiler = @import("../codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "(a|ab)*+c");
+    defer compiled.deinit();
+
+    try std.testing.expect(!isReorderable(compiled.bytecode));
+
+    const wins = try std.testing.allocator.alloc(u64, compiled.bytecode.len);
+    defer std.testing.allocator.free(wins);
+    @memset(wins, 1);
+    const none = try std.testing.allocator.alloc(u64, compiled.bytecode.len);
+    defer std.testing.allocator.free(none);
+    @memset(none, 0);
+
+    const order = try BranchOrder.fromCounts(std.testing.allocator, compiled.bytecode, none, wins);
+    defer order.deinit();
+    try std.testing.expectEqual(@as(usize, 0), order.swappedCount());
+}
@@ -0,0 +1,74 @@
+//! Pre-decoded program
+//!
+//! The interpreter decodes the instruction at every step it takes. A
+//! DecodedProgram does that once for the whole program and keeps the results
+//! indexed by PC, so the matcher's decode becomes a table load. It costs
+//! roughly @sizeOf(?Instruction) per bytecode byte, which is why it is only
+//! built for hot regexes (see tiering.zig).
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const format = @import("../bytecode/format.zig");
+
+const Instruction = format.Instruction;
+
+/// Instructions of a program indexed by PC
+pub const DecodedProgram = struct {
+    allocator: Allocator,
+
+    /// Decoded instruction at each instruction start, null elsewhere (cache-line aligned)
+    insts: []align(format.program_alignment.toByteUnits()) ?Instruction,
+
+    const Self = @This();
+
+    /// Decode every instruction of `bytecode`
+    pub fn init(allocator: Allocator, bytecode: []const u8) !Self {
+        const insts = try allocator.alignedAlloc(?Instruction, format.program_alignment, bytecode.len);
+        errdefer allocator.free(insts);
+        @memset(insts, null);
+
+        var pc: usize = 0;
+        while (pc < bytecode.len) {
+            const inst = try format.decodeInstruction(bytecode, pc);
+            insts[pc] = inst;
+            pc += inst.size;
+        }
+
+        return .{
+            .allocator = allocator,
+            .insts = insts,
+        };
+    }
+
+    /// Free the table
+    pub fn deinit(self: Self) void {
+        self.allocator.free(self.insts);
+    }
+
+    /// Heap bytes owned by the table
+    pub fn memoryUsage(self: Self) usize {
+        return self.insts.len * @sizeOf(?Instruction);
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "DecodedProgram: matches the decoder at every instruction" {
+    const compiler = @import("../codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "a[0-9]+(b|c)");
+    defer compiled.deinit();
+
+    const decoded = try DecodedProgram.init(std.testing.allocator, compiled.bytecode);
+    defer decoded.deinit();
+
+    var pc: usize = 0;
+    while (pc < compiled.bytecode.len) {
+        const expected = try format.decodeInstruction(compiled.bytecode, pc);
+        const actual = decoded.insts[pc].?;
+        try std.testing.expectEqual(expected.opcode, actual.opcode);
+        try std.testing.expectEqual(expected.operands, actual.operands);
+        pc += expected.size;
+    }
+}
@@ -0,0 +1,83 @@
+//! Per-call execution statistics
+//!
+//! ExecStats is an optional out-parameter for matching calls. It reports how
+//! much work a single find/matchFull performed, so expensive patterns can be
+//! identified in production and optimizations can be verified.
+
+const std = @import("std");
+
+/// Engine that executed a call
+pub const Engine = enum(u8) {
+    /// No engine ran (e.g. the prefilter rejected the input)
+    none = 0,
+
+    /// Recursive backtracking matcher
+    backtrack = 1,
+
+    /// Recursive backtracking matcher over a pre-decoded program
+    backtrack_decoded = 2,
+};
+
+/// Work counters for one matching call
+pub const ExecStats = struct {
+    /// Instructions executed (matchFrom calls), summed over start positions
+    steps: u64 = 0,
+
+    /// Times a failed branch fell back to an alternative
+    backtracks: u64 = 0,
+
+    /// Deepest recursion reached
+    max_depth: u64 = 0,
+
+    /// Start positions attempted
+    start_positions: u64 = 0,
+
+    /// Calls whose input passed the literal prefilter
+    prefilter_candidates: u64 = 0,
+
+    /// Calls rejected by the literal prefilter without running the matcher
+    prefilter_skips: u64 = 0,
+
+    /// Input bytes examined: prefilter scan plus the furthest position the matcher reached
+    bytes_scanned: u64 = 0,
+
+    /// Engine used for the call
+    engine: Engine = .none,
+
+    /// Calls answered (or, for find, located) from the result cache
+    cache_hits: u64 = 0,
+
+    /// Clear all counters
+    pub fn reset(self: *ExecStats) void {
+        self.* = .{};
+    }
+
+    /// Fold one matcher run (one start position) into the totals
+    pub fn recordRun(self: *ExecStats, steps: usize, backtracks: usize, max_depth: usize) void {
+        self.engine = .backtrack;
+        self.start_positions += 1;
+        self.steps += steps;
+        self.backtracks += backtracks;
+        self.max_depth = @max(self.max_depth, max_depth);
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "ExecStats: recordRun accumulates" {
+    var stats = ExecStats{};
+    stats.recordRun(10, 2, 5);
+    stats.recordRun(4, 0, 7);
+
+    try std.testing.expectEqual(@as(u64, 14), stats.steps);
+    try std.testing.expectEqual(@as(u64, 2), stats.backtracks);
+    try std.testing.expectEqual(@as(u64, 7), stats.max_depth);
+    try std.testing.expectEqual(@as(u64, 2), stats.start_positions);
+    try std.testing.expectEqual(Engine.backtrack, stats.engine);
+
+    stats.reset();
+    try std.testing.expectEqual(@as(u64, 0), stats.steps);
+    try std.testing.expectEqual(Engine.none, stats.engine);
+}
@@ -7,4 +7,8 @@ test {
     _ = @import("thread.zig");
     _ = @import("vm.zig");
     _ = @import("matcher.zig");
+    _ = @import("exec_stats.zig");
+    _ = @import("profile.zig");
+    _ = @import("decoded.zig");
+    _ = @import("branch_order.zig");
 }
@@ -6,9 +6,15 @@ const std = @import("std");
 const Allocator = std.mem.Allocator;
 const recursive_mod = @import("recursive_matcher.zig");
 const thread_mod = @import("thread.zig");
+const exec_stats = @import("exec_stats.zig");
+const profile_mod = @import("profile.zig");
 
 const RecursiveMatcher = recursive_mod.RecursiveMatcher;
+const Instruction = @import("../bytecode/format.zig").Instruction;
+const ExecOptions = recursive_mod.ExecOptions;
 const Capture = thread_mod.Capture;
+const ExecStats = exec_stats.ExecStats;
+const Profile = profile_mod.Profile;
 
 /// Match result
 pub const MatchResult = struct {
@@ -43,6 +49,18 @@ pub const Matcher = struct {
     allocator: Allocator,
     bytecode: []const u8,
 
+    /// Per-PC counters updated by every run, when profiling
+    profile: ?*const Profile = null,
+
+    /// Step, recursion and stack limits for every run
+    exec_options: ExecOptions = .{},
+
+    /// Pre-decoded instructions for the bytecode, when available
+    decoded: ?[]const ?Instruction = null,
+
+    /// Alternations to try second branch first; only isMatch honours it
+    branch_order: ?[]const bool = null,
+
     const Self = @This();
 
     /// Initialize matcher with compiled bytecode
@@ -55,7 +73,16 @@ pub const Matcher = struct {
 
     /// Check if pattern matches entire input
     pub fn matchFull(self: Self, input: []const u8) !bool {
-        var matcher = RecursiveMatcher.init(self.allocator, self.bytecode, input);
+        return self.matchFullWithStats(input, null);
+    }
+
+    /// matchFull, adding work counters to `stats` when given
+    pub fn matchFullWithStats(self: Self, input: []const u8, stats: ?*ExecStats) !bool {
+        var matcher = self.engine(input);
+        defer if (stats) |s| {
+            recordRun(s, &matcher);
+            s.bytes_scanned += matcher.max_pos;
+        };
 
         const result = try matcher.matchFrom(0, 0);
 
@@ -63,14 +90,66 @@ pub const Matcher = struct {
         return result.matched and result.end_pos == input.len;
     }
 
+    /// Check if pattern matches anywhere in input (no captures are kept)
+    pub fn isMatch(self: Self, input: []const u8) !bool {
+        return self.isMatchWithStats(input, null);
+    }
+
+    /// isMatch, adding work counters to `stats` when given
+    ///
+    /// Only existence is reported, so alternation order does not change the
+    /// answer and the branch order (if any) is applied.
+    pub fn isMatchWithStats(self: Self, input: []const u8, stats: ?*ExecStats) !bool {
+        var furthest: usize = 0;
+        defer if (stats) |s| {
+            s.bytes_scanned += furthest;
+        };
+
+        var start_pos: usize = 0;
+        while (start_pos <= input.len) : (start_pos += 1) {
+            var matcher = self.engine(input);
+            matcher.branch_order = self.branch_order;
+            defer if (stats) |s| {
+                recordRun(s, &matcher);
+                furthest = @max(furthest, matcher.max_pos);
+            };
+
+            const result = try matcher.matchFrom(0, start_pos);
+            if (result.matched) return true;
+        }
+
+        return false;
+    }
+
     /// Find first match in input
     pub fn find(self: Self, input: []const u8) !?MatchResult {
+        return self.findWithStats(input, null);
+    }
+
+    /// find, adding work counters to `stats` when given
+    pub fn findWithStats(self: Self, input: []const u8, stats: ?*ExecStats) !?MatchResult {
+        return self.findFromWithStats(input, 0, stats);
+    }
+
+    /// First match starting at or after `first_start`
+    /// Used to rebuild captures when the start of the first match is already known.
+    pub fn findFromWithStats(self: Self, input: []const u8, first_start: usize, stats: ?*ExecStats) !?MatchResult {
+        // Furthest position any start position reached (bytes examined)
+        var furthest: usize = 0;
+        defer if (stats) |s| {
+            s.bytes_scanned += furthest;
+        };
+
         // Try matching from each position
-        var start_pos: usize = 0;
+        var start_pos: usize = first_start;
         while (start_pos <= input.len) : (start_pos += 1) {
             // Pass the FULL input to matcher (not a slice)
             // This allows lookbehind to see content before start_pos
-            var matcher = RecursiveMatcher.init(self.allocator, self.bytecode, input);
+            var matcher = self.engine(input);
+            defer if (stats) |s| {
+                recordRun(s, &matcher);
+                furthest = @max(furthest, matcher.max_pos);
+            };
 
             // Start matching from start_pos in the full input
             const result = try matcher.matchFrom(0, start_pos);
@@ -100,6 +179,16 @@ pub const Matcher = struct {
 
     /// Find all matches in input
     pub fn findAll(self: Self, input: []const u8) !std.ArrayListUnmanaged(MatchResult) {
+        return self.findAllWithStats(input, null);
+    }
+
+    /// findAll, adding work counters to `stats` when given
+    pub fn findAllWithStats(self: Self, input: []const u8, stats: ?*ExecStats) !std.ArrayListUnmanaged(MatchResult) {
+        var furthest: usize = 0;
+        defer if (stats) |s| {
+            s.bytes_scanned += furthest;
+        };
+
         var matches: std.ArrayListUnmanaged(MatchResult) = .empty;
         errdefer {
             for (matches.items) |match| {
@@ -112,7 +201,11 @@ pub const Matcher = struct {
         while (pos < input.len) {
             // Pass the FULL input to matcher (not a slice)
             // This allows lookbehind to see content before pos
-            var matcher = RecursiveMatcher.init(self.allocator, self.bytecode, input);
+            var matcher = self.engine(input);
+            defer if (stats) |s| {
+                recordRun(s, &matcher);
+                furthest = @max(furthest, matcher.max_pos);
+            };
 
             // Start matching from pos in the full input
             const result = try matcher.matchFrom(0, pos);
@@ -156,6 +249,19 @@ pub const Matcher = struct {
     pub fn test_(self: Self, input: []const u8) !bool {
         return self.matchFull(input);
     }
+
+    /// Fresh engine for one run over input
+    fn engine(self: Self, input: []const u8) RecursiveMatcher {
+        var matcher = RecursiveMatcher.initWithOptions(self.allocator, self.bytecode, input, self.exec_options);
+        matcher.profile = self.profile;
+        matcher.decoded = self.decoded;
+        return matcher;
+    }
+
+    fn recordRun(stats: *ExecStats, matcher: *const RecursiveMatcher) void {
+        stats.recordRun(matcher.step_count, matcher.backtrack_count, matcher.max_depth);
+        if (matcher.decoded != null) stats.engine = .backtrack_decoded;
+    }
 };
 
 // =============================================================================
@@ -276,3 +382,47 @@ test "Matcher: test_ function" {
     try std.testing.expect(try matcher.test_("test"));
     try std.testing.expect(!try matcher.test_("fail"));
 }
+
+test "Matcher: findWithStats" {
+    const compiler = @import("../codegen/compiler.zig");
+
+    const compiled = try compiler.compileSimple(std.testing.allocator, "b|c");
+    defer compiled.deinit();
+
+    const matcher = Matcher.init(std.testing.allocator, compiled.bytecode);
+    var stats = ExecStats{};
+    const result = try matcher.findWithStats("aac", &stats);
+
+    try std.testing.expect(result != null);
+    defer result.?.deinit();
+
+    // Start positions 0, 1 fail and 2 matches; each failure falls back to 'c'
+    try std.testing.expectEqual(@as(u64, 3), stats.start_positions);
+    try std.testing.expect(stats.backtracks >= 3);
+    try std.testing.expect(stats.steps > 0);
+    try std.testing.expect(stats.max_depth > 0);
+    try std.testing.expectEqual(exec_stats.Engine.backtrack, stats.engine);
+}
+
+test "Matcher: isMatch with branch order" {
+    const compiler = @import("../codegen/compiler.zig");
+
+    const compiled = try compiler.compileSimple(std.testing.allocator, "foo|bar");
+    defer compiled.deinit();
+
+    var matcher = Matcher.init(std.testing.allocator, compiled.bytecode);
+    try std.testing.expect(try matcher.isMatch("a bar"));
+    try std.testing.expect(!try matcher.isMatch("baz"));
+
+    // Trying 'bar' first at the alternation gives the same answers
+    const order = try std.testing.allocator.alloc(bool, compiled.bytecode.len);
+    defer std.testing.allocator.free(order);
+    @memset(order, true);
+    matcher.branch_order = order;
+
+    var stats = ExecStats{};
+    try std.testing.expect(try matcher.isMatchWithStats("bar", &stats));
+    try std.testing.expectEqual(@as(u64, 0), stats.backtracks);
+    try std.testing.expect(try matcher.isMatch("a foo"));
+    try std.testing.expect(!try matcher.isMatch("baz"));
+}
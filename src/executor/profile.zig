@@ -0,0 +1,188 @@
+//! Per-instruction execution profile
+//!
+//! A Profile counts how often each bytecode instruction was executed and how
+//! often it returned without a match (a backtrack return). Counters are
+//! indexed by PC and updated atomically, so a profiled Regex can still be
+//! shared between threads. dump() renders the program as a disassembly
+//! annotated with the counts as a heatmap and with the pattern bytes each
+//! instruction was generated from.
+//!
+//! At alternation SPLITs it also counts which branch led to the match, in
+//! bytecode order; branch_order.zig turns those counts into a reordering
+//! for boolean queries.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const reader_mod = @import("../bytecode/reader.zig");
+const compiler = @import("../codegen/compiler.zig");
+
+const BytecodeReader = reader_mod.BytecodeReader;
+const CompileResult = compiler.CompileResult;
+
+/// Width of the heatmap bar in characters
+const HEAT_WIDTH = 10;
+
+/// Execution and backtrack counters per bytecode PC
+pub const Profile = struct {
+    allocator: Allocator,
+
+    /// Times the instruction at each PC was executed
+    execs: []u64,
+
+    /// Times the instruction at each PC returned without a match
+    backtracks: []u64,
+
+    /// Matches through the first branch of the alternation at each PC
+    first_wins: []u64,
+
+    /// Matches through the second branch of the alternation at each PC
+    second_wins: []u64,
+
+    const Self = @This();
+
+    /// Create a zeroed profile for a program of `code_len` bytes
+    pub fn init(allocator: Allocator, code_len: usize) Allocator.Error!Self {
+        const execs = try allocator.alloc(u64, code_len);
+        errdefer allocator.free(execs);
+        const backtracks = try allocator.alloc(u64, code_len);
+        errdefer allocator.free(backtracks);
+        const first_wins = try allocator.alloc(u64, code_len);
+        errdefer allocator.free(first_wins);
+        const second_wins = try allocator.alloc(u64, code_len);
+
+        @memset(execs, 0);
+        @memset(backtracks, 0);
+        @memset(first_wins, 0);
+        @memset(second_wins, 0);
+
+        return .{
+            .allocator = allocator,
+            .execs = execs,
+            .backtracks = backtracks,
+            .first_wins = first_wins,
+            .second_wins = second_wins,
+        };
+    }
+
+    /// Free the counters
+    pub fn deinit(self: Self) void {
+        self.allocator.free(self.execs);
+        self.allocator.free(self.backtracks);
+        self.allocator.free(self.first_wins);
+        self.allocator.free(self.second_wins);
+    }
+
+    /// Heap bytes owned by the profile, including the Profile itself
+    pub fn memoryUsage(self: Self) usize {
+        const counters = self.execs.len + self.backtracks.len + self.first_wins.len + self.second_wins.len;
+        return @sizeOf(Self) + counters * @sizeOf(u64);
+    }
+
+    /// Count one execution of the instruction at `pc`
+    pub fn recordExec(self: Self, pc: usize) void {
+        _ = @atomicRmw(u64, &self.execs[pc], .Add, 1, .monotonic);
+    }
+
+    /// Count one failed return from the instruction at `pc`
+    pub fn recordBacktrack(self: Self, pc: usize) void {
+        _ = @atomicRmw(u64, &self.backtracks[pc], .Add, 1, .monotonic);
+    }
+
+    /// Count one match through branch `second` (0 or 1) of the alternation at `pc`
+    pub fn recordBranchWin(self: Self, pc: usize, second: bool) void {
+        const counters = if (second) self.second_wins else self.first_wins;
+        _ = @atomicRmw(u64, &counters[pc], .Add, 1, .monotonic);
+    }
+
+    /// Clear all counters
+    pub fn reset(self: Self) void {
+        for (self.execs, self.backtracks, self.first_wins, self.second_wins) |*exec, *backtrack, *first, *second| {
+            @atomicStore(u64, exec, 0, .monotonic);
+            @atomicStore(u64, backtrack, 0, .monotonic);
+            @atomicStore(u64, first, 0, .monotonic);
+            @atomicStore(u64, second, 0, .monotonic);
+        }
+    }
+
+    /// Disassemble `compiled` annotated with the counters and source spans
+    pub fn dump(self: Self, compiled: CompileResult, pattern: []const u8, writer: anytype) !void {
+        var hottest: u64 = 0;
+        for (self.execs) |*exec| hottest = @max(hottest, @atomicLoad(u64, exec, .monotonic));
+
+        try writer.writeAll("  pc       execs  backtracks  heat        instruction\n");
+
+        var reader = BytecodeReader.init(compiled.bytecode);
+        while (try reader.next()) |inst| {
+            const pc = reader.currentOffset() - inst.size;
+            const execs = @atomicLoad(u64, &self.execs[pc], .monotonic);
+            const backtracks = @atomicLoad(u64, &self.backtracks[pc], .monotonic);
+
+            try writer.print("{x:04}  {d:>10}  {d:>10}  ", .{ pc, execs, backtracks });
+            try writeHeat(execs, hottest, writer);
+            try writer.writeAll("  ");
+            try reader_mod.formatInstruction(inst, pc, writer);
+
+            if (compiled.sourceSpanAt(pc)) |span| {
+                if (span.src_end <= pattern.len) {
+                    try writer.print("  ; [{d}..{d}) {s}", .{ span.src_start, span.src_end, pattern[span.src_start..span.src_end] });
+                }
+            }
+
+            try writer.writeAll("\n");
+        }
+    }
+
+    /// Bar proportional to `count` relative to the hottest instruction
+    fn writeHeat(count: u64, hottest: u64, writer: anytype) !void {
+        const filled: usize = if (hottest == 0) 0 else @intCast((count * HEAT_WIDTH + hottest - 1) / hottest);
+
+        try writer.writeAll("|");
+        for (0..HEAT_WIDTH) |i| {
+            try writer.writeAll(if (i < filled) "#" else " ");
+        }
+        try writer.writeAll("|");
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "Profile: record and reset" {
+    var profile = try Profile.init(std.testing.allocator, 8);
+    defer profile.deinit();
+
+    profile.recordExec(0);
+    profile.recordExec(0);
+    profile.recordBacktrack(5);
+    profile.recordBranchWin(3, true);
+
+    try std.testing.expectEqual(@as(u64, 2), profile.execs[0]);
+    try std.testing.expectEqual(@as(u64, 1), profile.backtracks[5]);
+    try std.testing.expectEqual(@as(u64, 1), profile.second_wins[3]);
+    try std.testing.expectEqual(@as(u64, 0), profile.first_wins[3]);
+
+    profile.reset();
+    try std.testing.expectEqual(@as(u64, 0), profile.execs[0]);
+    try std.testing.expectEqual(@as(u64, 0), profile.backtracks[5]);
+    try std.testing.expectEqual(@as(u64, 0), profile.second_wins[3]);
+}
+
+test "Profile: dump annotates instructions" {
+    const pattern = "ab";
+    const compiled = try compiler.compile(std.testing.allocator, pattern, .{ .profile = true });
+    defer compiled.deinit();
+
+    var profile = try Profile.init(std.testing.allocator, compiled.bytecode.len);
+    defer profile.deinit();
+    profile.recordExec(0);
+
+    var buf: std.ArrayListUnmanaged(u8) = .empty;
+    defer buf.deinit(std.testing.allocator);
+    try profile.dump(compiled, pattern, buf.writer(std.testing.allocator));
+
+    const output = buf.items;
+    try std.testing.expect(std.mem.indexOf(u8, output, "CHAR32 'a'") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "|##########|") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "; [0..1) a") != null);
+}
@@ -13,9 +13,13 @@ const std = @import("std");
 const Allocator = std.mem.Allocator;
 const opcodes = @import("../bytecode/opcodes.zig");
 const format = @import("../bytecode/format.zig");
+const profile_mod = @import("profile.zig");
+const probes = @import("../utils/probes.zig");
+const dispatch = @import("../utils/dispatch.zig");
 
 const Opcode = opcodes.Opcode;
 const Instruction = format.Instruction;
+const Profile = profile_mod.Profile;
 
 /// Maximum number of capture groups supported
 const MAX_CAPTURE_GROUPS = 16;
@@ -34,6 +38,9 @@ pub const ExecOptions = struct {
     /// Maximum execution steps (0 = unlimited, not recommended)
     max_steps: usize = DEFAULT_MAX_STEPS,
 
+    /// Maximum native stack the backtracking recursion may use (0 = unlimited)
+    max_scratch_bytes: usize = 0,
+
     /// Create options with unlimited limits (dangerous!)
     pub fn unlimited() ExecOptions {
         return .{
@@ -88,10 +95,32 @@ pub const RecursiveMatcher = struct {
     step_count: usize,
     exec_options: ExecOptions,
 
+    /// Deepest recursion reached (for ExecStats)
+    max_depth: usize,
+
+    /// Failed branches that fell back to an alternative (for ExecStats)
+    backtrack_count: usize,
+
+    /// Furthest input position examined (for ExecStats)
+    max_pos: usize,
+
+    /// Per-PC counters to update, when profiling
+    profile: ?*const Profile = null,
+
+    /// Stack address at the outermost matchFrom, for the scratch limit
+    stack_base: usize = 0,
+
+    /// Pre-decoded instructions, when the regex has been promoted to that tier
+    decoded: ?[]const ?Instruction = null,
+
+    /// Per-PC flag: try the second branch of the alternation first
+    /// (boolean queries only, see branch_order.zig)
+    branch_order: ?[]const bool = null,
+
     const Self = @This();
 
     /// Error set for matching operations
-    pub const MatchError = error{ OutOfMemory, UnknownOpcode, UnexpectedEndOfBytecode, RecursionLimitExceeded, StepLimitExceeded };
+    pub const MatchError = error{ OutOfMemory, UnknownOpcode, UnexpectedEndOfBytecode, RecursionLimitExceeded, StepLimitExceeded, ScratchLimitExceeded };
 
     pub fn init(allocator: Allocator, bytecode: []const u8, input: []const u8) Self {
         return Self.initWithOptions(allocator, bytecode, input, ExecOptions{});
@@ -106,15 +135,20 @@ pub const RecursiveMatcher = struct {
             .recursion_depth = 0,
             .step_count = 0,
             .exec_options = options,
+            .max_depth = 0,
+            .backtrack_count = 0,
+            .max_pos = 0,
         };
     }
 
     /// Match from specific PC and string position
-    pub fn matchFrom(self: *Self, pc: usize, pos: usize) error{ OutOfMemory, UnknownOpcode, UnexpectedEndOfBytecode, RecursionLimitExceeded, StepLimitExceeded }!MatchResult {
+    pub fn matchFrom(self: *Self, pc: usize, pos: usize) MatchError!MatchResult {
         // Check step limit (protects against ReDoS)
+        self.step_count += 1;
         if (self.exec_options.max_steps > 0) {
-            self.step_count += 1;
             if (self.step_count >= self.exec_options.max_steps) {
+                @branchHint(.cold);
+                probes.probe3("budget__exceeded", 0, self.step_count, self.recursion_depth);
                 return error.StepLimitExceeded;
             }
         }
@@ -122,19 +156,64 @@ pub const RecursiveMatcher = struct {
         // Check recursion depth limit (protects against stack overflow)
         if (self.exec_options.max_recursion_depth > 0) {
             if (self.recursion_depth >= self.exec_options.max_recursion_depth) {
+                @branchHint(.cold);
+                probes.probe3("budget__exceeded", 1, self.step_count, self.recursion_depth);
                 return error.RecursionLimitExceeded;
             }
         }
 
+        // Check stack use (the backtrack stack is the native call stack)
+        if (self.exec_options.max_scratch_bytes > 0) {
+            var marker: u8 = 0;
+            const here = @intFromPtr(&marker);
+            if (self.recursion_depth == 0) self.stack_base = here;
+
+            const used = if (self.stack_base > here) self.stack_base - here else here - self.stack_base;
+            if (used > self.exec_options.max_scratch_bytes) {
+                @branchHint(.cold);
+                probes.probe3("budget__exceeded", 2, self.step_count, self.recursion_depth);
+                return error.ScratchLimitExceeded;
+            }
+        }
+
         self.recursion_depth += 1;
         defer self.recursion_depth -= 1;
 
+        if (self.recursion_depth > self.max_depth) self.max_depth = self.recursion_depth;
+        if (pos > self.max_pos) self.max_pos = pos;
+
         // Check bounds
         if (pc >= self.bytecode.len) {
             return MatchResult{ .matched = false, .end_pos = pos };
         }
 
-        const inst = try format.decodeInstruction(self.bytecode, pc);
+        if (self.profile) |profile| profile.recordExec(pc);
+
+        const result = try self.execute(pc, pos);
+        if (self.profile) |profile| {
+            if (!result.matched) profile.recordBacktrack(pc);
+        }
+        return result;
+    }
+
+    /// Count a match through branch `second` of the alternation at `pc`, when profiling
+    fn recordBranchWin(self: *const Self, pc: usize, second: bool) void {
+        if (self.profile) |profile| profile.recordBranchWin(pc, second);
+    }
+
+    /// Instruction at `pc`, from the pre-decoded table when there is one
+    inline fn decode(self: *const Self, pc: usize) MatchError!Instruction {
+        if (self.decoded) |table| {
+            if (pc < table.len) {
+                if (table[pc]) |inst| return inst;
+            }
+        }
+        return format.decodeInstruction(self.bytecode, pc);
+    }
+
+    /// Execute the instruction at `pc` (bounds already checked)
+    inline fn execute(self: *Self, pc: usize, pos: usize) MatchError!MatchResult {
+        const inst = try self.decode(pc);
 
         switch (inst.opcode) {
             .MATCH => {
@@ -274,13 +353,18 @@ pub const RecursiveMatcher = struct {
                     } else {
                         // Regular alternation: try first path, backtrack to second if needed
                         // This prevents infinite loops by using proper backtracking
-                        const result1 = try self.matchFrom(pc1, pos);
+                        const swapped = if (self.branch_order) |order| pc < order.len and order[pc] else false;
+                        const result1 = try self.matchFrom(if (swapped) pc2 else pc1, pos);
                         if (result1.matched) {
+                            self.recordBranchWin(pc, swapped);
                             return result1;
                         }
 
                         // First path failed, try second path
-                        return self.matchFrom(pc2, pos);
+                        self.backtrack_count += 1;
+                        const result2 = try self.matchFrom(if (swapped) pc1 else pc2, pos);
+                        if (result2.matched) self.recordBranchWin(pc, !swapped);
+                        return result2;
                     }
                 }
             },
@@ -303,13 +387,16 @@ pub const RecursiveMatcher = struct {
                 return self.matchFrom(pc + inst.size, pos);
             },
 
+            // Backreferences and lookbehinds are rare; keep them out of the hot dispatch path
             .BACK_REF => {
+                @branchHint(.unlikely);
                 // Match backreference to capture group (case-sensitive)
                 const group = @as(usize, @intCast(inst.operands[0]));
                 return self.matchBackRef(pc, pos, group, false, inst.size);
             },
 
             .BACK_REF_I => {
+                @branchHint(.unlikely);
                 // Match backreference to capture group (case-insensitive)
                 const group = @as(usize, @intCast(inst.operands[0]));
                 return self.matchBackRef(pc, pos, group, true, inst.size);
@@ -336,11 +423,13 @@ pub const RecursiveMatcher = struct {
             },
 
             .LOOKBEHIND => {
+                @branchHint(.unlikely);
                 // Positive lookbehind - assert pattern matches behind current position
                 return self.matchLookbehind(pc, pos, false, inst.size);
             },
 
             .NEGATIVE_LOOKBEHIND => {
+                @branchHint(.unlikely);
                 // Negative lookbehind - assert pattern does NOT match behind
                 return self.matchLookbehind(pc, pos, true, inst.size);
             },
@@ -387,6 +476,7 @@ pub const RecursiveMatcher = struct {
             },
 
             else => {
+                @branchHint(.cold);
                 // Unsupported opcode
                 return MatchResult{ .matched = false, .end_pos = pos };
             },
@@ -488,7 +578,7 @@ pub const RecursiveMatcher = struct {
         // Check if pc2 points to a char-consuming instruction
         if (pc2 >= self.bytecode.len) return false;
 
-        const inst = try format.decodeInstruction(self.bytecode, pc2);
+        const inst = try self.decode(pc2);
         const consumes_char = switch (inst.opcode) {
             .CHAR, .CHAR32, .CHAR_RANGE, .CHAR_RANGE_INV, .CHAR_CLASS, .CHAR2 => true,
             else => false,
@@ -499,7 +589,7 @@ pub const RecursiveMatcher = struct {
         const next_pc = pc2 + inst.size;
         if (next_pc >= self.bytecode.len) return true; // Char followed by end
 
-        const next_inst = try format.decodeInstruction(self.bytecode, next_pc);
+        const next_inst = try self.decode(next_pc);
         if (next_inst.opcode == .GOTO) return false; // It's a loop, not a question
 
         // pc1 should point near or after the char instruction (the skip path)
@@ -512,7 +602,7 @@ pub const RecursiveMatcher = struct {
         // Check if consume_pc points to a character-consuming instruction
         if (consume_pc >= self.bytecode.len) return false;
 
-        const inst1 = try format.decodeInstruction(self.bytecode, consume_pc);
+        const inst1 = try self.decode(consume_pc);
         const consumes_char = switch (inst1.opcode) {
             .CHAR, .CHAR32, .CHAR_RANGE, .CHAR_RANGE_INV => true,
             else => false,
@@ -523,7 +613,7 @@ pub const RecursiveMatcher = struct {
         const next_pc = consume_pc + inst1.size;
         if (next_pc >= self.bytecode.len) return false;
 
-        const inst2 = try format.decodeInstruction(self.bytecode, next_pc);
+        const inst2 = try self.decode(next_pc);
         if (inst2.opcode != .GOTO) return false;
 
         // Check if GOTO jumps back to SPLIT (loop pattern)
@@ -548,45 +638,86 @@ pub const RecursiveMatcher = struct {
 
     /// Greedy star: consume maximum, then backtrack
     fn matchStarGreedy(self: *Self, pc_char: usize, pc_rest: usize, pos: usize) MatchError!MatchResult {
-        var current_pos = pos;
-
-        // PHASE 1: Greedy consumption - match as many as possible
-        var positions: std.ArrayList(usize) = .empty;
-        defer positions.deinit(self.allocator);
-
-        try positions.append(self.allocator, current_pos); // Include zero matches
-
         // Get the character instruction to match
-        const char_inst = try format.decodeInstruction(self.bytecode, pc_char);
-
-        while (current_pos < self.input.len) {
-            // Match just the character instruction, not the full pattern
-            const matched = try self.matchSingleInstruction(char_inst, pc_char, current_pos);
-            if (!matched.matched) break;
+        const char_inst = try self.decode(pc_char);
 
-            // Prevent infinite loop if char didn't consume anything
-            if (matched.end_pos == current_pos) break;
+        // PHASE 1: Greedy consumption - every repeatable element consumes exactly
+        // one byte, so the candidate end positions are the contiguous range pos..run_end
+        const run_end = try self.scanRun(char_inst, pc_char, pos);
 
-            current_pos = matched.end_pos;
-            try positions.append(self.allocator, current_pos);
-        }
+        // If the rest starts with a literal, only positions holding that byte can match
+        const rest_literal = try self.leadingLiteral(pc_rest);
 
         // PHASE 2: Try rest of pattern from each position (longest first)
-        var i: usize = positions.items.len;
-        while (i > 0) {
-            i -= 1;
-            const try_pos = positions.items[i];
+        var try_pos = run_end;
+        while (true) {
+            if (rest_literal) |lit| {
+                // Jump straight to the last candidate position holding the literal
+                const window_end = @min(try_pos + 1, self.input.len);
+                const found = dispatch.lastIndexOfScalar(self.input[pos..window_end], lit) orelse break;
+                try_pos = pos + found;
+            }
 
             const rest_result = try self.matchFrom(pc_rest, try_pos);
             if (rest_result.matched) {
                 return rest_result;
             }
+
+            if (try_pos == pos) break;
+            try_pos -= 1;
+            self.backtrack_count += 1;
         }
 
         // Failed to match
         return MatchResult{ .matched = false, .end_pos = pos };
     }
 
+    /// Find where a run of the star element starting at pos ends
+    /// Byte-range runs (e.g. glob `*`, [^/]*, [a-z]*) use the SIMD kernels
+    fn scanRun(self: *Self, inst: Instruction, pc: usize, pos: usize) MatchError!usize {
+        switch (inst.opcode) {
+            .CHAR => return self.input.len,
+            .CHAR_RANGE => {
+                const min = inst.operands[0];
+                const max = inst.operands[1];
+                if (min <= max and max <= 0xFF) {
+                    return dispatch.spanInRange(self.input, pos, @intCast(min), @intCast(max));
+                }
+            },
+            .CHAR_RANGE_INV => {
+                const min = inst.operands[0];
+                const max = inst.operands[1];
+                if (min == max and min <= 0xFF) {
+                    return dispatch.indexOfScalarPos(self.input, pos, @intCast(min)) orelse self.input.len;
+                }
+                if (min <= max and max <= 0xFF) {
+                    return dispatch.indexOfRange(self.input, pos, @intCast(min), @intCast(max)) orelse self.input.len;
+                }
+            },
+            else => {},
+        }
+
+        var end = pos;
+        while (end < self.input.len) {
+            const matched = try self.matchSingleInstruction(inst, pc, end);
+            if (!matched.matched) break;
+
+            // Prevent infinite loop if char didn't consume anything
+            if (matched.end_pos == end) break;
+
+            end = matched.end_pos;
+        }
+        return end;
+    }
+
+    /// Literal byte the instruction at pc requires, if it is a plain CHAR32
+    fn leadingLiteral(self: *Self, pc: usize) MatchError!?u8 {
+        if (pc >= self.bytecode.len) return null;
+        const inst = try self.decode(pc);
+        if (inst.opcode != .CHAR32 or inst.operands[0] > 0xFF) return null;
+        return @intCast(inst.operands[0]);
+    }
+
     /// Lazy star: try minimal match first, expand if needed
     fn matchStarLazy(self: *Self, pc_char: usize, pc_rest: usize, pos: usize) MatchError!MatchResult {
         var current_pos = pos;
@@ -598,7 +729,7 @@ pub const RecursiveMatcher = struct {
         }
 
         // Get the character instruction to match
-        const char_inst = try format.decodeInstruction(self.bytecode, pc_char);
+        const char_inst = try self.decode(pc_char);
 
         // If that fails, try consuming one char at a time
         while (current_pos < self.input.len) {
@@ -606,6 +737,7 @@ pub const RecursiveMatcher = struct {
             if (!matched.matched) break;
 
             current_pos = matched.end_pos;
+            self.backtrack_count += 1;
 
             // Try rest again
             const rest_result2 = try self.matchFrom(pc_rest, current_pos);
@@ -622,24 +754,14 @@ pub const RecursiveMatcher = struct {
 
     /// Possessive star: consume all without backtracking
     fn matchStarPossessive(self: *Self, pc_char: usize, pc_rest: usize, pos: usize) MatchError!MatchResult {
-        var current_pos = pos;
-
         // Get the character instruction to match
-        const char_inst = try format.decodeInstruction(self.bytecode, pc_char);
+        const char_inst = try self.decode(pc_char);
 
         // Consume ALL matching characters (possessive = no backtracking)
-        while (current_pos < self.input.len) {
-            const matched = try self.matchSingleInstruction(char_inst, pc_char, current_pos);
-            if (!matched.matched) break;
-
-            // Prevent infinite loop if char didn't consume anything
-            if (matched.end_pos == current_pos) break;
-
-            current_pos = matched.end_pos;
-        }
+        const run_end = try self.scanRun(char_inst, pc_char, pos);
 
         // Try rest ONCE from final position (no backtracking)
-        return self.matchFrom(pc_rest, current_pos);
+        return self.matchFrom(pc_rest, run_end);
     }
 
     /// Match a single instruction without advancing PC
@@ -779,7 +901,7 @@ pub const RecursiveMatcher = struct {
         var depth: usize = 1; // Track nested lookaheads
 
         while (pc < self.bytecode.len) {
-            const inst = try format.decodeInstruction(self.bytecode, pc);
+            const inst = try self.decode(pc);
 
             switch (inst.opcode) {
                 .LOOKAHEAD, .NEGATIVE_LOOKAHEAD => {
@@ -877,7 +999,7 @@ pub const RecursiveMatcher = struct {
         var depth: usize = 1; // Track nested lookbehinds
 
         while (pc < self.bytecode.len) {
-            const inst = try format.decodeInstruction(self.bytecode, pc);
+            const inst = try self.decode(pc);
 
             switch (inst.opcode) {
                 .LOOKBEHIND, .NEGATIVE_LOOKBEHIND => {
@@ -1018,6 +1140,39 @@ test "RecursiveMatcher: simple star quantifier" {
     }
 }
 
+test "RecursiveMatcher: greedy star backtracks to last literal" {
+    const compiler = @import("../codegen/compiler.zig");
+
+    const result = try compiler.compileSimple(std.testing.allocator, ".*b");
+    defer result.deinit();
+
+    var matcher = RecursiveMatcher.init(std.testing.allocator, result.bytecode, "abcbd");
+    const exec_result = try matcher.matchFrom(0, 0);
+
+    try std.testing.expect(exec_result.matched);
+    try std.testing.expectEqual(@as(usize, 4), exec_result.end_pos);
+}
+
+test "RecursiveMatcher: segment-bounded star stops at separator" {
+    const glob = @import("../codegen/glob.zig");
+
+    const result = try glob.compileGlob(std.testing.allocator, "*.c", .{});
+    defer result.deinit();
+
+    {
+        var matcher = RecursiveMatcher.init(std.testing.allocator, result.bytecode, "main.c");
+        const exec_result = try matcher.matchFrom(0, 0);
+        try std.testing.expect(exec_result.matched);
+        try std.testing.expectEqual(@as(usize, 6), exec_result.end_pos);
+    }
+
+    {
+        var matcher = RecursiveMatcher.init(std.testing.allocator, result.bytecode, "src/main.c");
+        const exec_result = try matcher.matchFrom(0, 0);
+        try std.testing.expect(!exec_result.matched);
+    }
+}
+
 test "RecursiveMatcher: ReDoS protection - step limit" {
     const compiler = @import("../codegen/compiler.zig");
 
@@ -1055,6 +1210,24 @@ test "RecursiveMatcher: ReDoS protection - recursion limit" {
     try std.testing.expectError(error.RecursionLimitExceeded, exec_result);
 }
 
+test "RecursiveMatcher: ExecOptions - scratch limit" {
+    const compiler = @import("../codegen/compiler.zig");
+
+    const result = try compiler.compileSimple(std.testing.allocator, "(ab)*c");
+    defer result.deinit();
+
+    const input = "ab" ** 2000;
+    var options = ExecOptions.unlimited();
+    options.max_scratch_bytes = 4096;
+
+    var matcher = RecursiveMatcher.initWithOptions(std.testing.allocator, result.bytecode, input, options);
+    try std.testing.expectError(error.ScratchLimitExceeded, matcher.matchFrom(0, 0));
+
+    // A short input stays within the limit
+    var small = RecursiveMatcher.initWithOptions(std.testing.allocator, result.bytecode, "ababc", options);
+    try std.testing.expect((try small.matchFrom(0, 0)).matched);
+}
+
 test "RecursiveMatcher: ExecOptions - default values" {
     const options = ExecOptions{};
     try std.testing.expectEqual(@as(usize, DEFAULT_MAX_RECURSION_DEPTH), options.max_recursion_depth);
@@ -52,7 +52,10 @@ pub const BitSet256 = @import("utils/bitset.zig").BitSet256;
 pub const DynBitSet = @import("utils/bitset.zig").DynBitSet;
 pub const Pool = @import("utils/pool.zig").Pool;
 pub const Pooled = @import("utils/pool.zig").Pooled;
+pub const CountingAllocator = @import("utils/counting_allocator.zig").CountingAllocator;
+pub const AllocStats = @import("utils/counting_allocator.zig").AllocStats;
 pub const debug = @import("utils/debug.zig");
+pub const dispatch = @import("utils/dispatch.zig");
 
 // Bytecode module exports
 pub const Opcode = @import("bytecode/opcodes.zig").Opcode;
@@ -79,6 +82,9 @@ pub const compile = @import("codegen/compiler.zig").compile;
 pub const compileSimple = @import("codegen/compiler.zig").compileSimple;
 pub const CompileOptions = @import("codegen/compiler.zig").CompileOptions;
 pub const CompileResult = @import("codegen/compiler.zig").CompileResult;
+pub const SourceSpan = @import("codegen/compiler.zig").SourceSpan;
+pub const compileGlob = @import("codegen/glob.zig").compileGlob;
+pub const GlobOptions = @import("codegen/glob.zig").GlobOptions;
 
 // Executor module exports
 pub const Thread = @import("executor/thread.zig").Thread;
@@ -88,12 +94,28 @@ pub const VM = @import("executor/vm.zig").VM;
 pub const ExecResult = @import("executor/vm.zig").ExecResult;
 pub const Matcher = @import("executor/matcher.zig").Matcher;
 pub const MatchResult = @import("executor/matcher.zig").MatchResult;
+pub const ExecStats = @import("executor/exec_stats.zig").ExecStats;
+pub const Profile = @import("executor/profile.zig").Profile;
+pub const BranchOrder = @import("executor/branch_order.zig").BranchOrder;
 
 // High-level Regex API
 pub const Regex = @import("regex.zig").Regex;
 pub const test_ = @import("regex.zig").test_;
 pub const find = @import("regex.zig").find;
 pub const findAll = @import("regex.zig").findAll;
+pub const RegexSet = @import("regex_set.zig").RegexSet;
+pub const RuleTable = @import("rule_table.zig").RuleTable;
+pub const ShardedSet = @import("sharded_set.zig").ShardedSet;
+pub const ShardOptions = @import("sharded_set.zig").ShardOptions;
+pub const Registry = @import("registry.zig").Registry;
+pub const registry = @import("registry.zig");
+pub const slow_log = @import("slow_log.zig");
+pub const metrics = @import("metrics.zig");
+pub const tiering = @import("tiering.zig");
+pub const ResultCache = @import("result_cache.zig").ResultCache;
+pub const CacheConfig = @import("result_cache.zig").CacheConfig;
+pub const comptimeRegex = @import("comptime_regex.zig").comptimeRegex;
+pub const ComptimeRegex = @import("comptime_regex.zig").ComptimeRegex;
 
 // Placeholder for development
 pub fn placeholder() void {
@@ -125,6 +147,16 @@ test {
 
     // Regex API tests (implemented)
     _ = @import("regex.zig");
+    _ = @import("regex_set.zig");
+    _ = @import("rule_table.zig");
+    _ = @import("sharded_set.zig");
+    _ = @import("registry.zig");
+    _ = @import("slow_log.zig");
+    _ = @import("metrics.zig");
+    _ = @import("probe.zig");
+    _ = @import("tiering.zig");
+    _ = @import("result_cache.zig");
+    _ = @import("comptime_regex.zig");
 
     // To be implemented:
     // _ = @import("unicode/unicode_tests.zig");
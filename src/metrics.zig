@@ -0,0 +1,373 @@
+//! Per-regex metrics
+//!
+//! Opt-in counters (calls, matches, errors by kind, bytes scanned) and a
+//! latency histogram for a single Regex. Updates are relaxed atomic adds, so
+//! a Regex stays shareable between threads.
+//!
+//! The histogram is log-linear (HDR style): values below 8 ns get one bucket
+//! each, and every power-of-two range above that is split into 8 equal
+//! buckets. That bounds the relative error of any recorded value to 12.5%
+//! while covering 1 ns .. ~18 minutes in a few hundred counters. Buckets are
+//! closed at the top, so the power-of-two `le` bounds count `<=` exactly.
+//! LogHistogram takes the sub-bucket bits as a parameter for callers that need
+//! finer buckets, such as the latency benchmark.
+//!
+//! Every Metrics registers itself in a Registry; Registry.render() writes all
+//! of them in the Prometheus text exposition format, labelled by name.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+/// Sub-buckets per power of two (as a bit count) of the latency histogram
+const SUB_BITS = 3;
+
+/// Largest tracked exponent; slower values land in the last bucket
+const MAX_EXPONENT = 40;
+
+/// Latency histogram of a Metrics, in nanoseconds (12.5% error)
+pub const Histogram = LogHistogram(SUB_BITS, MAX_EXPONENT);
+
+/// Number of latency histogram buckets
+pub const BUCKET_COUNT = Histogram.bucket_count;
+
+/// Classification of a failed call
+pub const ErrorKind = enum {
+    step_limit,
+    recursion_limit,
+    scratch_limit,
+    out_of_memory,
+    other,
+
+    /// Map a matching error to its kind
+    pub fn fromError(err: anyerror) ErrorKind {
+        return switch (err) {
+            error.StepLimitExceeded => .step_limit,
+            error.RecursionLimitExceeded => .recursion_limit,
+            error.ScratchLimitExceeded => .scratch_limit,
+            error.OutOfMemory => .out_of_memory,
+            else => .other,
+        };
+    }
+};
+
+/// Outcome of one matching call
+pub const Outcome = union(enum) {
+    matched,
+    no_match,
+    failed: ErrorKind,
+};
+
+/// Log-linear histogram: values below 2^sub_bits get one bucket each, and
+/// every power-of-two range above is split into 2^sub_bits buckets, so a
+/// value is off by at most 2^-sub_bits of itself. Values of 2^(max_exponent + 1)
+/// and up share the last bucket.
+pub fn LogHistogram(comptime sub_bits: comptime_int, comptime max_exponent: comptime_int) type {
+    return struct {
+        buckets: [bucket_count]u64 = [_]u64{0} ** bucket_count,
+        sum: u64 = 0,
+
+        const Self = @This();
+        const sub_count = 1 << sub_bits;
+
+        /// Number of buckets
+        pub const bucket_count = (max_exponent - sub_bits + 2) * sub_count;
+
+        /// Bucket holding `value`
+        pub fn bucketIndex(value: u64) usize {
+            if (value < sub_count) return @intCast(value);
+
+            const msb: usize = 63 - @clz(value);
+            const shift = msb - sub_bits;
+            const sub: usize = @intCast((value >> @intCast(shift)) & (sub_count - 1));
+            return @min((shift + 1) * sub_count + sub, bucket_count - 1);
+        }
+
+        /// Smallest value that lands in bucket `index`
+        pub fn bucketLowerBound(index: usize) u64 {
+            if (index < sub_count) return index;
+
+            const shift: u6 = @intCast(index / sub_count - 1);
+            const sub: u64 = index % sub_count;
+            return (sub_count + sub) << shift;
+        }
+
+        /// Record one value
+        /// Values are filed by value - 1, so a bucket holds (lower bound, next lower
+        /// bound]: closed at the top, like a Prometheus `le` bucket.
+        pub fn record(self: *Self, value: u64) void {
+            _ = @atomicRmw(u64, &self.buckets[bucketIndex(value -| 1)], .Add, 1, .monotonic);
+            _ = @atomicRmw(u64, &self.sum, .Add, value, .monotonic);
+        }
+
+        /// Number of recorded values
+        pub fn count(self: *const Self) u64 {
+            var total: u64 = 0;
+            for (&self.buckets) |*bucket| total += @atomicLoad(u64, bucket, .monotonic);
+            return total;
+        }
+
+        /// Number of recorded values at or below `bound`, exact when bound is a power of two
+        pub fn countAtMost(self: *const Self, bound: u64) u64 {
+            var total: u64 = 0;
+            for (&self.buckets, 0..) |*bucket, i| {
+                if (bucketLowerBound(i) >= bound) break;
+                total += @atomicLoad(u64, bucket, .monotonic);
+            }
+            return total;
+        }
+
+        /// Approximate value at quantile `q` (0.0 .. 1.0), as the smallest value of its bucket
+        pub fn percentile(self: *const Self, q: f64) u64 {
+            const total = self.count();
+            if (total == 0) return 0;
+
+            const rank: u64 = @intFromFloat(@ceil(@as(f64, @floatFromInt(total)) * std.math.clamp(q, 0.0, 1.0)));
+            var seen: u64 = 0;
+            for (&self.buckets, 0..) |*bucket, i| {
+                seen += @atomicLoad(u64, bucket, .monotonic);
+                if (seen >= @max(rank, 1)) return bucketLowerBound(i) + 1;
+            }
+            return bucketLowerBound(bucket_count - 1) + 1;
+        }
+    };
+}
+
+/// Counters and latency histogram for one regex
+pub const Metrics = struct {
+    allocator: Allocator,
+
+    /// Label used in rendered output (owned)
+    name: []u8,
+
+    calls: u64 = 0,
+    matches: u64 = 0,
+    errors: [std.meta.fields(ErrorKind).len]u64 = [_]u64{0} ** std.meta.fields(ErrorKind).len,
+    bytes_scanned: u64 = 0,
+    latency: Histogram = .{},
+
+    /// Registry links (guarded by the registry lock)
+    prev: ?*Metrics = null,
+    next: ?*Metrics = null,
+
+    const Self = @This();
+
+    /// Allocate metrics labelled `name`
+    pub fn create(allocator: Allocator, name: []const u8) Allocator.Error!*Self {
+        const self = try allocator.create(Self);
+        errdefer allocator.destroy(self);
+        self.* = .{
+            .allocator = allocator,
+            .name = try allocator.dupe(u8, name),
+        };
+        return self;
+    }
+
+    /// Free metrics (must already be unregistered)
+    pub fn destroy(self: *Self) void {
+        self.allocator.free(self.name);
+        self.allocator.destroy(self);
+    }
+
+    /// Account for one call
+    pub fn record(self: *Self, outcome: Outcome, duration_ns: u64, bytes_scanned: u64) void {
+        _ = @atomicRmw(u64, &self.calls, .Add, 1, .monotonic);
+        _ = @atomicRmw(u64, &self.bytes_scanned, .Add, bytes_scanned, .monotonic);
+        switch (outcome) {
+            .matched => _ = @atomicRmw(u64, &self.matches, .Add, 1, .monotonic),
+            .no_match => {},
+            .failed => |kind| _ = @atomicRmw(u64, &self.errors[@intFromEnum(kind)], .Add, 1, .monotonic),
+        }
+        self.latency.record(duration_ns);
+    }
+
+    /// Calls that failed with `kind`
+    pub fn errorCount(self: *const Self, kind: ErrorKind) u64 {
+        return @atomicLoad(u64, &self.errors[@intFromEnum(kind)], .monotonic);
+    }
+};
+
+/// Set of live Metrics, rendered together
+pub const Registry = struct {
+    lock: std.Thread.Mutex = .{},
+    head: ?*Metrics = null,
+
+    const Self = @This();
+
+    /// Histogram `le` boundaries: powers of two from 256 ns to ~68.7 s
+    const LE_MIN_EXPONENT = 8;
+    const LE_MAX_EXPONENT = 36;
+
+    /// Add metrics to the registry
+    pub fn register(self: *Self, metrics: *Metrics) void {
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        metrics.prev = null;
+        metrics.next = self.head;
+        if (self.head) |head| head.prev = metrics;
+        self.head = metrics;
+    }
+
+    /// Remove metrics from the registry
+    pub fn unregister(self: *Self, metrics: *Metrics) void {
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        if (metrics.prev) |prev| prev.next = metrics.next else self.head = metrics.next;
+        if (metrics.next) |next| next.prev = metrics.prev;
+        metrics.prev = null;
+        metrics.next = null;
+    }
+
+    /// Write every registered Metrics in Prometheus text format
+    pub fn render(self: *Self, writer: anytype) !void {
+        self.lock.lock();
+        defer self.lock.unlock();
+
+        try self.renderCounter(writer, "zregexp_calls_total", "Matching calls per regex.", "calls");
+        try self.renderCounter(writer, "zregexp_matches_total", "Matching calls that found a match.", "matches");
+        try self.renderCounter(writer, "zregexp_bytes_scanned_total", "Input bytes examined.", "bytes_scanned");
+
+        try writer.writeAll("# HELP zregexp_errors_total Matching calls that failed, by error kind.\n");
+        try writer.writeAll("# TYPE zregexp_errors_total counter\n");
+        var it = self.head;
+        while (it) |m| : (it = m.next) {
+            inline for (std.meta.fields(ErrorKind)) |field| {
+                try writer.writeAll("zregexp_errors_total{regex=\"");
+                try writeLabelValue(writer, m.name);
+                try writer.print("\",kind=\"{s}\"}} {d}\n", .{ field.name, m.errorCount(@enumFromInt(field.value)) });
+            }
+        }
+
+        try writer.writeAll("# HELP zregexp_latency_seconds Matching call latency.\n");
+        try writer.writeAll("# TYPE zregexp_latency_seconds histogram\n");
+        it = self.head;
+        while (it) |m| : (it = m.next) {
+            for (LE_MIN_EXPONENT..LE_MAX_EXPONENT + 1) |exponent| {
+                const bound_ns = @as(u64, 1) << @intCast(exponent);
+                try writer.writeAll("zregexp_latency_seconds_bucket{regex=\"");
+                try writeLabelValue(writer, m.name);
+                try writer.print("\",le=\"{e}\"}} {d}\n", .{ nsToSeconds(bound_ns), m.latency.countAtMost(bound_ns) });
+            }
+
+            const total = m.latency.count();
+            try writer.writeAll("zregexp_latency_seconds_bucket{regex=\"");
+            try writeLabelValue(writer, m.name);
+            try writer.print("\",le=\"+Inf\"}} {d}\n", .{total});
+
+            try writer.writeAll("zregexp_latency_seconds_sum{regex=\"");
+            try writeLabelValue(writer, m.name);
+            try writer.print("\"}} {e}\n", .{nsToSeconds(@atomicLoad(u64, &m.latency.sum, .monotonic))});
+
+            try writer.writeAll("zregexp_latency_seconds_count{regex=\"");
+            try writeLabelValue(writer, m.name);
+            try writer.print("\"}} {d}\n", .{total});
+        }
+    }
+
+    fn renderCounter(self: *Self, writer: anytype, comptime metric: []const u8, comptime help: []const u8, comptime field: []const u8) !void {
+        try writer.writeAll("# HELP " ++ metric ++ " " ++ help ++ "\n");
+        try writer.writeAll("# TYPE " ++ metric ++ " counter\n");
+        var it = self.head;
+        while (it) |m| : (it = m.next) {
+            try writer.writeAll(metric ++ "{regex=\"");
+            try writeLabelValue(writer, m.name);
+            try writer.print("\"}} {d}\n", .{@atomicLoad(u64, &@field(m, field), .monotonic)});
+        }
+    }
+};
+
+/// Registry of every Regex with metrics enabled
+pub var global: Registry = .{};
+
+fn nsToSeconds(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / std.time.ns_per_s;
+}
+
+/// Escape a label value per the exposition format (backslash, quote, newline)
+fn writeLabelValue(writer: anytype, value: []const u8) !void {
+    for (value) |c| {
+        switch (c) {
+            '\\' => try writer.writeAll("\\\\"),
+            '"' => try writer.writeAll("\\\""),
+            '\n' => try writer.writeAll("\\n"),
+            else => try writer.writeByte(c),
+        }
+    }
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "Histogram: bucket boundaries" {
+    try std.testing.expectEqual(@as(usize, 0), Histogram.bucketIndex(0));
+    try std.testing.expectEqual(@as(usize, 7), Histogram.bucketIndex(7));
+    try std.testing.expectEqual(@as(usize, 8), Histogram.bucketIndex(8));
+    try std.testing.expectEqual(@as(usize, 15), Histogram.bucketIndex(15));
+    try std.testing.expectEqual(@as(usize, 16), Histogram.bucketIndex(16));
+    try std.testing.expectEqual(@as(usize, 16), Histogram.bucketIndex(17));
+    try std.testing.expectEqual(BUCKET_COUNT - 1, Histogram.bucketIndex(std.math.maxInt(u64)));
+
+    // Lower bounds round-trip for every bucket
+    for (0..BUCKET_COUNT) |i| {
+        try std.testing.expectEqual(i, Histogram.bucketIndex(Histogram.bucketLowerBound(i)));
+    }
+}
+
+test "Histogram: percentile within bucket error" {
+    var hist = Histogram{};
+    for (1..1001) |v| hist.record(v * 1000);
+
+    try std.testing.expectEqual(@as(u64, 1000), hist.count());
+    const p50 = hist.percentile(0.5);
+    try std.testing.expect(p50 >= 500_000 * 7 / 8 and p50 <= 500_000);
+    try std.testing.expectEqual(@as(u64, 1000), hist.countAtMost(1 << 30));
+}
+
+test "Histogram: le bounds include values on the edge" {
+    var hist = Histogram{};
+    hist.record(255);
+    hist.record(256);
+    hist.record(257);
+
+    try std.testing.expectEqual(@as(u64, 2), hist.countAtMost(256));
+    try std.testing.expectEqual(@as(u64, 0), hist.countAtMost(128));
+    try std.testing.expectEqual(@as(u64, 3), hist.countAtMost(512));
+}
+
+test "LogHistogram: finer sub-buckets narrow the error" {
+    const Fine = LogHistogram(7, 40);
+    var hist = Fine{};
+    for (1..1001) |v| hist.record(v * 1000);
+
+    const p50 = hist.percentile(0.5);
+    try std.testing.expect(p50 >= 500_000 * 127 / 128 and p50 <= 500_000);
+    try std.testing.expectEqual(@as(usize, 7), Fine.bucketIndex(7));
+    try std.testing.expectEqual(Fine.bucket_count - 1, Fine.bucketIndex(std.math.maxInt(u64)));
+}
+
+test "Registry: render Prometheus text" {
+    var registry = Registry{};
+    const m = try Metrics.create(std.testing.allocator, "login \"rule\"");
+    defer m.destroy();
+
+    registry.register(m);
+    defer registry.unregister(m);
+
+    m.record(.matched, 1500, 10);
+    m.record(.no_match, 300, 4);
+    m.record(.{ .failed = .step_limit }, 9000, 0);
+
+    var buf: std.ArrayListUnmanaged(u8) = .empty;
+    defer buf.deinit(std.testing.allocator);
+    try registry.render(buf.writer(std.testing.allocator));
+
+    const out = buf.items;
+    try std.testing.expect(std.mem.indexOf(u8, out, "zregexp_calls_total{regex=\"login \\\"rule\\\"\"} 3\n") != null);
+    try std.testing.expect(std.mem.indexOf(u8, out, "zregexp_matches_total{regex=\"login \\\"rule\\\"\"} 1\n") != null);
+    try std.testing.expect(std.mem.indexOf(u8, out, "kind=\"step_limit\"} 1\n") != null);
+    try std.testing.expect(std.mem.indexOf(u8, out, "zregexp_bytes_scanned_total{regex=\"login \\\"rule\\\"\"} 14\n") != null);
+    try std.testing.expect(std.mem.indexOf(u8, out, "le=\"+Inf\"} 3\n") != null);
+    try std.testing.expect(std.mem.indexOf(u8, out, "# TYPE zregexp_latency_seconds histogram\n") != null);
+}
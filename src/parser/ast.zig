@@ -80,6 +80,10 @@ pub const Node = struct {
     /// Whether this is an inverted/negated character class
     inverted: bool = false,
 
+    /// Pattern byte range this node was parsed from (empty if synthesized)
+    src_start: usize = 0,
+    src_end: usize = 0,
+
     const Self = @This();
 
     /// Create a character node
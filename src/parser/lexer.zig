@@ -72,6 +72,12 @@ pub const TokenType = enum {
     eof,
 };
 
+/// Bytes of the class escapes as inclusive ranges; the parser and
+/// comptimeRegex both build \d \w \s from these
+pub const digit_ranges = [_][2]u8{.{ '0', '9' }};
+pub const word_ranges = [_][2]u8{ .{ 'a', 'z' }, .{ 'A', 'Z' }, .{ '0', '9' }, .{ '_', '_' } };
+pub const space_ranges = [_][2]u8{ .{ ' ', ' ' }, .{ '\t', '\t' }, .{ '\n', '\n' }, .{ '\r', '\r' } };
+
 /// Token with type and associated data
 pub const Token = struct {
     type: TokenType,
@@ -112,8 +112,15 @@ pub const Parser = struct {
     // Grammar Rules (Top-Down by Precedence)
     // =========================================================================
 
+    /// Record the pattern bytes from `start` up to the current token as the node's span
+    fn setSpan(self: Self, node: *Node, start: usize) void {
+        node.src_start = start;
+        node.src_end = self.current_token.position;
+    }
+
     /// Parse alternation: sequence ('|' sequence)*
     fn parseAlternation(self: *Self) ParseError!*Node {
+        const start = self.current_token.position;
         var left = try self.parseSequence();
         errdefer left.deinit();
 
@@ -136,6 +143,7 @@ pub const Parser = struct {
                 alt = try Node.createAlternation(self.allocator, alt, next);
             }
 
+            self.setSpan(alt, start);
             return alt;
         }
 
@@ -144,6 +152,7 @@ pub const Parser = struct {
 
     /// Parse sequence: term*
     fn parseSequence(self: *Self) ParseError!*Node {
+        const start = self.current_token.position;
         var seq = try Node.createSequence(self.allocator);
         errdefer seq.deinit();
 
@@ -168,12 +177,23 @@ pub const Parser = struct {
         }
 
         // Empty sequence is valid (matches empty string)
+        self.setSpan(seq, start);
         return seq;
     }
 
     /// Parse term: atom quantifier?
     fn parseTerm(self: *Self) ParseError!*Node {
+        const start = self.current_token.position;
         const atom = try self.parseAtom();
+        self.setSpan(atom, start);
+
+        const term = try self.parseQuantifier(atom);
+        self.setSpan(term, start);
+        return term;
+    }
+
+    /// Parse an optional quantifier applying to `atom`
+    fn parseQuantifier(self: *Self, atom: *Node) ParseError!*Node {
         errdefer atom.deinit();
 
         // Check for quantifier (greedy)
@@ -249,63 +269,38 @@ pub const Parser = struct {
             .digit => {
                 try self.advance();
                 // \d is equivalent to [0-9]
-                return Node.createCharRange(self.allocator, '0', '9');
+                const digits = lexer_mod.digit_ranges[0];
+                return Node.createCharRange(self.allocator, digits[0], digits[1]);
             },
 
             .word => {
                 try self.advance();
-                // \w - for simplicity, create a char class node
-                // In full implementation, this would be [a-zA-Z0-9_]
-                const class = try Node.createCharClass(self.allocator);
-                try class.appendChild(try Node.createCharRange(self.allocator, 'a', 'z'));
-                try class.appendChild(try Node.createCharRange(self.allocator, 'A', 'Z'));
-                try class.appendChild(try Node.createCharRange(self.allocator, '0', '9'));
-                try class.appendChild(try Node.createChar(self.allocator, '_'));
-                return class;
+                return self.createEscapeClass(&lexer_mod.word_ranges, false);
             },
 
             .whitespace => {
                 try self.advance();
-                // \s is [ \t\n\r\f\v]
-                const class = try Node.createCharClass(self.allocator);
-                try class.appendChild(try Node.createChar(self.allocator, ' '));
-                try class.appendChild(try Node.createChar(self.allocator, '\t'));
-                try class.appendChild(try Node.createChar(self.allocator, '\n'));
-                try class.appendChild(try Node.createChar(self.allocator, '\r'));
-                return class;
+                return self.createEscapeClass(&lexer_mod.space_ranges, false);
             },
 
             // Negated character classes
             .not_digit => {
                 try self.advance();
                 // \D is equivalent to [^0-9]
-                const node = try Node.createCharRange(self.allocator, '0', '9');
+                const digits = lexer_mod.digit_ranges[0];
+                const node = try Node.createCharRange(self.allocator, digits[0], digits[1]);
                 node.inverted = true;
                 return node;
             },
 
             .not_word => {
                 try self.advance();
-                // \W is [^a-zA-Z0-9_]
-                const class = try Node.createCharClass(self.allocator);
-                class.inverted = true;
-                try class.appendChild(try Node.createCharRange(self.allocator, 'a', 'z'));
-                try class.appendChild(try Node.createCharRange(self.allocator, 'A', 'Z'));
-                try class.appendChild(try Node.createCharRange(self.allocator, '0', '9'));
-                try class.appendChild(try Node.createChar(self.allocator, '_'));
-                return class;
+                return self.createEscapeClass(&lexer_mod.word_ranges, true);
             },
 
             .not_whitespace => {
                 try self.advance();
-                // \S is [^ \t\n\r\f\v]
-                const class = try Node.createCharClass(self.allocator);
-                class.inverted = true;
-                try class.appendChild(try Node.createChar(self.allocator, ' '));
-                try class.appendChild(try Node.createChar(self.allocator, '\t'));
-                try class.appendChild(try Node.createChar(self.allocator, '\n'));
-                try class.appendChild(try Node.createChar(self.allocator, '\r'));
-                return class;
+                return self.createEscapeClass(&lexer_mod.space_ranges, true);
             },
 
             // Anchors
@@ -423,6 +418,23 @@ pub const Parser = struct {
         }
     }
 
+    /// Class node for \w \s (or \W \S when inverted) from the lexer's ranges
+    fn createEscapeClass(self: *Self, ranges: []const [2]u8, inverted: bool) ParseError!*Node {
+        const class = try Node.createCharClass(self.allocator);
+        errdefer class.deinit();
+        class.inverted = inverted;
+
+        for (ranges) |range| {
+            const item = if (range[0] == range[1])
+                try Node.createChar(self.allocator, range[0])
+            else
+                try Node.createCharRange(self.allocator, range[0], range[1]);
+            errdefer item.deinit();
+            try class.appendChild(item);
+        }
+        return class;
+    }
+
     /// Parse character class: '[' '^'? charclass_item+ ']'
     fn parseCharClass(self: *Self) ParseError!*Node {
         _ = try self.consume(.lbracket);
@@ -828,3 +840,28 @@ test "Parser: possessive question quantifier" {
     try std.testing.expectEqual(NodeType.possessive_question, root.type);
     try std.testing.expectEqual(@as(usize, 1), root.children.items.len);
 }
+
+test "Parser: source spans" {
+    const pattern = "ab(c|de)*";
+    var lexer = Lexer.init(pattern);
+    var parser = try Parser.init(std.testing.allocator, &lexer);
+
+    const root = try parser.parse();
+    defer root.deinit();
+
+    try std.testing.expectEqual(@as(usize, 0), root.src_start);
+    try std.testing.expectEqual(pattern.len, root.src_end);
+
+    const b = root.children.items[1];
+    try std.testing.expectEqual(@as(usize, 1), b.src_start);
+    try std.testing.expectEqual(@as(usize, 2), b.src_end);
+
+    // Quantified group covers "(c|de)*"; the alternation inside covers "c|de"
+    const star = root.children.items[2];
+    try std.testing.expectEqual(NodeType.star, star.type);
+    try std.testing.expectEqualStrings("(c|de)*", pattern[star.src_start..star.src_end]);
+
+    const alt = star.children.items[0].children.items[0];
+    try std.testing.expectEqual(NodeType.alternation, alt.type);
+    try std.testing.expectEqualStrings("c|de", pattern[alt.src_start..alt.src_end]);
+}
@@ -0,0 +1,136 @@
+//! Call observation for Regex
+//!
+//! A Probe wraps one matching call: it fires the search USDT probes and
+//! feeds the slow log and the regex's metrics. When neither of the latter is
+//! in use it only performs the enabled checks and never reads the clock.
+
+const std = @import("std");
+const exec_stats = @import("executor/exec_stats.zig");
+const slow_log = @import("slow_log.zig");
+const metrics_mod = @import("metrics.zig");
+const probes = @import("utils/probes.zig");
+
+const ExecStats = exec_stats.ExecStats;
+const SlowLog = slow_log.SlowLog;
+const Metrics = metrics_mod.Metrics;
+const Outcome = metrics_mod.Outcome;
+
+/// Times one call and reports it when it finishes
+///
+/// Keep the probe in a local variable and pass `probe.statsPtr()` to the
+/// matcher: when the caller supplied no ExecStats the probe counts in its own.
+pub const Probe = struct {
+    pattern_id: u64,
+    input: []const u8,
+    log: ?*SlowLog,
+    metrics: ?*Metrics,
+    caller_stats: ?*ExecStats,
+    local_stats: ExecStats = .{},
+    steps_before: u64 = 0,
+    bytes_before: u64 = 0,
+    start: ?std.time.Instant = null,
+
+    /// Result of the call, set by the caller before finish()
+    outcome: Outcome = .no_match,
+
+    /// Begin observing a call of pattern `pattern_id` over `input`
+    pub fn begin(log: *SlowLog, metrics: ?*Metrics, stats: ?*ExecStats, pattern_id: u64, input: []const u8) Probe {
+        probes.probe2("search__start", pattern_id, input.len);
+
+        const active_log: ?*SlowLog = if (log.isEnabled()) log else null;
+        if (active_log == null and metrics == null) {
+            return .{ .pattern_id = pattern_id, .input = input, .log = null, .metrics = null, .caller_stats = stats };
+        }
+
+        return .{
+            .pattern_id = pattern_id,
+            .input = input,
+            .log = active_log,
+            .metrics = metrics,
+            .caller_stats = stats,
+            .steps_before = if (stats) |s| s.steps else 0,
+            .bytes_before = if (stats) |s| s.bytes_scanned else 0,
+            .start = std.time.Instant.now() catch null,
+        };
+    }
+
+    /// Whether the call is being observed
+    pub fn isActive(self: *const Probe) bool {
+        return self.log != null or self.metrics != null;
+    }
+
+    /// Stats the call should fill in
+    pub fn statsPtr(self: *Probe) ?*ExecStats {
+        if (self.caller_stats) |s| return s;
+        return if (self.isActive()) &self.local_stats else null;
+    }
+
+    /// Record a failed call (use from errdefer)
+    pub fn fail(self: *Probe, err: anyerror) void {
+        self.outcome = .{ .failed = metrics_mod.ErrorKind.fromError(err) };
+    }
+
+    /// Finish observing and report to the slow log and metrics
+    pub fn finish(self: *Probe) void {
+        const outcome_code: u64 = switch (self.outcome) {
+            .no_match => 0,
+            .matched => 1,
+            .failed => 2,
+        };
+        probes.probe3("search__done", self.pattern_id, self.input.len, outcome_code);
+
+        if (!self.isActive()) return;
+
+        const stats = self.statsPtr().?;
+        const steps = stats.steps - self.steps_before;
+        const duration_ns: u64 = if (self.start) |start|
+            if (std.time.Instant.now()) |now| now.since(start) else |_| 0
+        else
+            0;
+
+        if (self.log) |log| {
+            if (log.isSlow(steps, duration_ns)) {
+                log.record(self.pattern_id, self.input, steps, duration_ns, stats.engine);
+            }
+        }
+
+        if (self.metrics) |m| {
+            m.record(self.outcome, duration_ns, stats.bytes_scanned - self.bytes_before);
+        }
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "Probe: inactive without log or metrics" {
+    const log = try std.testing.allocator.create(SlowLog);
+    defer std.testing.allocator.destroy(log);
+    log.* = SlowLog.init();
+
+    var probe = Probe.begin(log, null, null, 1, "input");
+    try std.testing.expectEqual(@as(?*ExecStats, null), probe.statsPtr());
+    probe.finish();
+
+    var out: [1]slow_log.SlowEntry = undefined;
+    try std.testing.expectEqual(@as(usize, 0), log.drain(&out));
+}
+
+test "Probe: feeds metrics" {
+    const log = try std.testing.allocator.create(SlowLog);
+    defer std.testing.allocator.destroy(log);
+    log.* = SlowLog.init();
+
+    const m = try Metrics.create(std.testing.allocator, "rule");
+    defer m.destroy();
+
+    var probe = Probe.begin(log, m, null, 1, "input");
+    probe.statsPtr().?.bytes_scanned += 5;
+    probe.fail(error.StepLimitExceeded);
+    probe.finish();
+
+    try std.testing.expectEqual(@as(u64, 1), m.calls);
+    try std.testing.expectEqual(@as(u64, 5), m.bytes_scanned);
+    try std.testing.expectEqual(@as(u64, 1), m.errorCount(.step_limit));
+}
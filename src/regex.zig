@@ -32,11 +32,36 @@ const matcher_mod = @import("executor/matcher.zig");
 const parser_mod = @import("parser/parser.zig");
 const generator_mod = @import("codegen/generator.zig");
 const format_mod = @import("bytecode/format.zig");
+const glob_mod = @import("codegen/glob.zig");
+const exec_stats = @import("executor/exec_stats.zig");
+const profile_mod = @import("executor/profile.zig");
+const branch_order_mod = @import("executor/branch_order.zig");
+const slow_log = @import("slow_log.zig");
+const metrics_mod = @import("metrics.zig");
+const probe_mod = @import("probe.zig");
+const probes = @import("utils/probes.zig");
+const dispatch = @import("utils/dispatch.zig");
+const recursive_mod = @import("executor/recursive_matcher.zig");
+const tiering = @import("tiering.zig");
+const result_cache = @import("result_cache.zig");
 
 const CompileResult = compiler.CompileResult;
 const CompileOptions = compiler.CompileOptions;
+pub const GlobOptions = glob_mod.GlobOptions;
 const Matcher = matcher_mod.Matcher;
 pub const MatchResult = matcher_mod.MatchResult;
+pub const ExecStats = exec_stats.ExecStats;
+pub const ExecOptions = recursive_mod.ExecOptions;
+pub const Profile = profile_mod.Profile;
+pub const BranchOrder = branch_order_mod.BranchOrder;
+pub const BranchProfileError = branch_order_mod.BranchProfileError;
+pub const Metrics = metrics_mod.Metrics;
+pub const Tier = tiering.Tier;
+const TierState = tiering.TierState;
+const ResultCache = result_cache.ResultCache;
+pub const CacheConfig = result_cache.CacheConfig;
+pub const CacheStats = result_cache.CacheStats;
+const Probe = probe_mod.Probe;
 
 /// Error set for regex operations (includes all possible compilation and execution errors)
 pub const RegexError = parser_mod.ParseError || generator_mod.CodegenError || Allocator.Error || error{
@@ -46,6 +71,61 @@ pub const RegexError = parser_mod.ParseError || generator_mod.CodegenError || Al
     BufferTooSmall,
     RecursionLimitExceeded,
     StepLimitExceeded,
+    ScratchLimitExceeded,
+};
+
+/// Source of Regex.id values
+var next_id = std.atomic.Value(u64).init(1);
+
+fn nextId() u64 {
+    return next_id.fetchAdd(1, .monotonic);
+}
+
+/// Program bytes held by all live regexes
+var live_program_bytes = std.atomic.Value(usize).init(0);
+
+/// Bytecode, prefilter and source-map bytes of every live Regex in the process
+/// (process-wide; Regex.memoryUsage reports one regex)
+pub fn processProgramBytes() usize {
+    return live_program_bytes.load(.monotonic);
+}
+
+/// Result-cache bytes of every live Regex and RegexSet in the process
+/// (process-wide; Regex.memoryUsage reports one regex)
+pub fn processCacheBytes() usize {
+    return result_cache.liveBytes();
+}
+
+/// Heap bytes owned by a Regex, by purpose
+pub const MemoryUsage = struct {
+    /// Bytecode, prefilter literal and source map
+    program_bytes: usize = 0,
+
+    /// Profile counters and branch order
+    profile_bytes: usize = 0,
+
+    /// Metrics counters and histogram
+    metrics_bytes: usize = 0,
+
+    /// Result cache (see enableCache)
+    cache_bytes: usize = 0,
+
+    /// Tiering counters and promoted artifacts (pre-decoded program)
+    tier_bytes: usize = 0,
+
+    /// Sum of all categories
+    pub fn total(self: MemoryUsage) usize {
+        return self.program_bytes + self.profile_bytes + self.metrics_bytes + self.cache_bytes + self.tier_bytes;
+    }
+};
+
+/// What Regex.prepare builds ahead of the first search
+pub const PrepareOptions = struct {
+    /// Build the pre-decoded program now rather than when the regex gets hot
+    decode: bool = true,
+
+    /// Detect the CPU and select the SIMD scan kernels
+    kernels: bool = true,
 };
 
 /// Main Regex type - represents a compiled regular expression
@@ -54,37 +134,264 @@ pub const Regex = struct {
     compiled: CompileResult,
     pattern: []const u8,
 
+    /// Per-instruction counters (owned), present when compiled with `.profile`
+    profile: ?*Profile = null,
+
+    /// Process-unique id reported in slow-log entries
+    id: u64 = 0,
+
+    /// Call counters and latency histogram (owned), see enableMetrics
+    metrics: ?*Metrics = null,
+
+    /// Step, recursion and stack limits applied to every search
+    exec_options: ExecOptions = .{},
+
+    /// Hotness counters and promoted tiers (owned), see tiering.zig
+    tier: ?*TierState = null,
+
+    /// Alternations isMatch tries second branch first (owned), see reorderBranches
+    branch_order: ?*BranchOrder = null,
+
+    /// Results of recent isMatch/find calls on short inputs (owned), see enableCache
+    cache: ?*ResultCache = null,
+
     const Self = @This();
 
     /// Compile a regex pattern
     pub fn compile(allocator: Allocator, pattern: []const u8) RegexError!Self {
         const compiled = try compiler.compileSimple(allocator, pattern);
-        return .{
-            .allocator = allocator,
-            .compiled = compiled,
-            .pattern = pattern,
-        };
+        errdefer compiled.deinit();
+        return try fromCompiled(allocator, compiled, pattern);
     }
 
     /// Compile with custom options
     pub fn compileWithOptions(allocator: Allocator, pattern: []const u8, options: CompileOptions) RegexError!Self {
         const compiled = try compiler.compile(allocator, pattern, options);
+        errdefer compiled.deinit();
+
+        var profile: ?*Profile = null;
+        if (options.profile) {
+            const p = try allocator.create(Profile);
+            errdefer allocator.destroy(p);
+            p.* = try Profile.init(allocator, compiled.bytecode.len);
+            profile = p;
+        }
+
+        var re = try fromCompiled(allocator, compiled, pattern);
+        re.profile = profile;
+        return re;
+    }
+
+    /// Compile a shell-style glob pattern (`*.log`, `src/**/*.zig`)
+    pub fn compileGlob(allocator: Allocator, pattern: []const u8, options: GlobOptions) RegexError!Self {
+        const compiled = try glob_mod.compileGlob(allocator, pattern, options);
+        errdefer compiled.deinit();
+        return try fromCompiled(allocator, compiled, pattern);
+    }
+
+    /// Wrap a program owned elsewhere (see registry.zig); `bytecode`,
+    /// `prefilter` and `pattern` must outlive the Regex
+    pub fn fromProgram(allocator: Allocator, bytecode: []const u8, prefilter: ?[]const u8, pattern: []const u8) Allocator.Error!Self {
+        return fromCompiled(allocator, .{
+            .bytecode = bytecode,
+            .allocator = allocator,
+            .prefilter = prefilter,
+            .borrowed = true,
+        }, pattern);
+    }
+
+    /// Wrap a compiled program, assigning an id and counting its bytes
+    fn fromCompiled(allocator: Allocator, compiled: CompileResult, pattern: []const u8) Allocator.Error!Self {
+        // Regexes compiled with tiering off never count their uses
+        const tier: ?*TierState = if (tiering.policy.isEnabled()) try TierState.create(allocator) else null;
+        _ = live_program_bytes.fetchAdd(compiled.memoryUsage(), .monotonic);
         return .{
             .allocator = allocator,
             .compiled = compiled,
             .pattern = pattern,
+            .id = nextId(),
+            .tier = tier,
         };
     }
 
     /// Free resources
     pub fn deinit(self: Self) void {
+        // A promotion thread may still be reading the bytecode
+        if (self.tier) |tier| tier.destroy();
+        _ = live_program_bytes.fetchSub(self.compiled.memoryUsage(), .monotonic);
         self.compiled.deinit();
+        if (self.profile) |profile| {
+            profile.deinit();
+            self.allocator.destroy(profile);
+        }
+        if (self.metrics) |m| {
+            metrics_mod.global.unregister(m);
+            m.destroy();
+        }
+        if (self.branch_order) |order| {
+            order.deinit();
+            self.allocator.destroy(order);
+        }
+        if (self.cache) |cache| cache.destroy();
+    }
+
+    /// Start collecting metrics under `name` and register them for rendering
+    /// Call before sharing the regex between threads; a second call only renames.
+    pub fn enableMetrics(self: *Self, name: []const u8) Allocator.Error!void {
+        if (self.metrics) |m| {
+            const new_name = try m.allocator.dupe(u8, name);
+            metrics_mod.global.unregister(m);
+            m.allocator.free(m.name);
+            m.name = new_name;
+            metrics_mod.global.register(m);
+            return;
+        }
+
+        const m = try Metrics.create(self.allocator, name);
+        metrics_mod.global.register(m);
+        self.metrics = m;
+    }
+
+    /// Cache isMatch and find results for repeated short inputs
+    /// Call before sharing the regex between threads; a second call replaces the cache.
+    pub fn enableCache(self: *Self, config: CacheConfig) Allocator.Error!void {
+        const cache = try ResultCache.create(self.allocator, config);
+        if (self.cache) |old| old.destroy();
+        self.cache = cache;
+    }
+
+    /// Hit and miss counters of the result cache, if enabled
+    pub fn cacheStats(self: Self) ?CacheStats {
+        const cache = self.cache orelse return null;
+        return cache.stats();
+    }
+
+    /// Heap bytes owned by this regex (excluding the Regex value itself)
+    pub fn memoryUsage(self: Self) MemoryUsage {
+        return .{
+            .program_bytes = self.compiled.memoryUsage(),
+            .profile_bytes = (if (self.profile) |profile| profile.memoryUsage() else 0) +
+                (if (self.branch_order) |order| order.memoryUsage() else 0),
+            .metrics_bytes = if (self.metrics) |m| @sizeOf(Metrics) + m.name.len else 0,
+            .tier_bytes = if (self.tier) |tier| tier.memoryUsage() else 0,
+            .cache_bytes = if (self.cache) |cache| cache.memoryUsage() else 0,
+        };
+    }
+
+    /// Build now what the first searches would otherwise set up lazily, so
+    /// startup pays for it rather than the first requests. Safe to call from
+    /// several threads at once, on the same or different regexes; call it
+    /// before copying the Regex to threads that search, since a regex
+    /// compiled with tiering off gets its tier state here.
+    pub fn prepare(self: *Self, options: PrepareOptions) RegexError!void {
+        if (options.kernels) _ = dispatch.activeLevel();
+        if (options.decode) {
+            const tier = @atomicLoad(?*TierState, &self.tier, .acquire) orelse try self.installTier();
+            try tier.promoteNow(self.compiled.bytecode);
+        }
+    }
+
+    /// Give the regex a tier state; concurrent callers agree on one
+    fn installTier(self: *Self) Allocator.Error!*TierState {
+        const tier = try TierState.create(self.allocator);
+        if (@cmpxchgStrong(?*TierState, &self.tier, null, tier, .acq_rel, .acquire)) |installed| {
+            tier.destroy();
+            return installed.?;
+        }
+        return tier;
+    }
+
+    /// Execution tier searches currently run in
+    pub fn currentTier(self: Self) Tier {
+        const tier = self.tier orelse return .interpreted;
+        return tier.tier();
+    }
+
+    /// Write the disassembly annotated with profile counters and pattern spans
+    pub fn dumpProfile(self: Self, writer: anytype) !void {
+        const profile = self.profile orelse return error.ProfilingDisabled;
+        try profile.dump(self.compiled, self.pattern, writer);
+    }
+
+    /// Clear the profile counters (no-op when not profiling)
+    pub fn resetProfile(self: Self) void {
+        if (self.profile) |profile| profile.reset();
+    }
+
+    /// Write the alternation branch counters in the format importBranchProfile reads
+    pub fn exportBranchProfile(self: Self, writer: anytype) !void {
+        const profile = self.profile orelse return error.ProfilingDisabled;
+        try branch_order_mod.writeProfile(self.compiled.bytecode, profile, writer);
+    }
+
+    /// Make isMatch try the branch of each alternation that has matched most
+    /// often first, according to this regex's profile.
+    /// Call before sharing the regex between threads.
+    pub fn reorderBranches(self: *Self) error{ ProfilingDisabled, OutOfMemory }!void {
+        const profile = self.profile orelse return error.ProfilingDisabled;
+        const order = try BranchOrder.fromProfile(self.allocator, self.compiled.bytecode, profile);
+        try self.setBranchOrder(order);
+    }
+
+    /// reorderBranches using counters exported from a regex compiled from the
+    /// same pattern with the same options (this regex need not be profiled).
+    /// Call before sharing the regex between threads.
+    pub fn importBranchProfile(self: *Self, text: []const u8) BranchProfileError!void {
+        const order = try BranchOrder.parse(self.allocator, self.compiled.bytecode, text);
+        try self.setBranchOrder(order);
+    }
+
+    fn setBranchOrder(self: *Self, order: BranchOrder) Allocator.Error!void {
+        if (self.branch_order) |current| {
+            current.deinit();
+            current.* = order;
+            return;
+        }
+
+        errdefer order.deinit();
+        const slot = try self.allocator.create(BranchOrder);
+        slot.* = order;
+        self.branch_order = slot;
+    }
+
+    /// Quick reject: input cannot match if it lacks the required literal
+    fn rejectedByPrefilter(self: Self, input: []const u8, stats: ?*ExecStats) bool {
+        const literal = self.compiled.prefilter orelse return false;
+        const found = dispatch.indexOf(input, literal);
+
+        if (found) |index| {
+            probes.probe2("prefilter__candidate", self.id, index);
+            if (stats) |s| {
+                s.prefilter_candidates += 1;
+                s.bytes_scanned += index + literal.len;
+            }
+        } else {
+            probes.probe2("prefilter__reject", self.id, input.len);
+            if (stats) |s| {
+                s.prefilter_skips += 1;
+                s.bytes_scanned += input.len;
+            }
+        }
+
+        return found == null;
     }
 
     /// Test if pattern matches entire input
     pub fn matchFull(self: Self, input: []const u8) RegexError!bool {
-        const m = Matcher.init(self.allocator, self.compiled.bytecode);
-        return try m.matchFull(input);
+        return self.matchFullWithStats(input, null);
+    }
+
+    /// matchFull, adding work counters to `stats` when given
+    pub fn matchFullWithStats(self: Self, input: []const u8, stats: ?*ExecStats) RegexError!bool {
+        var probe = Probe.begin(&slow_log.global, self.metrics, stats, self.id, input);
+        defer probe.finish();
+        errdefer |err| probe.fail(err);
+
+        if (self.rejectedByPrefilter(input, probe.statsPtr())) return false;
+        const m = self.matcher(input);
+        const matched = try m.matchFullWithStats(input, probe.statsPtr());
+        if (matched) probe.outcome = .matched;
+        return matched;
     }
 
     /// Alias for matchFull (common in other regex libraries)
@@ -92,16 +399,95 @@ pub const Regex = struct {
         return self.matchFull(input);
     }
 
+    /// Test if pattern matches anywhere in input
+    pub fn isMatch(self: Self, input: []const u8) RegexError!bool {
+        return self.isMatchWithStats(input, null);
+    }
+
+    /// isMatch, adding work counters to `stats` when given
+    /// Only existence is reported, so the branch order (see reorderBranches) applies.
+    pub fn isMatchWithStats(self: Self, input: []const u8, stats: ?*ExecStats) RegexError!bool {
+        var probe = Probe.begin(&slow_log.global, self.metrics, stats, self.id, input);
+        defer probe.finish();
+        errdefer |err| probe.fail(err);
+
+        if (self.cache) |cache| {
+            if (cache.lookup(input)) |cached| {
+                if (probe.statsPtr()) |s| s.cache_hits += 1;
+                if (cached.matched) probe.outcome = .matched;
+                return cached.matched;
+            }
+        }
+
+        if (self.rejectedByPrefilter(input, probe.statsPtr())) return false;
+        var m = self.matcher(input);
+        if (self.branch_order) |order| m.branch_order = order.swapped;
+        const matched = try m.isMatchWithStats(input, probe.statsPtr());
+        if (matched) probe.outcome = .matched;
+        if (self.cache) |cache| cache.store(input, .{ .matched = matched });
+        return matched;
+    }
+
     /// Find first match in input
     pub fn find(self: Self, input: []const u8) RegexError!?MatchResult {
-        const m = Matcher.init(self.allocator, self.compiled.bytecode);
-        return try m.find(input);
+        return self.findWithStats(input, null);
+    }
+
+    /// find, adding work counters to `stats` when given
+    pub fn findWithStats(self: Self, input: []const u8, stats: ?*ExecStats) RegexError!?MatchResult {
+        var probe = Probe.begin(&slow_log.global, self.metrics, stats, self.id, input);
+        defer probe.finish();
+        errdefer |err| probe.fail(err);
+
+        // A cached start leaves one anchored attempt to rebuild the captures
+        var first_start: usize = 0;
+        if (self.cache) |cache| {
+            if (cache.lookup(input)) |cached| {
+                if (!cached.matched or cached.start != null) {
+                    if (probe.statsPtr()) |s| s.cache_hits += 1;
+                }
+                if (!cached.matched) return null;
+                first_start = cached.start orelse 0;
+            }
+        }
+
+        if (self.rejectedByPrefilter(input, probe.statsPtr())) return null;
+        const m = self.matcher(input);
+        const result = try m.findFromWithStats(input, first_start, probe.statsPtr());
+        if (result != null) probe.outcome = .matched;
+        if (self.cache) |cache| cache.store(input, .{
+            .matched = result != null,
+            .start = if (result) |r| r.start else null,
+        });
+        return result;
     }
 
     /// Find all matches in input
     pub fn findAll(self: Self, input: []const u8) RegexError!std.ArrayListUnmanaged(MatchResult) {
-        const m = Matcher.init(self.allocator, self.compiled.bytecode);
-        return try m.findAll(input);
+        var probe = Probe.begin(&slow_log.global, self.metrics, null, self.id, input);
+        defer probe.finish();
+        errdefer |err| probe.fail(err);
+
+        if (self.rejectedByPrefilter(input, probe.statsPtr())) return .empty;
+        const m = self.matcher(input);
+        const matches = try m.findAllWithStats(input, probe.statsPtr());
+        if (matches.items.len > 0) probe.outcome = .matched;
+        return matches;
+    }
+
+    /// Matcher for one search over `input`, in the regex's current tier
+    fn matcher(self: Self, input: []const u8) Matcher {
+        var m = Matcher.init(self.allocator, self.compiled.bytecode);
+        m.profile = self.profile;
+        m.exec_options = self.exec_options;
+        if (self.tier) |tier| {
+            tier.recordUse(&tiering.policy, self.compiled.bytecode, input.len);
+            m.decoded = tier.decodedProgram();
+        }
+
+        const engine: exec_stats.Engine = if (m.decoded != null) .backtrack_decoded else .backtrack;
+        probes.probe2("engine__select", self.id, @intFromEnum(engine));
+        return m;
     }
 
     /// Get the original pattern string
@@ -207,6 +593,41 @@ test "Regex: getPattern" {
     try std.testing.expectEqualStrings("test.*", re.getPattern());
 }
 
+test "Regex: compileGlob" {
+    var re = try Regex.compileGlob(std.testing.allocator, "src/**/*.zig", .{});
+    defer re.deinit();
+
+    try std.testing.expect(try re.matchFull("src/main.zig"));
+    try std.testing.expect(try re.matchFull("src/codegen/glob.zig"));
+    try std.testing.expect(!try re.matchFull("build.zig"));
+    try std.testing.expect(!try re.matchFull("src/main.c"));
+
+    const result = try re.find("docs/readme.md");
+    try std.testing.expect(result == null);
+}
+
+test "Regex: findWithStats" {
+    var re = try Regex.compile(std.testing.allocator, "wor.d");
+    defer re.deinit();
+
+    var stats = ExecStats{};
+    const result = try re.findWithStats("hello world", &stats);
+    try std.testing.expect(result != null);
+    defer result.?.deinit();
+
+    try std.testing.expectEqual(@as(u64, 1), stats.prefilter_candidates);
+    try std.testing.expectEqual(@as(u64, 7), stats.start_positions);
+    try std.testing.expect(stats.steps >= 7);
+    try std.testing.expectEqual(exec_stats.Engine.backtrack, stats.engine);
+
+    // Prefilter rejects inputs without "wor" before any matcher runs
+    stats.reset();
+    try std.testing.expect(try re.findWithStats("hello there", &stats) == null);
+    try std.testing.expectEqual(@as(u64, 1), stats.prefilter_skips);
+    try std.testing.expectEqual(@as(u64, 0), stats.start_positions);
+    try std.testing.expectEqual(exec_stats.Engine.none, stats.engine);
+}
+
 test "convenience: test_" {
     try std.testing.expect(try test_(std.testing.allocator, "abc", "abc"));
     try std.testing.expect(!try test_(std.testing.allocator, "abc", "xyz"));
@@ -1304,3 +1725,239 @@ test "Regex: lazy counted quantifiers {n,m}?" {
         }
     }
 }
+
+test "Regex: profile counts executions and backtracks" {
+    var re = try Regex.compileWithOptions(std.testing.allocator, "a|b", .{ .profile = true });
+    defer re.deinit();
+
+    const result = (try re.find("xb")).?;
+    result.deinit();
+
+    const profile = re.profile.?;
+    // SPLIT at pc 0 ran at every start position tried
+    try std.testing.expect(profile.execs[0] >= 2);
+    // 'a' failed at both start positions, so its CHAR32 recorded backtracks
+    var total_backtracks: u64 = 0;
+    for (profile.backtracks) |count| total_backtracks += count;
+    try std.testing.expect(total_backtracks > 0);
+
+    var buf: std.ArrayListUnmanaged(u8) = .empty;
+    defer buf.deinit(std.testing.allocator);
+    try re.dumpProfile(buf.writer(std.testing.allocator));
+    try std.testing.expect(std.mem.indexOf(u8, buf.items, "SPLIT") != null);
+
+    re.resetProfile();
+    try std.testing.expectEqual(@as(u64, 0), profile.execs[0]);
+}
+
+test "Regex: dumpProfile requires profiling" {
+    var re = try Regex.compile(std.testing.allocator, "a");
+    defer re.deinit();
+
+    var buf: std.ArrayListUnmanaged(u8) = .empty;
+    defer buf.deinit(std.testing.allocator);
+    try std.testing.expectError(error.ProfilingDisabled, re.dumpProfile(buf.writer(std.testing.allocator)));
+}
+
+test "Regex: slow searches are logged" {
+    // No literal prefilter, so every search reaches the matcher
+    var re = try Regex.compile(std.testing.allocator, "(a|aa)*[bc]");
+    defer re.deinit();
+
+    slow_log.global.configure(.{ .step_threshold = 50, .sample_bytes = 8 });
+    defer slow_log.global.configure(.{});
+
+    try std.testing.expect(try re.find("aaaaaaaaaaaa") == null);
+    try std.testing.expect(try re.matchFull("b")); // fast, not logged
+
+    var entries: [4]slow_log.SlowEntry = undefined;
+    const n = slow_log.global.drain(&entries);
+    try std.testing.expectEqual(@as(usize, 1), n);
+    try std.testing.expectEqual(re.id, entries[0].pattern_id);
+    try std.testing.expectEqual(@as(u64, 12), entries[0].input_len);
+    try std.testing.expect(entries[0].steps >= 50);
+    try std.testing.expectEqualStrings("aaaaaaaa", entries[0].getSample());
+}
+
+test "Regex: metrics count calls and matches" {
+    var re = try Regex.compile(std.testing.allocator, "ab+");
+    defer re.deinit();
+
+    try re.enableMetrics("ab_rule");
+    try std.testing.expect(try re.matchFull("abbb"));
+    try std.testing.expect(!try re.matchFull("ac"));
+
+    const m = re.metrics.?;
+    try std.testing.expectEqual(@as(u64, 2), m.calls);
+    try std.testing.expectEqual(@as(u64, 1), m.matches);
+    try std.testing.expectEqual(@as(u64, 2), m.latency.count());
+
+    var buf: std.ArrayListUnmanaged(u8) = .empty;
+    defer buf.deinit(std.testing.allocator);
+    try metrics_mod.global.render(buf.writer(std.testing.allocator));
+    try std.testing.expect(std.mem.indexOf(u8, buf.items, "zregexp_calls_total{regex=\"ab_rule\"} 2\n") != null);
+}
+
+test "Regex: memory usage by category" {
+    const live_before = processProgramBytes();
+    var re = try Regex.compileWithOptions(std.testing.allocator, "[0-9]+ms", .{ .profile = true });
+    defer re.deinit();
+
+    const before = re.memoryUsage();
+    try std.testing.expect(before.program_bytes > re.compiled.bytecode.len);
+    try std.testing.expect(before.profile_bytes >= 2 * re.compiled.bytecode.len * @sizeOf(u64));
+    try std.testing.expectEqual(@as(usize, 0), before.metrics_bytes);
+    try std.testing.expectEqual(@as(usize, 0), before.cache_bytes);
+
+    try re.enableMetrics("latency");
+    try std.testing.expect(re.memoryUsage().total() > before.total());
+
+    // The process-wide counter grew by exactly this regex's program
+    try std.testing.expectEqual(live_before + before.program_bytes, processProgramBytes());
+}
+
+test "Regex: exec options apply to searches" {
+    var re = try Regex.compile(std.testing.allocator, "(a+)+b");
+    defer re.deinit();
+
+    // The input holds the prefilter literal "b", so the search reaches the matcher
+    re.exec_options = .{ .max_steps = 50 };
+    try std.testing.expectError(error.StepLimitExceeded, re.find("aaaaaaaaaaaaaaaaaaaaXb"));
+
+    var deep = try Regex.compile(std.testing.allocator, "(ab)*c");
+    defer deep.deinit();
+
+    deep.exec_options = .{ .max_recursion_depth = 0, .max_steps = 0, .max_scratch_bytes = 4096 };
+    try std.testing.expectError(error.ScratchLimitExceeded, deep.matchFull("ab" ** 2000 ++ "c"));
+}
+
+test "Regex: hot regexes are promoted to the decoded tier" {
+    tiering.policy.configure(.{ .call_threshold = 2 });
+    defer tiering.policy.configure(.{});
+
+    var re = try Regex.compile(std.testing.allocator, "[a-z]+@[a-z]+");
+    defer re.deinit();
+    try std.testing.expectEqual(Tier.interpreted, re.currentTier());
+
+    try std.testing.expect(try re.test_("bob@example"));
+    try std.testing.expect(try re.test_("alice@example"));
+    re.tier.?.waitForPromotion();
+    try std.testing.expectEqual(Tier.decoded, re.currentTier());
+
+    // Same results in the new tier
+    var stats = ExecStats{};
+    try std.testing.expect(try re.matchFullWithStats("carol@example", &stats));
+    try std.testing.expect(!try re.matchFull("carol@"));
+    try std.testing.expectEqual(exec_stats.Engine.backtrack_decoded, stats.engine);
+    try std.testing.expect(re.memoryUsage().tier_bytes > @sizeOf(TierState));
+}
+
+test "Regex: profile-guided branch order for isMatch" {
+    var profiled = try Regex.compileWithOptions(std.testing.allocator, "GET|POST|PUT", .{ .profile = true });
+    defer profiled.deinit();
+
+    for (0..5) |_| try std.testing.expect(try profiled.isMatch("POST /login"));
+    try std.testing.expect(try profiled.isMatch("GET /"));
+
+    var before = ExecStats{};
+    try std.testing.expect(try profiled.isMatchWithStats("POST /login", &before));
+
+    try profiled.reorderBranches();
+    try std.testing.expect(profiled.branch_order.?.swappedCount() > 0);
+
+    var after = ExecStats{};
+    try std.testing.expect(try profiled.isMatchWithStats("POST /login", &after));
+    try std.testing.expect(after.backtracks < before.backtracks);
+
+    // Answers are unchanged
+    try std.testing.expect(try profiled.isMatch("GET /"));
+    try std.testing.expect(try profiled.isMatch("PUT /"));
+    try std.testing.expect(!try profiled.isMatch("DELETE /"));
+
+    // find keeps leftmost-first order: "abc" still wins over the more frequent "a."
+    var overlap = try Regex.compileWithOptions(std.testing.allocator, "abc|a.", .{ .profile = true });
+    defer overlap.deinit();
+    for (0..5) |_| try std.testing.expect(try overlap.isMatch("ax"));
+    try overlap.reorderBranches();
+    try std.testing.expect(overlap.branch_order.?.swappedCount() > 0);
+    const found = (try overlap.find("abc")).?;
+    defer found.deinit();
+    try std.testing.expectEqual(@as(usize, 3), found.end);
+
+    // Counters carry over to a regex compiled without profiling
+    var text: std.ArrayListUnmanaged(u8) = .empty;
+    defer text.deinit(std.testing.allocator);
+    try profiled.exportBranchProfile(text.writer(std.testing.allocator));
+
+    var production = try Regex.compileWithOptions(std.testing.allocator, "GET|POST|PUT", .{});
+    defer production.deinit();
+    try production.importBranchProfile(text.items);
+    try std.testing.expectEqualSlices(bool, profiled.branch_order.?.swapped, production.branch_order.?.swapped);
+
+    var other = try Regex.compile(std.testing.allocator, "GET|HEAD");
+    defer other.deinit();
+    try std.testing.expectError(error.BranchProfileMismatch, other.importBranchProfile(text.items));
+    try std.testing.expectError(error.ProfilingDisabled, other.reorderBranches());
+}
+
+test "Regex: no tier state while tiering is off" {
+    var re = try Regex.compile(std.testing.allocator, "[a-z]+@[a-z]+");
+    defer re.deinit();
+    try std.testing.expect(re.tier == null);
+    try std.testing.expectEqual(@as(usize, 0), re.memoryUsage().tier_bytes);
+
+    for (0..10) |_| try std.testing.expect(try re.isMatch("bob@example"));
+    try std.testing.expect(re.tier == null);
+    try std.testing.expectEqual(Tier.interpreted, re.currentTier());
+}
+
+test "Regex: prepare builds the decoded tier up front" {
+    var re = try Regex.compile(std.testing.allocator, "(GET|POST) /[a-z]+");
+    defer re.deinit();
+    try std.testing.expectEqual(Tier.interpreted, re.currentTier());
+
+    try re.prepare(.{});
+    try std.testing.expectEqual(Tier.decoded, re.currentTier());
+    try std.testing.expect(try re.isMatch("POST /login"));
+
+    var untouched = try Regex.compile(std.testing.allocator, "x");
+    defer untouched.deinit();
+    try untouched.prepare(.{ .decode = false });
+    try std.testing.expectEqual(Tier.interpreted, untouched.currentTier());
+}
+
+test "Regex: result cache answers repeated inputs" {
+    var re = try Regex.compile(std.testing.allocator, "Chrome/([0-9]+)");
+    defer re.deinit();
+    try std.testing.expectEqual(@as(?CacheStats, null), re.cacheStats());
+
+    try re.enableCache(.{ .max_bytes = 8 * 1024, .max_input_len = 64 });
+    try std.testing.expect(re.memoryUsage().cache_bytes > 0);
+    try std.testing.expect(processCacheBytes() >= re.memoryUsage().cache_bytes);
+
+    const agent = "Mozilla/5.0 Chrome/120.0";
+    try std.testing.expect(try re.isMatch(agent));
+
+    var stats: ExecStats = .{};
+    try std.testing.expect(try re.isMatchWithStats(agent, &stats));
+    try std.testing.expectEqual(@as(u64, 1), stats.cache_hits);
+    try std.testing.expectEqual(@as(u64, 0), stats.steps);
+
+    // find records the start; the next find only tries that position
+    const first = (try re.find(agent)).?;
+    defer first.deinit();
+    stats = .{};
+    const again = (try re.findWithStats(agent, &stats)).?;
+    defer again.deinit();
+    try std.testing.expectEqual(first.start, again.start);
+    try std.testing.expectEqual(first.end, again.end);
+    try std.testing.expectEqualStrings("120", again.getCapture(1, agent).?);
+    try std.testing.expectEqual(@as(u64, 1), stats.start_positions);
+    try std.testing.expectEqual(@as(u64, 1), stats.cache_hits);
+
+    // Negative results are cached too
+    try std.testing.expect(!try re.isMatch("Chrome/beta"));
+    try std.testing.expect(!try re.isMatch("Chrome/beta"));
+    const cache_stats = re.cacheStats().?;
+    try std.testing.expectEqual(@as(u64, 4), cache_stats.hits);
+}
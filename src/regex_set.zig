@@ -0,0 +1,241 @@
+//! Regex sets
+//!
+//! A RegexSet compiles a list of patterns together and reports which of them
+//! match a given input. Sets are immutable once compiled, so a single set can
+//! be shared by any number of reader threads.
+//!
+//! ```zig
+//! const patterns = [_][]const u8{ "error", "warn(ing)?", "[0-9]+ms" };
+//! var set = try RegexSet.compile(allocator, &patterns, .{});
+//! defer set.deinit();
+//!
+//! var ids: [3]usize = undefined;
+//! const n = try set.matchIds("warning after 250ms", &ids); // ids[0..n] == { 1, 2 }
+//! ```
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+const regex_mod = @import("regex.zig");
+const compiler = @import("codegen/compiler.zig");
+const result_cache = @import("result_cache.zig");
+
+const Regex = regex_mod.Regex;
+const RegexError = regex_mod.RegexError;
+const PrepareOptions = regex_mod.PrepareOptions;
+const ExecOptions = regex_mod.ExecOptions;
+const CacheConfig = regex_mod.CacheConfig;
+const CacheStats = regex_mod.CacheStats;
+const ResultCache = result_cache.ResultCache;
+const CompileOptions = compiler.CompileOptions;
+
+/// Immutable set of compiled patterns
+pub const RegexSet = struct {
+    allocator: Allocator,
+
+    /// Compiled patterns, indexed by rule id
+    regexes: []Regex,
+
+    /// Owned copies of the source patterns (Regex only borrows its pattern)
+    patterns: [][]u8,
+
+    /// Results of recent matchesRule calls keyed by (rule, input), see enableCache
+    cache: ?*ResultCache = null,
+
+    const Self = @This();
+
+    /// Compile every pattern; fails without leaking if any pattern is invalid
+    pub fn compile(allocator: Allocator, patterns: []const []const u8, options: CompileOptions) RegexError!Self {
+        const owned = try allocator.alloc([]u8, patterns.len);
+        errdefer allocator.free(owned);
+
+        const regexes = try allocator.alloc(Regex, patterns.len);
+        errdefer allocator.free(regexes);
+
+        var compiled: usize = 0;
+        errdefer for (0..compiled) |i| {
+            regexes[i].deinit();
+            allocator.free(owned[i]);
+        };
+
+        for (patterns, 0..) |pattern, i| {
+            owned[i] = try allocator.dupe(u8, pattern);
+            regexes[i] = Regex.compileWithOptions(allocator, owned[i], options) catch |err| {
+                allocator.free(owned[i]);
+                return err;
+            };
+            compiled += 1;
+        }
+
+        return initOwned(allocator, regexes, owned);
+    }
+
+    /// Build a set from already compiled regexes, taking ownership of both
+    /// slices; `patterns[i]` must be the (owned) source of `regexes[i]`
+    pub fn initOwned(allocator: Allocator, regexes: []Regex, patterns: [][]u8) Self {
+        return .{
+            .allocator = allocator,
+            .regexes = regexes,
+            .patterns = patterns,
+        };
+    }
+
+    /// Free all compiled patterns
+    pub fn deinit(self: Self) void {
+        for (self.regexes, self.patterns) |re, pattern| {
+            re.deinit();
+            self.allocator.free(pattern);
+        }
+        self.allocator.free(self.regexes);
+        self.allocator.free(self.patterns);
+        if (self.cache) |cache| cache.destroy();
+    }
+
+    /// Number of patterns in the set
+    pub fn len(self: Self) usize {
+        return self.regexes.len;
+    }
+
+    /// Test whether pattern `id` matches anywhere in input
+    pub fn matchesRule(self: Self, id: usize, input: []const u8) RegexError!bool {
+        const cache = self.cache orelse return self.regexes[id].isMatch(input);
+        if (cache.lookupTagged(id, input)) |cached| return cached.matched;
+
+        const matched = try self.regexes[id].isMatch(input);
+        cache.storeTagged(id, input, .{ .matched = matched });
+        return matched;
+    }
+
+    /// Test whether any pattern matches anywhere in input
+    pub fn isMatch(self: Self, input: []const u8) RegexError!bool {
+        for (0..self.regexes.len) |id| {
+            if (try self.matchesRule(id, input)) return true;
+        }
+        return false;
+    }
+
+    /// Prepare every rule (see Regex.prepare)
+    pub fn prepare(self: Self, options: PrepareOptions) RegexError!void {
+        for (self.regexes) |*re| try re.prepare(options);
+    }
+
+    /// Apply the execution limits `options` to every rule
+    /// Call before sharing the set between threads.
+    pub fn setExecOptions(self: Self, options: ExecOptions) void {
+        for (self.regexes) |*re| re.exec_options = options;
+    }
+
+    /// Cache rule results for repeated short inputs in one cache of `config`
+    /// shared by every rule (see Regex.enableCache); a second call replaces it.
+    /// Call before sharing the set between threads.
+    pub fn enableCache(self: *Self, config: CacheConfig) Allocator.Error!void {
+        const cache = try ResultCache.create(self.allocator, config);
+        if (self.cache) |old| old.destroy();
+        self.cache = cache;
+    }
+
+    /// Hit and miss counters of the shared result cache, if enabled
+    pub fn cacheStats(self: Self) ?CacheStats {
+        const cache = self.cache orelse return null;
+        return cache.stats();
+    }
+
+    /// Reorder the alternations of every profiled rule by its branch counters
+    /// (see Regex.reorderBranches). Call before sharing the set between threads.
+    pub fn reorderBranches(self: Self) Allocator.Error!void {
+        for (self.regexes) |*re| {
+            if (re.profile == null) continue;
+            re.reorderBranches() catch |err| switch (err) {
+                error.ProfilingDisabled => unreachable,
+                error.OutOfMemory => |e| return e,
+            };
+        }
+    }
+
+    /// Write the ids of matching patterns (ascending) into `out`
+    /// Returns the total number of matching patterns, which may exceed out.len
+    pub fn matchIds(self: Self, input: []const u8, out: []usize) RegexError!usize {
+        var count: usize = 0;
+        for (0..self.regexes.len) |id| {
+            if (try self.matchesRule(id, input)) {
+                if (count < out.len) out[count] = id;
+                count += 1;
+            }
+        }
+        return count;
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "RegexSet: matchIds" {
+    const patterns = [_][]const u8{ "error", "warn(ing)?", "[0-9]+ms" };
+    var set = try RegexSet.compile(std.testing.allocator, &patterns, .{});
+    defer set.deinit();
+
+    try std.testing.expectEqual(@as(usize, 3), set.len());
+
+    var ids: [3]usize = undefined;
+    const n = try set.matchIds("warning after 250ms", &ids);
+    try std.testing.expectEqual(@as(usize, 2), n);
+    try std.testing.expectEqual(@as(usize, 1), ids[0]);
+    try std.testing.expectEqual(@as(usize, 2), ids[1]);
+
+    try std.testing.expect(try set.isMatch("fatal error"));
+    try std.testing.expect(!try set.isMatch("all good"));
+}
+
+test "RegexSet: matchIds reports total beyond buffer" {
+    const patterns = [_][]const u8{ "a", "b", "c" };
+    var set = try RegexSet.compile(std.testing.allocator, &patterns, .{});
+    defer set.deinit();
+
+    var ids: [1]usize = undefined;
+    try std.testing.expectEqual(@as(usize, 3), try set.matchIds("abc", &ids));
+    try std.testing.expectEqual(@as(usize, 0), ids[0]);
+}
+
+test "RegexSet: invalid pattern does not leak" {
+    const patterns = [_][]const u8{ "ok", "(unclosed", "never" };
+    try std.testing.expectError(error.UnexpectedToken, RegexSet.compile(std.testing.allocator, &patterns, .{}));
+}
+
+test "RegexSet: reorderBranches keeps answers" {
+    const patterns = [_][]const u8{ "cat|dog", "[0-9]+" };
+    var set = try RegexSet.compile(std.testing.allocator, &patterns, .{ .profile = true });
+    defer set.deinit();
+
+    for (0..3) |_| try std.testing.expect(try set.matchesRule(0, "hot dog"));
+    try set.reorderBranches();
+    try std.testing.expect(set.regexes[0].branch_order.?.swappedCount() > 0);
+
+    var ids: [2]usize = undefined;
+    try std.testing.expectEqual(@as(usize, 1), try set.matchIds("a cat", &ids));
+    try std.testing.expectEqual(@as(usize, 0), ids[0]);
+    try std.testing.expect(!try set.isMatch("a cow"));
+}
+
+test "RegexSet: one result cache serves every rule" {
+    const patterns = [_][]const u8{ "Chrome/[0-9]+", "Firefox", "Mobile" };
+    var set = try RegexSet.compile(std.testing.allocator, &patterns, .{});
+    defer set.deinit();
+    try std.testing.expectEqual(@as(?CacheStats, null), set.cacheStats());
+
+    try set.enableCache(.{ .max_bytes = 16 * 1024, .max_input_len = 64 });
+    try std.testing.expect(set.cache.?.memoryUsage() <= 16 * 1024);
+
+    var ids: [3]usize = undefined;
+    const agent = "Mozilla/5.0 Chrome/120.0 Mobile";
+    for (0..2) |_| {
+        try std.testing.expectEqual(@as(usize, 2), try set.matchIds(agent, &ids));
+        try std.testing.expectEqual(@as(usize, 0), ids[0]);
+        try std.testing.expectEqual(@as(usize, 2), ids[1]);
+    }
+
+    // Each rule keeps its own answer for the same input
+    const stats = set.cacheStats().?;
+    try std.testing.expectEqual(@as(u64, 3), stats.misses);
+    try std.testing.expectEqual(@as(u64, 3), stats.hits);
+}
@@ -0,0 +1,370 @@
+//! Shared rule registry
+//!
+//! A registry file holds many compiled programs behind an index, laid out so
+//! the file can be mapped read-only and used in place: every reference is an
+//! offset from the start of the file, nothing is patched on load. Worker
+//! processes that map the same file share one physical copy of the programs
+//! through the page cache instead of each compiling and holding its own.
+//!
+//! Opening a registry only validates the header and index. A Regex is
+//! materialized the first time its id is requested: the program's checksum is
+//! verified and a small Regex borrowing the mapped bytecode, prefilter and
+//! pattern is allocated. Only that handle (and anything it later builds, such
+//! as a pre-decoded tier) is private to the process.
+//!
+//! Layout (little endian):
+//!
+//!     header   magic "zregexp\x00", version u32, count u32, file length u64,
+//!              program alignment u32, reserved u32
+//!     index    count entries of: offset u64, program length u32,
+//!              prefilter length u32 (0xFFFFFFFF = none), pattern length u32,
+//!              program crc32 u32, reserved u64
+//!     data     per entry at `offset`, aligned to the header's program
+//!              alignment (format.program_alignment of the writer):
+//!              bytecode, prefilter literal, pattern text
+//!
+//! Registries are written to a temporary file and renamed into place, so
+//! processes still mapping the previous version keep reading valid pages.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const Allocator = std.mem.Allocator;
+
+const regex_mod = @import("regex.zig");
+const format = @import("bytecode/format.zig");
+const Regex = regex_mod.Regex;
+
+/// First bytes of a registry file
+pub const MAGIC = "zregexp\x00";
+
+/// Format version written by this library
+pub const VERSION: u32 = 2;
+
+const HEADER_SIZE = 32;
+const ENTRY_SIZE = 32;
+const NO_PREFILTER = std.math.maxInt(u32);
+
+/// Errors from reading a registry
+pub const RegistryError = Allocator.Error || error{
+    /// File is not a registry, is truncated or fails its checksum
+    InvalidRegistry,
+
+    /// No rule with this id
+    InvalidRuleId,
+};
+
+/// Errors from writing a registry
+pub const SerializeError = Allocator.Error || error{
+    /// Program, prefilter or pattern does not fit a 32-bit length
+    EntryTooLarge,
+};
+
+/// One index entry
+const Entry = struct {
+    offset: u64,
+    program_len: u32,
+    prefilter_len: u32,
+    pattern_len: u32,
+    checksum: u32,
+
+    fn read(image: []const u8, index: usize) Entry {
+        const bytes = image[HEADER_SIZE + index * ENTRY_SIZE ..][0..ENTRY_SIZE];
+        return .{
+            .offset = std.mem.readInt(u64, bytes[0..8], .little),
+            .program_len = std.mem.readInt(u32, bytes[8..12], .little),
+            .prefilter_len = std.mem.readInt(u32, bytes[12..16], .little),
+            .pattern_len = std.mem.readInt(u32, bytes[16..20], .little),
+            .checksum = std.mem.readInt(u32, bytes[20..24], .little),
+        };
+    }
+
+    fn write(self: Entry, image: []u8, index: usize) void {
+        const bytes = image[HEADER_SIZE + index * ENTRY_SIZE ..][0..ENTRY_SIZE];
+        std.mem.writeInt(u64, bytes[0..8], self.offset, .little);
+        std.mem.writeInt(u32, bytes[8..12], self.program_len, .little);
+        std.mem.writeInt(u32, bytes[12..16], self.prefilter_len, .little);
+        std.mem.writeInt(u32, bytes[16..20], self.pattern_len, .little);
+        std.mem.writeInt(u32, bytes[20..24], self.checksum, .little);
+        std.mem.writeInt(u64, bytes[24..32], 0, .little);
+    }
+
+    /// Bytes from `offset` to the end of the pattern
+    fn dataLen(self: Entry) u64 {
+        const prefilter_len: u64 = if (self.prefilter_len == NO_PREFILTER) 0 else self.prefilter_len;
+        return @as(u64, self.program_len) + prefilter_len + self.pattern_len;
+    }
+};
+
+/// Registry image of `regexes`; rule ids are indices into `regexes` (caller owns the result)
+pub fn serialize(allocator: Allocator, regexes: []const Regex) SerializeError![]u8 {
+    const count = std.math.cast(u32, regexes.len) orelse return error.EntryTooLarge;
+
+    var image: std.ArrayList(u8) = .empty;
+    errdefer image.deinit(allocator);
+    try image.appendNTimes(allocator, 0, HEADER_SIZE + regexes.len * ENTRY_SIZE);
+
+    const alignment = format.program_alignment.toByteUnits();
+    for (regexes, 0..) |re, i| {
+        const padding = std.mem.alignForward(usize, image.items.len, alignment) - image.items.len;
+        try image.appendNTimes(allocator, 0, padding);
+
+        const program = re.compiled.bytecode;
+        const entry = Entry{
+            .offset = image.items.len,
+            .program_len = std.math.cast(u32, program.len) orelse return error.EntryTooLarge,
+            .prefilter_len = if (re.compiled.prefilter) |literal|
+                std.math.cast(u32, literal.len) orelse return error.EntryTooLarge
+            else
+                NO_PREFILTER,
+            .pattern_len = std.math.cast(u32, re.pattern.len) orelse return error.EntryTooLarge,
+            .checksum = std.hash.Crc32.hash(program),
+        };
+        if (entry.prefilter_len == NO_PREFILTER and re.compiled.prefilter != null) return error.EntryTooLarge;
+
+        try image.appendSlice(allocator, program);
+        if (re.compiled.prefilter) |literal| try image.appendSlice(allocator, literal);
+        try image.appendSlice(allocator, re.pattern);
+        entry.write(image.items, i);
+    }
+
+    const header = image.items[0..HEADER_SIZE];
+    @memcpy(header[0..8], MAGIC);
+    std.mem.writeInt(u32, header[8..12], VERSION, .little);
+    std.mem.writeInt(u32, header[12..16], count, .little);
+    std.mem.writeInt(u64, header[16..24], image.items.len, .little);
+    std.mem.writeInt(u32, header[24..28], @intCast(alignment), .little);
+    std.mem.writeInt(u32, header[28..32], 0, .little);
+
+    return image.toOwnedSlice(allocator);
+}
+
+/// Write the registry of `regexes` to `sub_path`, replacing any existing file atomically
+pub fn save(allocator: Allocator, dir: std.fs.Dir, sub_path: []const u8, regexes: []const Regex) !void {
+    const image = try serialize(allocator, regexes);
+    defer allocator.free(image);
+
+    const tmp_path = try std.fmt.allocPrint(allocator, "{s}.tmp", .{sub_path});
+    defer allocator.free(tmp_path);
+
+    try dir.writeFile(.{ .sub_path = tmp_path, .data = image });
+    errdefer dir.deleteFile(tmp_path) catch {};
+    try dir.rename(tmp_path, sub_path);
+}
+
+/// Read-only view of a registry image with lazily materialized regexes
+pub const Registry = struct {
+    allocator: Allocator,
+
+    /// Registry bytes (mapped by open, borrowed by fromBytes)
+    image: []const u8,
+
+    /// Mapping to release on deinit (open only)
+    mapping: ?[]align(std.heap.page_size_min) const u8 = null,
+
+    /// Materialized regex per rule id (owned), published with release
+    slots: []std.atomic.Value(?*Regex),
+
+    const Self = @This();
+
+    /// Use an in-memory image, which must outlive the registry
+    pub fn fromBytes(allocator: Allocator, image: []const u8) RegistryError!Self {
+        if (image.len < HEADER_SIZE or !std.mem.eql(u8, image[0..8], MAGIC)) return error.InvalidRegistry;
+        if (std.mem.readInt(u32, image[8..12], .little) != VERSION) return error.InvalidRegistry;
+        if (std.mem.readInt(u64, image[16..24], .little) != image.len) return error.InvalidRegistry;
+
+        const count = std.mem.readInt(u32, image[12..16], .little);
+        if ((image.len - HEADER_SIZE) / ENTRY_SIZE < count) return error.InvalidRegistry;
+
+        // Programs keep the writer's alignment, which may differ from this build's
+        const alignment = std.mem.readInt(u32, image[24..28], .little);
+        if (alignment == 0 or !std.math.isPowerOfTwo(alignment)) return error.InvalidRegistry;
+
+        for (0..count) |i| {
+            const entry = Entry.read(image, i);
+            if (entry.program_len == 0) return error.InvalidRegistry;
+            if (entry.offset % alignment != 0) return error.InvalidRegistry;
+            if (entry.offset > image.len or entry.dataLen() > image.len - entry.offset) return error.InvalidRegistry;
+        }
+
+        const slots = try allocator.alloc(std.atomic.Value(?*Regex), count);
+        for (slots) |*slot| slot.* = std.atomic.Value(?*Regex).init(null);
+
+        return .{
+            .allocator = allocator,
+            .image = image,
+            .slots = slots,
+        };
+    }
+
+    /// Map the registry at `sub_path` read-only (POSIX)
+    pub fn open(allocator: Allocator, dir: std.fs.Dir, sub_path: []const u8) !Self {
+        if (builtin.os.tag == .windows) return error.Unsupported;
+
+        const file = try dir.openFile(sub_path, .{});
+        defer file.close();
+
+        const len = std.math.cast(usize, try file.getEndPos()) orelse return error.InvalidRegistry;
+        if (len < HEADER_SIZE) return error.InvalidRegistry;
+
+        const mapping = try std.posix.mmap(null, len, std.posix.PROT.READ, .{ .TYPE = .SHARED }, file.handle, 0);
+        errdefer std.posix.munmap(mapping);
+
+        var self = try fromBytes(allocator, mapping);
+        self.mapping = mapping;
+        return self;
+    }
+
+    /// Free materialized regexes and unmap the file; no other thread may be using it
+    pub fn deinit(self: Self) void {
+        for (self.slots) |*slot| {
+            if (slot.load(.acquire)) |re| {
+                re.deinit();
+                self.allocator.destroy(re);
+            }
+        }
+        self.allocator.free(self.slots);
+        if (self.mapping) |mapping| std.posix.munmap(mapping);
+    }
+
+    /// Number of rules
+    pub fn len(self: Self) usize {
+        return self.slots.len;
+    }
+
+    /// Regex for rule `id`, materialized on first use (safe to call from any thread)
+    pub fn get(self: Self, id: usize) RegistryError!*Regex {
+        if (id >= self.slots.len) return error.InvalidRuleId;
+        if (self.slots[id].load(.acquire)) |re| return re;
+
+        const re = try self.materialize(id);
+        // Racing first calls: one publishes, the others free their copy
+        if (self.slots[id].cmpxchgStrong(null, re, .acq_rel, .acquire)) |winner| {
+            re.deinit();
+            self.allocator.destroy(re);
+            return winner;
+        }
+        return re;
+    }
+
+    /// Number of rules materialized so far
+    pub fn materializedCount(self: Self) usize {
+        var count: usize = 0;
+        for (self.slots) |*slot| count += @intFromBool(slot.load(.monotonic) != null);
+        return count;
+    }
+
+    fn materialize(self: Self, id: usize) RegistryError!*Regex {
+        const entry = Entry.read(self.image, id);
+        var data = self.image[@intCast(entry.offset)..];
+
+        const bytecode = data[0..entry.program_len];
+        data = data[entry.program_len..];
+        if (std.hash.Crc32.hash(bytecode) != entry.checksum) return error.InvalidRegistry;
+
+        var prefilter: ?[]const u8 = null;
+        if (entry.prefilter_len != NO_PREFILTER) {
+            prefilter = data[0..entry.prefilter_len];
+            data = data[entry.prefilter_len..];
+        }
+        const pattern = data[0..entry.pattern_len];
+
+        const re = try self.allocator.create(Regex);
+        errdefer self.allocator.destroy(re);
+        re.* = try Regex.fromProgram(self.allocator, bytecode, prefilter, pattern);
+        return re;
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+fn compileAll(patterns: []const []const u8) ![]Regex {
+    const regexes = try std.testing.allocator.alloc(Regex, patterns.len);
+    for (regexes, patterns) |*re, pattern| re.* = try Regex.compile(std.testing.allocator, pattern);
+    return regexes;
+}
+
+fn freeAll(regexes: []Regex) void {
+    for (regexes) |re| re.deinit();
+    std.testing.allocator.free(regexes);
+}
+
+test "Registry: round trip with lazy materialization" {
+    const patterns = [_][]const u8{ "error: [a-z]+", "\\d{3}-\\d{4}", "cat|dog" };
+    const regexes = try compileAll(&patterns);
+    defer freeAll(regexes);
+
+    const image = try serialize(std.testing.allocator, regexes);
+    defer std.testing.allocator.free(image);
+
+    var registry = try Registry.fromBytes(std.testing.allocator, image);
+    defer registry.deinit();
+
+    try std.testing.expectEqual(@as(usize, 3), registry.len());
+    try std.testing.expectEqual(@as(usize, 0), registry.materializedCount());
+
+    const phone = try registry.get(1);
+    try std.testing.expectEqualStrings("\\d{3}-\\d{4}", phone.pattern);
+    try std.testing.expect(try phone.isMatch("call 555-1234"));
+    try std.testing.expectEqual(@as(usize, 1), registry.materializedCount());
+
+    // Same handle on later calls; program bytes live in the image
+    try std.testing.expectEqual(phone, try registry.get(1));
+    try std.testing.expectEqual(@as(usize, 0), phone.compiled.memoryUsage());
+    try std.testing.expect(std.mem.isAligned(@intFromPtr(phone.compiled.bytecode.ptr) - @intFromPtr(image.ptr), format.program_alignment.toByteUnits()));
+    try std.testing.expectEqual(format.program_alignment.toByteUnits(), std.mem.readInt(u32, image[24..28], .little));
+
+    const first = try registry.get(0);
+    const match = (try first.find("fatal error: disk full")).?;
+    defer match.deinit();
+    try std.testing.expectEqual(@as(usize, 6), match.start);
+
+    try std.testing.expectError(error.InvalidRuleId, registry.get(3));
+}
+
+test "Registry: rejects damaged images" {
+    const patterns = [_][]const u8{"needle"};
+    const regexes = try compileAll(&patterns);
+    defer freeAll(regexes);
+
+    const image = try serialize(std.testing.allocator, regexes);
+    defer std.testing.allocator.free(image);
+
+    try std.testing.expectError(error.InvalidRegistry, Registry.fromBytes(std.testing.allocator, image[0 .. image.len - 1]));
+    try std.testing.expectError(error.InvalidRegistry, Registry.fromBytes(std.testing.allocator, "not a registry"));
+
+    // Alignment that is not a power of two, then one the offsets do not meet
+    const alignment = std.mem.readInt(u32, image[24..28], .little);
+    std.mem.writeInt(u32, image[24..28], 3, .little);
+    try std.testing.expectError(error.InvalidRegistry, Registry.fromBytes(std.testing.allocator, image));
+    std.mem.writeInt(u32, image[24..28], 1 << 20, .little);
+    try std.testing.expectError(error.InvalidRegistry, Registry.fromBytes(std.testing.allocator, image));
+    std.mem.writeInt(u32, image[24..28], alignment, .little);
+
+    // Flipped program byte: the index is fine, materializing fails
+    const program_offset = Entry.read(image, 0).offset;
+    image[@intCast(program_offset)] ^= 0xFF;
+    var registry = try Registry.fromBytes(std.testing.allocator, image);
+    defer registry.deinit();
+    try std.testing.expectError(error.InvalidRegistry, registry.get(0));
+}
+
+test "Registry: save and map a file" {
+    if (builtin.os.tag == .windows) return error.SkipZigTest;
+
+    const patterns = [_][]const u8{ "foo+", "ba[rz]" };
+    const regexes = try compileAll(&patterns);
+    defer freeAll(regexes);
+
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    try save(std.testing.allocator, tmp.dir, "rules.zrx", regexes);
+
+    var registry = try Registry.open(std.testing.allocator, tmp.dir, "rules.zrx");
+    defer registry.deinit();
+
+    try std.testing.expect(try (try registry.get(1)).isMatch("a baz"));
+    try std.testing.expect(!try (try registry.get(0)).isMatch("fo"));
+}
@@ -0,0 +1,335 @@
+//! Result cache
+//!
+//! Many workloads match the same short values over and over (user agents,
+//! referrers, header values). A ResultCache remembers the outcome of recent
+//! searches keyed by the input bytes, so a repeated value is answered without
+//! running the matcher. Only inputs up to `max_input_len` bytes are cached;
+//! their bytes are stored and compared on lookup, so a hash collision can
+//! never return another input's result. Keys carry a tag as well, so one
+//! cache can serve every rule of a RegexSet.
+//!
+//! Storage is a fixed set of direct-mapped slots split across shards, each
+//! behind its own mutex and on its own cache line, so concurrent searches on
+//! different inputs rarely contend. A new result simply replaces whatever
+//! occupied its slot; the cache never grows past its configured size.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+/// Sizing of a result cache
+pub const CacheConfig = struct {
+    /// Upper bound on the cache's heap bytes (see ResultCache.memoryUsage)
+    max_bytes: usize = 256 * 1024,
+
+    /// Longer inputs bypass the cache
+    max_input_len: usize = 256,
+};
+
+/// Cached outcome of a search over one input
+pub const CachedResult = struct {
+    /// Whether the regex matches the input anywhere
+    matched: bool,
+
+    /// Start of the first match, when recorded by a find
+    start: ?usize = null,
+};
+
+/// Hit and miss counters
+pub const CacheStats = struct {
+    /// Lookups answered from the cache
+    hits: u64 = 0,
+
+    /// Lookups of cacheable inputs that were not present
+    misses: u64 = 0,
+
+    /// Stores that replaced a different input
+    evictions: u64 = 0,
+
+    /// Fraction of lookups that hit (0 when there were none)
+    pub fn hitRate(self: CacheStats) f64 {
+        const lookups = self.hits + self.misses;
+        if (lookups == 0) return 0;
+        return @as(f64, @floatFromInt(self.hits)) / @as(f64, @floatFromInt(lookups));
+    }
+};
+
+/// Shards of a cache large enough to give each one a slot
+const SHARD_COUNT = 16;
+
+/// Heap bytes held by every live cache
+var live_bytes = std.atomic.Value(usize).init(0);
+
+/// Heap bytes of every live ResultCache in the process
+pub fn liveBytes() usize {
+    return live_bytes.load(.monotonic);
+}
+
+const Slot = struct {
+    hash: u64 = 0,
+    tag: u64 = 0,
+    len: u32 = 0,
+    occupied: bool = false,
+    result: CachedResult = .{ .matched = false },
+};
+
+const Shard = struct {
+    mutex: std.Thread.Mutex align(std.atomic.cache_line) = .{},
+    slots: []Slot,
+
+    /// max_input_len bytes of key per slot
+    keys: []u8,
+};
+
+/// Bounded, sharded map from short inputs to search results
+pub const ResultCache = struct {
+    allocator: Allocator,
+    shards: []Shard,
+    slots_per_shard: usize,
+    max_input_len: usize,
+
+    hits: std.atomic.Value(u64),
+    misses: std.atomic.Value(u64),
+    evictions: std.atomic.Value(u64),
+
+    const Self = @This();
+
+    /// Allocate an empty cache within `config.max_bytes`
+    /// Small budgets get fewer shards; a budget too small for one slot gives a
+    /// cache that stores nothing.
+    pub fn create(allocator: Allocator, config: CacheConfig) Allocator.Error!*Self {
+        const slot_bytes = @sizeOf(Slot) + config.max_input_len;
+        const budget = config.max_bytes -| @sizeOf(Self);
+        const shard_count = @min(SHARD_COUNT, budget / (@sizeOf(Shard) + slot_bytes));
+        const slots_per_shard = if (shard_count == 0) 0 else (budget - shard_count * @sizeOf(Shard)) / (shard_count * slot_bytes);
+
+        const self = try allocator.create(Self);
+        errdefer allocator.destroy(self);
+
+        const shards = try allocator.alloc(Shard, shard_count);
+        var initialized: usize = 0;
+        errdefer {
+            for (shards[0..initialized]) |shard| {
+                allocator.free(shard.slots);
+                allocator.free(shard.keys);
+            }
+            allocator.free(shards);
+        }
+
+        for (shards) |*shard| {
+            const slots = try allocator.alloc(Slot, slots_per_shard);
+            errdefer allocator.free(slots);
+            @memset(slots, .{});
+            shard.* = .{
+                .slots = slots,
+                .keys = try allocator.alloc(u8, slots_per_shard * config.max_input_len),
+            };
+            initialized += 1;
+        }
+
+        self.* = .{
+            .allocator = allocator,
+            .shards = shards,
+            .slots_per_shard = slots_per_shard,
+            .max_input_len = config.max_input_len,
+            .hits = std.atomic.Value(u64).init(0),
+            .misses = std.atomic.Value(u64).init(0),
+            .evictions = std.atomic.Value(u64).init(0),
+        };
+        _ = live_bytes.fetchAdd(self.memoryUsage(), .monotonic);
+        return self;
+    }
+
+    /// Free the cache
+    pub fn destroy(self: *Self) void {
+        _ = live_bytes.fetchSub(self.memoryUsage(), .monotonic);
+        for (self.shards) |shard| {
+            self.allocator.free(shard.slots);
+            self.allocator.free(shard.keys);
+        }
+        self.allocator.free(self.shards);
+        self.allocator.destroy(self);
+    }
+
+    /// Whether results for `input` are cached at all
+    pub fn accepts(self: *const Self, input: []const u8) bool {
+        return self.slots_per_shard > 0 and input.len <= self.max_input_len;
+    }
+
+    /// Cached result for `input`, if present
+    pub fn lookup(self: *Self, input: []const u8) ?CachedResult {
+        return self.lookupTagged(0, input);
+    }
+
+    /// Cached result for `input` under `tag` (such as a rule id), if present
+    pub fn lookupTagged(self: *Self, tag: u64, input: []const u8) ?CachedResult {
+        if (!self.accepts(input)) return null;
+
+        const hash = hashInput(tag, input);
+        const shard, const index = self.locate(hash);
+
+        shard.mutex.lock();
+        const slot = shard.slots[index];
+        const hit = slot.occupied and slot.hash == hash and slot.tag == tag and slot.len == input.len and
+            std.mem.eql(u8, self.key(shard, index)[0..input.len], input);
+        shard.mutex.unlock();
+
+        if (!hit) {
+            _ = self.misses.fetchAdd(1, .monotonic);
+            return null;
+        }
+        _ = self.hits.fetchAdd(1, .monotonic);
+        return slot.result;
+    }
+
+    /// Remember `result` for `input` (ignored for inputs longer than max_input_len)
+    pub fn store(self: *Self, input: []const u8, result: CachedResult) void {
+        self.storeTagged(0, input, result);
+    }
+
+    /// Remember `result` for `input` under `tag`
+    pub fn storeTagged(self: *Self, tag: u64, input: []const u8, result: CachedResult) void {
+        if (!self.accepts(input)) return;
+
+        const hash = hashInput(tag, input);
+        const shard, const index = self.locate(hash);
+
+        shard.mutex.lock();
+        defer shard.mutex.unlock();
+
+        const slot = &shard.slots[index];
+        const key_bytes = self.key(shard, index);
+        const same = slot.occupied and slot.hash == hash and slot.tag == tag and slot.len == input.len and
+            std.mem.eql(u8, key_bytes[0..input.len], input);
+
+        if (same) {
+            // An isMatch result must not drop a start recorded by find
+            if (result.start != null or slot.result.start == null) slot.result = result;
+            return;
+        }
+        if (slot.occupied) _ = self.evictions.fetchAdd(1, .monotonic);
+
+        @memcpy(key_bytes[0..input.len], input);
+        slot.* = .{
+            .hash = hash,
+            .tag = tag,
+            .len = @intCast(input.len),
+            .occupied = true,
+            .result = result,
+        };
+    }
+
+    /// Drop every entry (counters are kept)
+    pub fn clear(self: *Self) void {
+        for (self.shards) |*shard| {
+            shard.mutex.lock();
+            defer shard.mutex.unlock();
+            @memset(shard.slots, .{});
+        }
+    }
+
+    /// Current counters
+    pub fn stats(self: *const Self) CacheStats {
+        return .{
+            .hits = self.hits.load(.monotonic),
+            .misses = self.misses.load(.monotonic),
+            .evictions = self.evictions.load(.monotonic),
+        };
+    }
+
+    /// Heap bytes owned, including the cache itself
+    pub fn memoryUsage(self: *const Self) usize {
+        const per_shard = self.slots_per_shard * (@sizeOf(Slot) + self.max_input_len);
+        return @sizeOf(Self) + self.shards.len * (@sizeOf(Shard) + per_shard);
+    }
+
+    fn locate(self: *Self, hash: u64) struct { *Shard, usize } {
+        const shard = &self.shards[hash % self.shards.len];
+        return .{ shard, (hash / self.shards.len) % self.slots_per_shard };
+    }
+
+    fn key(self: *const Self, shard: *Shard, index: usize) []u8 {
+        return shard.keys[index * self.max_input_len ..][0..self.max_input_len];
+    }
+
+    fn hashInput(tag: u64, input: []const u8) u64 {
+        return std.hash.Wyhash.hash(tag, input);
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "ResultCache: stores, hits and counts" {
+    const cache = try ResultCache.create(std.testing.allocator, .{ .max_bytes = 16 * 1024, .max_input_len = 32 });
+    defer cache.destroy();
+
+    try std.testing.expectEqual(@as(?CachedResult, null), cache.lookup("Mozilla/5.0"));
+    cache.store("Mozilla/5.0", .{ .matched = true, .start = 0 });
+
+    const hit = cache.lookup("Mozilla/5.0").?;
+    try std.testing.expect(hit.matched);
+    try std.testing.expectEqual(@as(?usize, 0), hit.start);
+    try std.testing.expectEqual(@as(?CachedResult, null), cache.lookup("Mozilla/4.0"));
+
+    const s = cache.stats();
+    try std.testing.expectEqual(@as(u64, 1), s.hits);
+    try std.testing.expectEqual(@as(u64, 2), s.misses);
+    try std.testing.expectApproxEqAbs(@as(f64, 1.0 / 3.0), s.hitRate(), 1e-9);
+}
+
+test "ResultCache: long inputs bypass the cache" {
+    const cache = try ResultCache.create(std.testing.allocator, .{ .max_bytes = 4096, .max_input_len = 4 });
+    defer cache.destroy();
+
+    cache.store("longer", .{ .matched = true });
+    try std.testing.expectEqual(@as(?CachedResult, null), cache.lookup("longer"));
+    try std.testing.expectEqual(@as(u64, 0), cache.stats().misses);
+}
+
+test "ResultCache: isMatch result keeps a recorded start" {
+    const cache = try ResultCache.create(std.testing.allocator, .{});
+    defer cache.destroy();
+
+    cache.store("GET /", .{ .matched = true, .start = 4 });
+    cache.store("GET /", .{ .matched = true });
+    try std.testing.expectEqual(@as(?usize, 4), cache.lookup("GET /").?.start);
+
+    cache.clear();
+    try std.testing.expectEqual(@as(?CachedResult, null), cache.lookup("GET /"));
+}
+
+test "ResultCache: stays within its size and evicts" {
+    const cache = try ResultCache.create(std.testing.allocator, .{ .max_bytes = 2048, .max_input_len = 8 });
+    defer cache.destroy();
+    try std.testing.expect(cache.memoryUsage() <= 2048);
+
+    // A few slots at most: 64 distinct inputs must collide
+    var buf: [8]u8 = undefined;
+    for (0..64) |i| cache.store(try std.fmt.bufPrint(&buf, "v{d}", .{i}), .{ .matched = true });
+    try std.testing.expect(cache.stats().evictions > 0);
+
+    const defaults = try ResultCache.create(std.testing.allocator, .{});
+    defer defaults.destroy();
+    try std.testing.expect(defaults.memoryUsage() <= (CacheConfig{}).max_bytes);
+}
+
+test "ResultCache: a budget below one slot stores nothing" {
+    const cache = try ResultCache.create(std.testing.allocator, .{ .max_bytes = 0 });
+    defer cache.destroy();
+
+    cache.store("GET /", .{ .matched = true });
+    try std.testing.expectEqual(@as(?CachedResult, null), cache.lookup("GET /"));
+    try std.testing.expectEqual(@as(usize, @sizeOf(ResultCache)), cache.memoryUsage());
+}
+
+test "ResultCache: tags keep results apart" {
+    const cache = try ResultCache.create(std.testing.allocator, .{});
+    defer cache.destroy();
+
+    cache.storeTagged(1, "GET /", .{ .matched = true });
+    cache.storeTagged(2, "GET /", .{ .matched = false });
+    try std.testing.expect(cache.lookupTagged(1, "GET /").?.matched);
+    try std.testing.expect(!cache.lookupTagged(2, "GET /").?.matched);
+    try std.testing.expectEqual(@as(?CachedResult, null), cache.lookup("GET /"));
+}
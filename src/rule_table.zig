@@ -0,0 +1,235 @@
+//! Hot-reloadable rule tables
+//!
+//! A RuleTable holds the current RegexSet behind an atomic pointer. Readers
+//! pin the current version without taking a lock; a writer compiles the
+//! replacement set off to the side, publishes it with a single atomic swap and
+//! reclaims the old set once every reader that could still see it has left.
+//!
+//! Reclamation uses a two-slot epoch scheme (userspace RCU style):
+//! - A reader loads the epoch, increments the reader counter for its parity
+//!   and then loads the set pointer. Three atomic operations, no retry loop.
+//! - A writer swaps the pointer, then runs two grace-period rounds. Each round
+//!   flips the epoch (new readers move to the other counter) and waits for
+//!   the counter of the previous parity to drain. After both rounds every
+//!   reader that could have loaded the old pointer is gone.
+//!
+//! Writers are serialized with a mutex; readers never touch it.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+const regex_mod = @import("regex.zig");
+const regex_set = @import("regex_set.zig");
+const compiler = @import("codegen/compiler.zig");
+
+const RegexSet = regex_set.RegexSet;
+const RegexError = regex_mod.RegexError;
+const PrepareOptions = regex_mod.PrepareOptions;
+const CompileOptions = compiler.CompileOptions;
+
+/// Atomically swappable RegexSet with wait-free readers
+pub const RuleTable = struct {
+    allocator: Allocator,
+
+    /// Currently published set
+    current: std.atomic.Value(*RegexSet),
+
+    /// Grace-period epoch; its low bit selects the reader counter
+    epoch: std.atomic.Value(usize),
+
+    /// Active readers per epoch parity
+    readers: [2]std.atomic.Value(usize),
+
+    /// Number of sets published so far (1 after init)
+    generation: std.atomic.Value(u64),
+
+    /// Serializes writers (update/deinit)
+    write_lock: std.Thread.Mutex,
+
+    const Self = @This();
+
+    /// A pinned view of the published set; call release() when done
+    pub const Reader = struct {
+        set: *const RegexSet,
+        counter: *std.atomic.Value(usize),
+
+        /// Unpin the set so a writer may reclaim it
+        pub fn release(self: Reader) void {
+            _ = self.counter.fetchSub(1, .release);
+        }
+    };
+
+    /// Create a table holding an initial set
+    /// The table must not be moved once readers or writers use it.
+    pub fn init(allocator: Allocator, patterns: []const []const u8, options: CompileOptions) RegexError!Self {
+        return initOwned(allocator, try createSet(allocator, patterns, options));
+    }
+
+    /// Create a table holding an already compiled set, taking ownership of it
+    /// (allocated with `allocator`). The table must not be moved once used.
+    pub fn initOwned(allocator: Allocator, set: *RegexSet) Self {
+        return .{
+            .allocator = allocator,
+            .current = std.atomic.Value(*RegexSet).init(set),
+            .epoch = std.atomic.Value(usize).init(0),
+            .readers = .{ std.atomic.Value(usize).init(0), std.atomic.Value(usize).init(0) },
+            .generation = std.atomic.Value(u64).init(1),
+            .write_lock = .{},
+        };
+    }
+
+    /// Free the table; no readers may be active
+    pub fn deinit(self: *Self) void {
+        const set = self.current.load(.acquire);
+        set.deinit();
+        self.allocator.destroy(set);
+    }
+
+    /// Pin the current set (wait-free)
+    pub fn acquire(self: *Self) Reader {
+        const slot = self.epoch.load(.seq_cst) & 1;
+        const counter = &self.readers[slot];
+        _ = counter.fetchAdd(1, .seq_cst);
+        return .{
+            .set = self.current.load(.seq_cst),
+            .counter = counter,
+        };
+    }
+
+    /// Compile a new set and publish it; on error the current set stays in place
+    pub fn update(self: *Self, patterns: []const []const u8, options: CompileOptions) RegexError!void {
+        // Compile outside the lock so concurrent readers and writers are not held up
+        const set = try createSet(self.allocator, patterns, options);
+        self.publish(set);
+    }
+
+    /// Publish an already compiled set (taking ownership) and reclaim the old one
+    pub fn publish(self: *Self, set: *RegexSet) void {
+        self.write_lock.lock();
+        defer self.write_lock.unlock();
+
+        const old = self.current.swap(set, .seq_cst);
+        _ = self.generation.fetchAdd(1, .release);
+
+        self.synchronize();
+
+        old.deinit();
+        self.allocator.destroy(old);
+    }
+
+    /// Prepare the rules of the current set (see Regex.prepare)
+    /// Sets published later by update() start unprepared.
+    pub fn prepare(self: *Self, options: PrepareOptions) RegexError!void {
+        const reader = self.acquire();
+        defer reader.release();
+        return reader.set.prepare(options);
+    }
+
+    /// Test whether any rule matches input
+    pub fn isMatch(self: *Self, input: []const u8) RegexError!bool {
+        const reader = self.acquire();
+        defer reader.release();
+        return reader.set.isMatch(input);
+    }
+
+    /// Write the ids of matching rules into `out`; see RegexSet.matchIds
+    pub fn matchIds(self: *Self, input: []const u8, out: []usize) RegexError!usize {
+        const reader = self.acquire();
+        defer reader.release();
+        return reader.set.matchIds(input, out);
+    }
+
+    /// Number of sets published so far
+    pub fn getGeneration(self: *Self) u64 {
+        return self.generation.load(.acquire);
+    }
+
+    /// Wait until every reader that could hold a pre-swap pointer has released it
+    fn synchronize(self: *Self) void {
+        for (0..2) |_| {
+            const old_epoch = self.epoch.fetchAdd(1, .seq_cst);
+            const counter = &self.readers[old_epoch & 1];
+            while (counter.load(.seq_cst) != 0) {
+                std.Thread.yield() catch {};
+            }
+        }
+    }
+
+    fn createSet(allocator: Allocator, patterns: []const []const u8, options: CompileOptions) RegexError!*RegexSet {
+        const set = try allocator.create(RegexSet);
+        errdefer allocator.destroy(set);
+        set.* = try RegexSet.compile(allocator, patterns, options);
+        return set;
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "RuleTable: update publishes new rules" {
+    const v1 = [_][]const u8{"alpha"};
+    var table = try RuleTable.init(std.testing.allocator, &v1, .{});
+    defer table.deinit();
+
+    try std.testing.expect(try table.isMatch("alpha"));
+    try std.testing.expect(!try table.isMatch("beta"));
+    try std.testing.expectEqual(@as(u64, 1), table.getGeneration());
+
+    const v2 = [_][]const u8{ "beta", "gamma" };
+    try table.update(&v2, .{});
+
+    try std.testing.expect(!try table.isMatch("alpha"));
+    var ids: [2]usize = undefined;
+    try std.testing.expectEqual(@as(usize, 1), try table.matchIds("gamma ray", &ids));
+    try std.testing.expectEqual(@as(usize, 1), ids[0]);
+    try std.testing.expectEqual(@as(u64, 2), table.getGeneration());
+}
+
+test "RuleTable: failed update keeps current set" {
+    const v1 = [_][]const u8{"alpha"};
+    var table = try RuleTable.init(std.testing.allocator, &v1, .{});
+    defer table.deinit();
+
+    const bad = [_][]const u8{"(alpha"};
+    try std.testing.expectError(error.UnexpectedToken, table.update(&bad, .{}));
+
+    try std.testing.expect(try table.isMatch("alpha"));
+    try std.testing.expectEqual(@as(u64, 1), table.getGeneration());
+}
+
+test "RuleTable: concurrent readers during updates" {
+    const v1 = [_][]const u8{ "foo", "ba+r" };
+    const v2 = [_][]const u8{ "foo", "qux" };
+
+    var table = try RuleTable.init(std.testing.allocator, &v1, .{});
+    defer table.deinit();
+
+    var stop = std.atomic.Value(bool).init(false);
+    var misses = std.atomic.Value(u64).init(0);
+
+    const Worker = struct {
+        fn run(t: *RuleTable, s: *std.atomic.Value(bool), m: *std.atomic.Value(u64)) void {
+            while (!s.load(.acquire)) {
+                // "foo" is in every version, so every read must see it
+                const matched = t.isMatch("xx foo xx") catch false;
+                if (!matched) _ = m.fetchAdd(1, .monotonic);
+            }
+        }
+    };
+
+    var threads: [4]std.Thread = undefined;
+    for (&threads) |*thread| {
+        thread.* = try std.Thread.spawn(.{}, Worker.run, .{ &table, &stop, &misses });
+    }
+
+    for (0..20) |i| {
+        try table.update(if (i % 2 == 0) &v2 else &v1, .{});
+    }
+
+    stop.store(true, .release);
+    for (threads) |thread| thread.join();
+
+    try std.testing.expectEqual(@as(u64, 0), misses.load(.monotonic));
+    try std.testing.expectEqual(@as(u64, 21), table.getGeneration());
+}
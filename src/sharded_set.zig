@@ -0,0 +1,407 @@
+//! Sharded regex sets
+//!
+//! A ShardedSet splits a very large rule list into shards that are evaluated
+//! concurrently on a worker pool. Rules are ordered by their prefilter literal
+//! (first byte of the required literal, rules without one last) before being
+//! cut into shards, so each shard carries a small first-byte table and can be
+//! skipped outright when the input contains none of those bytes.
+//!
+//! Two evaluation modes:
+//! - latency:    `matchBitmap` runs the shards of one input in parallel
+//! - throughput: `matchBitmapBatch` runs several inputs in parallel, each
+//!               input evaluating its shards serially on one worker
+//!
+//! Results are bitmaps with bit `i` set when rule `i` matches. Shards merge
+//! their hits into the shared bitmap with atomic ORs, so no per-shard buffers
+//! are needed.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+const regex_mod = @import("regex.zig");
+const regex_set = @import("regex_set.zig");
+const compiler = @import("codegen/compiler.zig");
+const BitSet256 = @import("utils/bitset.zig").BitSet256;
+
+const Regex = regex_mod.Regex;
+const RegexError = regex_mod.RegexError;
+const PrepareOptions = regex_mod.PrepareOptions;
+const ExecOptions = regex_mod.ExecOptions;
+const CacheConfig = regex_mod.CacheConfig;
+const RegexSet = regex_set.RegexSet;
+const CompileOptions = compiler.CompileOptions;
+
+/// Error set for sharded set operations
+pub const ShardError = RegexError || error{ThreadSpawnFailed};
+
+/// Sharding options
+pub const ShardOptions = struct {
+    /// Maximum number of rules per shard
+    max_shard_size: usize = 512,
+
+    /// Worker threads (0 = one per CPU)
+    n_jobs: usize = 0,
+};
+
+/// One shard: a RegexSet plus the data needed to skip it
+const Shard = struct {
+    set: RegexSet,
+
+    /// Global rule id of each member, parallel to set.regexes
+    ids: []usize,
+
+    /// First bytes of the members' prefilter literals
+    first_bytes: BitSet256,
+
+    /// Some member has no prefilter literal and must always run
+    always_run: bool,
+
+    /// Whether any member could match an input containing `input_bytes`
+    fn mayMatch(self: Shard, input_bytes: BitSet256) bool {
+        if (self.always_run) return true;
+        var common = self.first_bytes;
+        common.intersectWith(input_bytes);
+        return !common.isEmpty();
+    }
+
+    /// Run every member and OR the hits into bitmap
+    fn run(self: Shard, input: []const u8, bitmap: []u64) RegexError!void {
+        for (self.ids, 0..) |id, i| {
+            if (try self.set.matchesRule(i, input)) {
+                const bit = @as(u64, 1) << @intCast(id % 64);
+                _ = @atomicRmw(u64, &bitmap[id / 64], .Or, bit, .monotonic);
+            }
+        }
+    }
+};
+
+/// First error reported by a worker task
+const RunContext = struct {
+    mutex: std.Thread.Mutex = .{},
+    err: ?RegexError = null,
+
+    fn fail(self: *RunContext, err: RegexError) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        if (self.err == null) self.err = err;
+    }
+};
+
+/// Rule set partitioned into shards evaluated on a worker pool
+pub const ShardedSet = struct {
+    allocator: Allocator,
+    shards: []Shard,
+    rule_count: usize,
+
+    /// Heap allocated: workers keep a pointer to it
+    pool: *std.Thread.Pool,
+
+    const Self = @This();
+
+    /// Sort key: first byte of the prefilter literal, rules without one last
+    const NO_LITERAL: u16 = 256;
+
+    /// Compile every pattern and partition the rules into shards
+    pub fn compile(allocator: Allocator, patterns: []const []const u8, options: CompileOptions, shard_options: ShardOptions) ShardError!Self {
+        const max_shard_size = @max(shard_options.max_shard_size, 1);
+
+        const pool = try allocator.create(std.Thread.Pool);
+        errdefer allocator.destroy(pool);
+        pool.init(.{
+            .allocator = allocator,
+            .n_jobs = if (shard_options.n_jobs == 0) null else shard_options.n_jobs,
+        }) catch |err| switch (err) {
+            error.OutOfMemory => return error.OutOfMemory,
+            else => return error.ThreadSpawnFailed,
+        };
+        errdefer pool.deinit();
+
+        // Phase 1: compile every rule
+        const regexes = try allocator.alloc(Regex, patterns.len);
+        defer allocator.free(regexes);
+        const owned = try allocator.alloc([]u8, patterns.len);
+        defer allocator.free(owned);
+
+        var compiled: usize = 0;
+        errdefer for (0..compiled) |i| {
+            regexes[i].deinit();
+            allocator.free(owned[i]);
+        };
+
+        for (patterns, 0..) |pattern, i| {
+            owned[i] = try allocator.dupe(u8, pattern);
+            regexes[i] = Regex.compileWithOptions(allocator, owned[i], options) catch |err| {
+                allocator.free(owned[i]);
+                return err;
+            };
+            compiled += 1;
+        }
+
+        // Phase 2: order rules by prefilter literal
+        const order = try allocator.alloc(usize, patterns.len);
+        defer allocator.free(order);
+        for (order, 0..) |*slot, i| slot.* = i;
+        std.mem.sort(usize, order, regexes, lessByLiteral);
+
+        // Phase 3: allocate shard storage (everything fallible happens here)
+        const shard_count = (patterns.len + max_shard_size - 1) / max_shard_size;
+        const shards = try allocator.alloc(Shard, shard_count);
+        errdefer allocator.free(shards);
+
+        var allocated: usize = 0;
+        errdefer for (shards[0..allocated]) |shard| {
+            allocator.free(shard.set.regexes);
+            allocator.free(shard.set.patterns);
+            allocator.free(shard.ids);
+        };
+
+        for (shards, 0..) |*shard, s| {
+            const size = @min(max_shard_size, patterns.len - s * max_shard_size);
+            const shard_regexes = try allocator.alloc(Regex, size);
+            errdefer allocator.free(shard_regexes);
+            const shard_patterns = try allocator.alloc([]u8, size);
+            errdefer allocator.free(shard_patterns);
+            const ids = try allocator.alloc(usize, size);
+
+            shard.* = .{
+                .set = RegexSet.initOwned(allocator, shard_regexes, shard_patterns),
+                .ids = ids,
+                .first_bytes = BitSet256.init(),
+                .always_run = false,
+            };
+            allocated += 1;
+        }
+
+        // Phase 4: move the compiled rules into their shards (infallible)
+        for (order, 0..) |rule, position| {
+            const shard = &shards[position / max_shard_size];
+            const slot = position % max_shard_size;
+
+            shard.set.regexes[slot] = regexes[rule];
+            shard.set.patterns[slot] = owned[rule];
+            shard.ids[slot] = rule;
+
+            if (regexes[rule].compiled.prefilter) |literal| {
+                shard.first_bytes.set(literal[0]);
+            } else {
+                shard.always_run = true;
+            }
+        }
+
+        return .{
+            .allocator = allocator,
+            .shards = shards,
+            .rule_count = patterns.len,
+            .pool = pool,
+        };
+    }
+
+    /// Stop the workers and free every shard
+    pub fn deinit(self: *Self) void {
+        self.pool.deinit();
+        self.allocator.destroy(self.pool);
+
+        for (self.shards) |shard| {
+            shard.set.deinit();
+            self.allocator.free(shard.ids);
+        }
+        self.allocator.free(self.shards);
+    }
+
+    /// Apply the execution limits `options` to every rule
+    /// Call before sharing the set between threads.
+    pub fn setExecOptions(self: *const Self, options: ExecOptions) void {
+        for (self.shards) |shard| shard.set.setExecOptions(options);
+    }
+
+    /// Cache rule results for repeated short inputs, one cache per shard (see
+    /// RegexSet.enableCache); `config.max_bytes` is split between the shards.
+    /// Call before sharing the set between threads.
+    pub fn enableCache(self: *Self, config: CacheConfig) Allocator.Error!void {
+        var shard_config = config;
+        shard_config.max_bytes = config.max_bytes / @max(self.shards.len, 1);
+        for (self.shards) |*shard| try shard.set.enableCache(shard_config);
+    }
+
+    /// Number of rules in the set
+    pub fn len(self: Self) usize {
+        return self.rule_count;
+    }
+
+    /// Number of shards the rules were split into
+    pub fn shardCount(self: Self) usize {
+        return self.shards.len;
+    }
+
+    /// Number of u64 words in a match bitmap
+    pub fn bitmapWords(self: Self) usize {
+        return (self.rule_count + 63) / 64;
+    }
+
+    /// Prepare every rule (see Regex.prepare), one shard per worker
+    pub fn prepare(self: *const Self, options: PrepareOptions) RegexError!void {
+        var ctx: RunContext = .{};
+        var wg: std.Thread.WaitGroup = .{};
+
+        for (self.shards) |*shard| {
+            self.pool.spawnWg(&wg, prepareShard, .{ shard, options, &ctx });
+        }
+        self.pool.waitAndWork(&wg);
+
+        if (ctx.err) |err| return err;
+    }
+
+    /// Latency mode: evaluate the shards for one input in parallel
+    /// `bitmap` must hold at least bitmapWords() words; it is cleared first.
+    pub fn matchBitmap(self: *const Self, input: []const u8, bitmap: []u64) RegexError!void {
+        const words = self.bitmapWords();
+        std.debug.assert(bitmap.len >= words);
+        @memset(bitmap[0..words], 0);
+
+        const input_bytes = byteSet(input);
+        var ctx: RunContext = .{};
+        var wg: std.Thread.WaitGroup = .{};
+
+        for (self.shards) |*shard| {
+            if (!shard.mayMatch(input_bytes)) continue;
+            self.pool.spawnWg(&wg, runShard, .{ shard, input, bitmap, &ctx });
+        }
+        self.pool.waitAndWork(&wg);
+
+        if (ctx.err) |err| return err;
+    }
+
+    /// Throughput mode: evaluate several inputs in parallel
+    /// `bitmaps` holds one bitmap of bitmapWords() words per input, back to back.
+    pub fn matchBitmapBatch(self: *const Self, inputs: []const []const u8, bitmaps: []u64) RegexError!void {
+        const words = self.bitmapWords();
+        std.debug.assert(bitmaps.len >= inputs.len * words);
+
+        var ctx: RunContext = .{};
+        var wg: std.Thread.WaitGroup = .{};
+
+        for (inputs, 0..) |input, i| {
+            self.pool.spawnWg(&wg, runInput, .{ self, input, bitmaps[i * words ..][0..words], &ctx });
+        }
+        self.pool.waitAndWork(&wg);
+
+        if (ctx.err) |err| return err;
+    }
+
+    /// Evaluate every shard for one input on the calling thread
+    pub fn matchBitmapSerial(self: *const Self, input: []const u8, bitmap: []u64) RegexError!void {
+        const words = self.bitmapWords();
+        std.debug.assert(bitmap.len >= words);
+        @memset(bitmap[0..words], 0);
+
+        const input_bytes = byteSet(input);
+        for (self.shards) |shard| {
+            if (!shard.mayMatch(input_bytes)) continue;
+            try shard.run(input, bitmap);
+        }
+    }
+
+    fn runShard(shard: *const Shard, input: []const u8, bitmap: []u64, ctx: *RunContext) void {
+        shard.run(input, bitmap) catch |err| ctx.fail(err);
+    }
+
+    fn prepareShard(shard: *const Shard, options: PrepareOptions, ctx: *RunContext) void {
+        shard.set.prepare(options) catch |err| ctx.fail(err);
+    }
+
+    fn runInput(self: *const Self, input: []const u8, bitmap: []u64, ctx: *RunContext) void {
+        self.matchBitmapSerial(input, bitmap) catch |err| ctx.fail(err);
+    }
+
+    fn literalKey(re: Regex) u16 {
+        const literal = re.compiled.prefilter orelse return NO_LITERAL;
+        return literal[0];
+    }
+
+    fn lessByLiteral(regexes: []Regex, a: usize, b: usize) bool {
+        return literalKey(regexes[a]) < literalKey(regexes[b]);
+    }
+
+    /// Set of bytes present in input
+    fn byteSet(input: []const u8) BitSet256 {
+        var bytes = BitSet256.init();
+        for (input) |c| bytes.set(c);
+        return bytes;
+    }
+};
+
+/// Test whether rule `id` is set in a match bitmap
+pub fn bitmapIsSet(bitmap: []const u64, id: usize) bool {
+    return ((bitmap[id / 64] >> @intCast(id % 64)) & 1) != 0;
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "ShardedSet: partitions rules by prefilter literal" {
+    const patterns = [_][]const u8{ "apple", "[0-9]+", "avocado", "banana", "blueberry", "a.*z" };
+    var set = try ShardedSet.compile(std.testing.allocator, &patterns, .{}, .{ .max_shard_size = 2, .n_jobs = 2 });
+    defer set.deinit();
+
+    try std.testing.expectEqual(@as(usize, 6), set.len());
+    try std.testing.expectEqual(@as(usize, 3), set.shardCount());
+
+    // Rules starting with 'a' come first, the literal-free rule is last
+    try std.testing.expect(set.shards[0].first_bytes.isSet('a'));
+    try std.testing.expect(!set.shards[0].always_run);
+    try std.testing.expect(set.shards[2].always_run);
+}
+
+test "ShardedSet: latency mode matches serial evaluation" {
+    const patterns = [_][]const u8{ "apple", "[0-9]+", "avocado", "banana", "blueberry", "a.*z" };
+    var set = try ShardedSet.compile(std.testing.allocator, &patterns, .{}, .{ .max_shard_size = 2, .n_jobs = 2 });
+    defer set.deinit();
+
+    var parallel: [1]u64 = undefined;
+    var serial: [1]u64 = undefined;
+
+    try set.matchBitmap("banana split 42", &parallel);
+    try set.matchBitmapSerial("banana split 42", &serial);
+
+    try std.testing.expectEqual(serial[0], parallel[0]);
+    try std.testing.expect(bitmapIsSet(&parallel, 1));
+    try std.testing.expect(bitmapIsSet(&parallel, 3));
+    try std.testing.expect(!bitmapIsSet(&parallel, 0));
+}
+
+test "ShardedSet: throughput mode" {
+    const patterns = [_][]const u8{ "cat", "dog", "[0-9]" };
+    var set = try ShardedSet.compile(std.testing.allocator, &patterns, .{}, .{ .max_shard_size = 1, .n_jobs = 2 });
+    defer set.deinit();
+
+    const inputs = [_][]const u8{ "a cat", "hot dog 7", "nothing" };
+    var bitmaps: [3]u64 = undefined;
+    try set.matchBitmapBatch(&inputs, &bitmaps);
+
+    try std.testing.expectEqual(@as(u64, 0b001), bitmaps[0]);
+    try std.testing.expectEqual(@as(u64, 0b110), bitmaps[1]);
+    try std.testing.expectEqual(@as(u64, 0), bitmaps[2]);
+}
+
+test "ShardedSet: result cache stays within its budget" {
+    const patterns = [_][]const u8{ "cat", "dog", "[0-9]" };
+    var set = try ShardedSet.compile(std.testing.allocator, &patterns, .{}, .{ .max_shard_size = 1, .n_jobs = 2 });
+    defer set.deinit();
+    try set.enableCache(.{ .max_bytes = 12 * 1024, .max_input_len = 32 });
+
+    var bitmap: [1]u64 = undefined;
+    for (0..2) |_| {
+        try set.matchBitmapSerial("hot dog 7", &bitmap);
+        try std.testing.expectEqual(@as(u64, 0b110), bitmap[0]);
+    }
+
+    var bytes: usize = 0;
+    var hits: u64 = 0;
+    for (set.shards) |shard| {
+        bytes += shard.set.cache.?.memoryUsage();
+        hits += shard.set.cacheStats().?.hits;
+    }
+    try std.testing.expect(bytes <= 12 * 1024);
+    try std.testing.expect(hits > 0);
+}
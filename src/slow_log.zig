@@ -0,0 +1,295 @@
+//! Slow-match log
+//!
+//! A process-wide record of searches that exceeded a step or latency
+//! threshold, so a ReDoS incident leaves behind the pattern and input that
+//! caused it instead of only CPU saturation.
+//!
+//! Entries go into a fixed-size ring buffer (bounded MPSC queue with per-slot
+//! sequence numbers, after Vyukov):
+//! - Any number of matching threads push without locking. A push claims a
+//!   slot with one CAS on `head`, fills it and publishes it by storing the
+//!   slot's sequence number. A full ring drops the entry and counts it.
+//! - A single consumer drains published slots in order. drain() holds a mutex
+//!   only to keep concurrent drain callers from acting as two consumers;
+//!   producers never touch it.
+//!
+//! Logging is off until a threshold is configured. While off, a search pays
+//! one relaxed load (see probe.zig).
+
+const std = @import("std");
+const exec_stats = @import("executor/exec_stats.zig");
+
+const Engine = exec_stats.Engine;
+
+/// Number of entries the ring holds (power of two)
+pub const CAPACITY = 1024;
+
+/// Maximum number of input bytes kept per entry
+pub const SAMPLE_CAPACITY = 64;
+
+/// One slow search
+pub const SlowEntry = struct {
+    /// Regex.id of the pattern
+    pattern_id: u64,
+
+    /// Length of the searched input in bytes
+    input_len: u64,
+
+    /// Instructions executed by the search
+    steps: u64,
+
+    /// Wall-clock duration in nanoseconds
+    duration_ns: u64,
+
+    /// Engine that ran the search
+    engine: Engine,
+
+    /// Bytes of `sample` in use
+    sample_len: u8,
+
+    /// Leading bytes of the input (up to the configured sample size)
+    sample: [SAMPLE_CAPACITY]u8,
+
+    /// Sampled input prefix
+    pub fn getSample(self: *const SlowEntry) []const u8 {
+        return self.sample[0..self.sample_len];
+    }
+};
+
+/// What counts as slow (a zero threshold is disabled)
+pub const SlowLogConfig = struct {
+    /// Record searches executing at least this many steps
+    step_threshold: u64 = 0,
+
+    /// Record searches taking at least this long
+    latency_threshold_ns: u64 = 0,
+
+    /// Input bytes to copy into each entry (clamped to SAMPLE_CAPACITY)
+    sample_bytes: usize = 0,
+};
+
+const Slot = struct {
+    sequence: std.atomic.Value(usize),
+    entry: SlowEntry,
+};
+
+/// Bounded lock-free ring of slow searches
+pub const SlowLog = struct {
+    slots: [CAPACITY]Slot,
+
+    /// Next position producers claim
+    head: std.atomic.Value(usize),
+
+    /// Next position the consumer reads (guarded by drain_lock)
+    tail: usize,
+
+    /// Makes drain() the single consumer
+    drain_lock: std.Thread.Mutex,
+
+    /// Entries lost because the ring was full
+    dropped: std.atomic.Value(u64),
+
+    /// Some threshold is set (the only field a search reads while logging is off)
+    enabled: std.atomic.Value(bool),
+
+    step_threshold: std.atomic.Value(u64),
+    latency_threshold_ns: std.atomic.Value(u64),
+    sample_bytes: std.atomic.Value(usize),
+
+    const Self = @This();
+
+    /// Empty, disabled log (usable at comptime for the global instance)
+    pub fn init() Self {
+        @setEvalBranchQuota(4 * CAPACITY);
+        var slots: [CAPACITY]Slot = undefined;
+        for (&slots, 0..) |*slot, i| {
+            slot.* = .{ .sequence = std.atomic.Value(usize).init(i), .entry = undefined };
+        }
+        return .{
+            .slots = slots,
+            .head = std.atomic.Value(usize).init(0),
+            .tail = 0,
+            .drain_lock = .{},
+            .dropped = std.atomic.Value(u64).init(0),
+            .enabled = std.atomic.Value(bool).init(false),
+            .step_threshold = std.atomic.Value(u64).init(0),
+            .latency_threshold_ns = std.atomic.Value(u64).init(0),
+            .sample_bytes = std.atomic.Value(usize).init(0),
+        };
+    }
+
+    /// Set the thresholds; all-zero thresholds disable logging
+    pub fn configure(self: *Self, config: SlowLogConfig) void {
+        self.sample_bytes.store(@min(config.sample_bytes, SAMPLE_CAPACITY), .monotonic);
+        self.step_threshold.store(config.step_threshold, .monotonic);
+        self.latency_threshold_ns.store(config.latency_threshold_ns, .monotonic);
+        self.enabled.store(config.step_threshold != 0 or config.latency_threshold_ns != 0, .monotonic);
+    }
+
+    /// Whether any threshold is set
+    pub fn isEnabled(self: *const Self) bool {
+        return self.enabled.load(.monotonic);
+    }
+
+    /// Whether a search with these costs crosses a threshold
+    pub fn isSlow(self: *const Self, steps: u64, duration_ns: u64) bool {
+        const step_threshold = self.step_threshold.load(.monotonic);
+        const latency_threshold = self.latency_threshold_ns.load(.monotonic);
+        return (step_threshold != 0 and steps >= step_threshold) or
+            (latency_threshold != 0 and duration_ns >= latency_threshold);
+    }
+
+    /// Append an entry; returns false (and counts a drop) when the ring is full
+    pub fn push(self: *Self, entry: SlowEntry) bool {
+        var pos = self.head.load(.monotonic);
+        while (true) {
+            const slot = &self.slots[pos % CAPACITY];
+            const seq = slot.sequence.load(.acquire);
+            const diff = @as(isize, @bitCast(seq -% pos));
+
+            if (diff == 0) {
+                // Slot is free for this position; claim it
+                if (self.head.cmpxchgWeak(pos, pos +% 1, .monotonic, .monotonic)) |current| {
+                    pos = current;
+                    continue;
+                }
+                slot.entry = entry;
+                slot.sequence.store(pos +% 1, .release);
+                return true;
+            } else if (diff < 0) {
+                // Consumer has not freed this slot yet: ring is full
+                _ = self.dropped.fetchAdd(1, .monotonic);
+                return false;
+            } else {
+                // Another producer claimed this position; reload
+                pos = self.head.load(.monotonic);
+            }
+        }
+    }
+
+    /// Move up to out.len published entries into `out`, oldest first
+    pub fn drain(self: *Self, out: []SlowEntry) usize {
+        self.drain_lock.lock();
+        defer self.drain_lock.unlock();
+
+        var count: usize = 0;
+        while (count < out.len) {
+            const pos = self.tail;
+            const slot = &self.slots[pos % CAPACITY];
+            if (slot.sequence.load(.acquire) != pos +% 1) break;
+
+            out[count] = slot.entry;
+            count += 1;
+
+            // Hand the slot back to producers for the next lap
+            slot.sequence.store(pos +% CAPACITY, .release);
+            self.tail = pos +% 1;
+        }
+        return count;
+    }
+
+    /// Entries lost to a full ring since startup
+    pub fn droppedCount(self: *const Self) u64 {
+        return self.dropped.load(.monotonic);
+    }
+
+    /// Build and push an entry for a finished search
+    pub fn record(self: *Self, pattern_id: u64, input: []const u8, steps: u64, duration_ns: u64, engine: Engine) void {
+        var entry = SlowEntry{
+            .pattern_id = pattern_id,
+            .input_len = input.len,
+            .steps = steps,
+            .duration_ns = duration_ns,
+            .engine = engine,
+            .sample_len = 0,
+            .sample = undefined,
+        };
+        const sample_len = @min(input.len, self.sample_bytes.load(.monotonic));
+        @memcpy(entry.sample[0..sample_len], input[0..sample_len]);
+        entry.sample_len = @intCast(sample_len);
+
+        _ = self.push(entry);
+    }
+};
+
+/// Process-wide slow-match log used by Regex
+pub var global: SlowLog = SlowLog.init();
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "SlowLog: push and drain in order" {
+    const log = try std.testing.allocator.create(SlowLog);
+    defer std.testing.allocator.destroy(log);
+    log.* = SlowLog.init();
+    log.configure(.{ .step_threshold = 10, .sample_bytes = 4 });
+
+    log.record(1, "aaaaaaaa!", 50, 0, .backtrack);
+    log.record(2, "xy", 20, 0, .backtrack);
+
+    var out: [4]SlowEntry = undefined;
+    try std.testing.expectEqual(@as(usize, 2), log.drain(&out));
+    try std.testing.expectEqual(@as(u64, 1), out[0].pattern_id);
+    try std.testing.expectEqual(@as(u64, 9), out[0].input_len);
+    try std.testing.expectEqualStrings("aaaa", out[0].getSample());
+    try std.testing.expectEqualStrings("xy", out[1].getSample());
+
+    try std.testing.expectEqual(@as(usize, 0), log.drain(&out));
+}
+
+test "SlowLog: configure toggles enabled" {
+    const log = try std.testing.allocator.create(SlowLog);
+    defer std.testing.allocator.destroy(log);
+    log.* = SlowLog.init();
+    try std.testing.expect(!log.isEnabled());
+
+    log.configure(.{ .latency_threshold_ns = 1000 });
+    try std.testing.expect(log.isEnabled());
+
+    log.configure(.{ .sample_bytes = 8 });
+    try std.testing.expect(!log.isEnabled());
+}
+
+test "SlowLog: full ring drops and recovers" {
+    const log = try std.testing.allocator.create(SlowLog);
+    defer std.testing.allocator.destroy(log);
+    log.* = SlowLog.init();
+    log.configure(.{ .step_threshold = 1 });
+
+    for (0..CAPACITY + 3) |i| log.record(i, "", 1, 0, .backtrack);
+    try std.testing.expectEqual(@as(u64, 3), log.droppedCount());
+
+    var out: [CAPACITY]SlowEntry = undefined;
+    try std.testing.expectEqual(@as(usize, CAPACITY), log.drain(&out));
+    try std.testing.expectEqual(@as(u64, CAPACITY - 1), out[CAPACITY - 1].pattern_id);
+
+    // Slots are reusable after a drain
+    log.record(7, "", 1, 0, .backtrack);
+    try std.testing.expectEqual(@as(usize, 1), log.drain(out[0..1]));
+    try std.testing.expectEqual(@as(u64, 7), out[0].pattern_id);
+}
+
+test "SlowLog: concurrent producers" {
+    const log = try std.testing.allocator.create(SlowLog);
+    defer std.testing.allocator.destroy(log);
+    log.* = SlowLog.init();
+    log.configure(.{ .step_threshold = 1 });
+
+    const per_thread = 200;
+    const Producer = struct {
+        fn run(l: *SlowLog, id: u64) void {
+            for (0..per_thread) |_| l.record(id, "", 1, 0, .backtrack);
+        }
+    };
+
+    var threads: [4]std.Thread = undefined;
+    for (&threads, 0..) |*thread, i| {
+        thread.* = try std.Thread.spawn(.{}, Producer.run, .{ log, i });
+    }
+    for (threads) |thread| thread.join();
+
+    var out: [CAPACITY]SlowEntry = undefined;
+    try std.testing.expectEqual(@as(usize, 4 * per_thread), log.drain(&out));
+    try std.testing.expectEqual(@as(u64, 0), log.droppedCount());
+}
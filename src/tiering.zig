@@ -0,0 +1,273 @@
+//! Tiered execution
+//!
+//! Every Regex starts out in the cheapest form: bytecode run by the
+//! interpreter, which decodes each instruction as it goes. A regex counts
+//! its calls and the input bytes it is given; once either count crosses the
+//! process-wide threshold, a background thread builds the next tier (a
+//! pre-decoded program, see executor/decoded.zig) and publishes it with a
+//! release store. Searches already in flight keep their tier; later searches
+//! pick up the new one. Cold regexes never pay for the larger artifact.
+//!
+//! Tiering is off until a threshold is configured. Only regexes compiled
+//! while it is on (or prepared, see Regex.prepare) get a TierState; the
+//! others pay neither its allocation nor any per-search check. Once a regex
+//! has been promoted (or is being promoted) it stops counting, so hot
+//! regexes do not contend on their counters.
+//!
+//! The promotion thread allocates with the regex's allocator, which must
+//! therefore be thread-safe while tiering is enabled.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const decoded_mod = @import("executor/decoded.zig");
+const format = @import("bytecode/format.zig");
+
+const DecodedProgram = decoded_mod.DecodedProgram;
+const Instruction = format.Instruction;
+
+/// Execution tier of a regex
+pub const Tier = enum(u8) {
+    /// Bytecode decoded on every step
+    interpreted = 0,
+
+    /// Pre-decoded instruction table
+    decoded = 1,
+};
+
+/// When a regex counts as hot (a zero threshold is disabled)
+pub const TierConfig = struct {
+    /// Promote after this many calls
+    call_threshold: u64 = 0,
+
+    /// Promote after this many input bytes
+    byte_threshold: u64 = 0,
+};
+
+/// Process-wide promotion thresholds
+pub const TierPolicy = struct {
+    call_threshold: std.atomic.Value(u64),
+    byte_threshold: std.atomic.Value(u64),
+
+    const Self = @This();
+
+    /// Disabled policy (usable at comptime for the global instance)
+    pub fn init() Self {
+        return .{
+            .call_threshold = std.atomic.Value(u64).init(0),
+            .byte_threshold = std.atomic.Value(u64).init(0),
+        };
+    }
+
+    /// Set the thresholds; all-zero thresholds disable promotion
+    pub fn configure(self: *Self, config: TierConfig) void {
+        self.call_threshold.store(config.call_threshold, .monotonic);
+        self.byte_threshold.store(config.byte_threshold, .monotonic);
+    }
+
+    /// Whether any threshold is set
+    pub fn isEnabled(self: *const Self) bool {
+        return self.call_threshold.load(.monotonic) != 0 or self.byte_threshold.load(.monotonic) != 0;
+    }
+
+    /// Whether these totals make a regex hot
+    pub fn isHot(self: *const Self, calls: u64, bytes: u64) bool {
+        const call_threshold = self.call_threshold.load(.monotonic);
+        const byte_threshold = self.byte_threshold.load(.monotonic);
+        return (call_threshold != 0 and calls >= call_threshold) or
+            (byte_threshold != 0 and bytes >= byte_threshold);
+    }
+};
+
+/// Process-wide policy used by Regex
+pub var policy: TierPolicy = TierPolicy.init();
+
+const State = enum(u8) {
+    /// Counting; no artifact yet
+    cold,
+
+    /// A promotion thread is building the next tier
+    building,
+
+    /// `decoded` is published
+    hot,
+
+    /// Promotion failed (out of memory, no thread); stay interpreted
+    failed,
+};
+
+/// Hotness counters and promoted artifacts of one regex
+pub const TierState = struct {
+    allocator: Allocator,
+    calls: std.atomic.Value(u64),
+    bytes: std.atomic.Value(u64),
+    state: std.atomic.Value(State),
+
+    /// Valid once state is .hot (published with release)
+    decoded: ?DecodedProgram = null,
+
+    /// Background promotion started by recordUse; joined by destroy
+    promotion: ?std.Thread = null,
+
+    const Self = @This();
+
+    /// Allocate cold state
+    pub fn create(allocator: Allocator) Allocator.Error!*Self {
+        const self = try allocator.create(Self);
+        self.* = .{
+            .allocator = allocator,
+            .calls = std.atomic.Value(u64).init(0),
+            .bytes = std.atomic.Value(u64).init(0),
+            .state = std.atomic.Value(State).init(.cold),
+        };
+        return self;
+    }
+
+    /// Join a running promotion, then free everything
+    pub fn destroy(self: *Self) void {
+        if (self.promotion) |thread| thread.join();
+        if (self.decoded) |decoded| decoded.deinit();
+        self.allocator.destroy(self);
+    }
+
+    /// Count one call over `input_len` bytes and start a promotion once hot
+    pub fn recordUse(self: *Self, tier_policy: *const TierPolicy, bytecode: []const u8, input_len: usize) void {
+        if (self.state.load(.monotonic) != .cold) return;
+        if (!tier_policy.isEnabled()) return;
+
+        const calls = self.calls.fetchAdd(1, .monotonic) + 1;
+        const bytes = self.bytes.fetchAdd(input_len, .monotonic) + input_len;
+        if (!tier_policy.isHot(calls, bytes)) return;
+
+        // Exactly one caller wins the promotion
+        if (self.state.cmpxchgStrong(.cold, .building, .monotonic, .monotonic) != null) return;
+
+        self.promotion = std.Thread.spawn(.{}, promote, .{ self, bytecode }) catch {
+            self.state.store(.failed, .release);
+            return;
+        };
+    }
+
+    /// Promote on the calling thread now, regardless of hotness (see Regex.prepare)
+    /// Waits if a promotion is already running; retries one that failed.
+    pub fn promoteNow(self: *Self, bytecode: []const u8) !void {
+        while (true) {
+            const current = self.state.load(.acquire);
+            switch (current) {
+                .hot => return,
+                .building => self.waitForPromotion(),
+                .cold, .failed => {
+                    if (self.state.cmpxchgStrong(current, .building, .monotonic, .monotonic) != null) continue;
+                    const decoded = DecodedProgram.init(self.allocator, bytecode) catch |err| {
+                        self.state.store(.failed, .release);
+                        return err;
+                    };
+                    self.decoded = decoded;
+                    self.state.store(.hot, .release);
+                    return;
+                },
+            }
+        }
+    }
+
+    /// Build the pre-decoded program (runs on the promotion thread)
+    fn promote(self: *Self, bytecode: []const u8) void {
+        const decoded = DecodedProgram.init(self.allocator, bytecode) catch {
+            self.state.store(.failed, .release);
+            return;
+        };
+        self.decoded = decoded;
+        self.state.store(.hot, .release);
+    }
+
+    /// Pre-decoded instructions, once promoted
+    pub fn decodedProgram(self: *const Self) ?[]const ?Instruction {
+        if (self.state.load(.acquire) != .hot) return null;
+        return self.decoded.?.insts;
+    }
+
+    /// Current tier
+    pub fn tier(self: *const Self) Tier {
+        return if (self.state.load(.acquire) == .hot) .decoded else .interpreted;
+    }
+
+    /// Heap bytes owned, including the state itself
+    pub fn memoryUsage(self: *const Self) usize {
+        var bytes: usize = @sizeOf(Self);
+        if (self.state.load(.acquire) == .hot) bytes += self.decoded.?.memoryUsage();
+        return bytes;
+    }
+
+    /// Block until a running promotion has finished (for tests and benchmarks)
+    pub fn waitForPromotion(self: *const Self) void {
+        while (self.state.load(.acquire) == .building) std.Thread.yield() catch {};
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "TierState: disabled policy never promotes" {
+    var tier_policy = TierPolicy.init();
+    const state = try TierState.create(std.testing.allocator);
+    defer state.destroy();
+
+    for (0..100) |_| state.recordUse(&tier_policy, "\x00", 10);
+    try std.testing.expectEqual(Tier.interpreted, state.tier());
+    try std.testing.expectEqual(@as(u64, 0), state.calls.load(.monotonic));
+}
+
+test "TierState: promotes after the call threshold" {
+    const compiler = @import("codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "a+b");
+    defer compiled.deinit();
+
+    var tier_policy = TierPolicy.init();
+    tier_policy.configure(.{ .call_threshold = 3 });
+
+    const state = try TierState.create(std.testing.allocator);
+    defer state.destroy();
+
+    state.recordUse(&tier_policy, compiled.bytecode, 1);
+    state.recordUse(&tier_policy, compiled.bytecode, 1);
+    try std.testing.expectEqual(Tier.interpreted, state.tier());
+
+    state.recordUse(&tier_policy, compiled.bytecode, 1);
+    state.waitForPromotion();
+    try std.testing.expectEqual(Tier.decoded, state.tier());
+    try std.testing.expect(state.decodedProgram().?.len == compiled.bytecode.len);
+}
+
+test "TierState: promoteNow ignores the policy" {
+    const compiler = @import("codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "a|b");
+    defer compiled.deinit();
+
+    const state = try TierState.create(std.testing.allocator);
+    defer state.destroy();
+
+    try state.promoteNow(compiled.bytecode);
+    try std.testing.expectEqual(Tier.decoded, state.tier());
+
+    // Idempotent
+    try state.promoteNow(compiled.bytecode);
+    try std.testing.expectEqual(Tier.decoded, state.tier());
+}
+
+test "TierState: promotes after the byte threshold" {
+    const compiler = @import("codegen/compiler.zig");
+    const compiled = try compiler.compileSimple(std.testing.allocator, "x");
+    defer compiled.deinit();
+
+    var tier_policy = TierPolicy.init();
+    tier_policy.configure(.{ .byte_threshold = 1000 });
+
+    const state = try TierState.create(std.testing.allocator);
+    defer state.destroy();
+
+    state.recordUse(&tier_policy, compiled.bytecode, 999);
+    try std.testing.expectEqual(Tier.interpreted, state.tier());
+    state.recordUse(&tier_policy, compiled.bytecode, 1);
+    state.waitForPromotion();
+    try std.testing.expectEqual(Tier.decoded, state.tier());
+}
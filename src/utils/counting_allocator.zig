@@ -0,0 +1,160 @@
+//! Counting allocator
+//!
+//! Wraps another allocator and keeps running totals of the bytes and
+//! allocations it currently holds, plus the high-water mark and totals since
+//! startup, so the library can report its memory footprint and traffic.
+//! Counters are atomic: the wrapper is as thread-safe as the allocator it
+//! wraps.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const Alignment = std.mem.Alignment;
+
+/// Snapshot of a CountingAllocator's counters
+pub const AllocStats = struct {
+    /// Bytes currently allocated
+    live_bytes: usize,
+
+    /// Highest value live_bytes has reached
+    peak_bytes: usize,
+
+    /// Allocations not yet freed
+    live_allocations: usize,
+
+    /// Allocations made since startup
+    total_allocations: u64,
+
+    /// Bytes allocated since startup, including growth in place
+    total_bytes: u64,
+};
+
+/// Allocator wrapper that tracks live and peak usage
+pub const CountingAllocator = struct {
+    child: Allocator,
+    live_bytes: std.atomic.Value(usize),
+    peak_bytes: std.atomic.Value(usize),
+    live_allocations: std.atomic.Value(usize),
+    total_allocations: std.atomic.Value(u64),
+    total_bytes: std.atomic.Value(u64),
+
+    const Self = @This();
+
+    /// Wrap `child` (usable at comptime for a global instance)
+    pub fn init(child: Allocator) Self {
+        return .{
+            .child = child,
+            .live_bytes = std.atomic.Value(usize).init(0),
+            .peak_bytes = std.atomic.Value(usize).init(0),
+            .live_allocations = std.atomic.Value(usize).init(0),
+            .total_allocations = std.atomic.Value(u64).init(0),
+            .total_bytes = std.atomic.Value(u64).init(0),
+        };
+    }
+
+    /// Allocator interface that counts into this wrapper
+    pub fn allocator(self: *Self) Allocator {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .alloc = alloc,
+                .resize = resize,
+                .remap = remap,
+                .free = free,
+            },
+        };
+    }
+
+    /// Current counter values
+    pub fn stats(self: *const Self) AllocStats {
+        return .{
+            .live_bytes = self.live_bytes.load(.monotonic),
+            .peak_bytes = self.peak_bytes.load(.monotonic),
+            .live_allocations = self.live_allocations.load(.monotonic),
+            .total_allocations = self.total_allocations.load(.monotonic),
+            .total_bytes = self.total_bytes.load(.monotonic),
+        };
+    }
+
+    fn grow(self: *Self, len: usize) void {
+        const live = self.live_bytes.fetchAdd(len, .monotonic) + len;
+        _ = self.peak_bytes.fetchMax(live, .monotonic);
+        _ = self.total_bytes.fetchAdd(len, .monotonic);
+    }
+
+    fn shrink(self: *Self, len: usize) void {
+        _ = self.live_bytes.fetchSub(len, .monotonic);
+    }
+
+    fn resized(self: *Self, old_len: usize, new_len: usize) void {
+        if (new_len > old_len) self.grow(new_len - old_len) else self.shrink(old_len - new_len);
+    }
+
+    fn alloc(ctx: *anyopaque, len: usize, alignment: Alignment, ret_addr: usize) ?[*]u8 {
+        const self: *Self = @ptrCast(@alignCast(ctx));
+        const ptr = self.child.rawAlloc(len, alignment, ret_addr) orelse return null;
+        self.grow(len);
+        _ = self.live_allocations.fetchAdd(1, .monotonic);
+        _ = self.total_allocations.fetchAdd(1, .monotonic);
+        return ptr;
+    }
+
+    fn resize(ctx: *anyopaque, memory: []u8, alignment: Alignment, new_len: usize, ret_addr: usize) bool {
+        const self: *Self = @ptrCast(@alignCast(ctx));
+        if (!self.child.rawResize(memory, alignment, new_len, ret_addr)) return false;
+        self.resized(memory.len, new_len);
+        return true;
+    }
+
+    fn remap(ctx: *anyopaque, memory: []u8, alignment: Alignment, new_len: usize, ret_addr: usize) ?[*]u8 {
+        const self: *Self = @ptrCast(@alignCast(ctx));
+        const ptr = self.child.rawRemap(memory, alignment, new_len, ret_addr) orelse return null;
+        self.resized(memory.len, new_len);
+        return ptr;
+    }
+
+    fn free(ctx: *anyopaque, memory: []u8, alignment: Alignment, ret_addr: usize) void {
+        const self: *Self = @ptrCast(@alignCast(ctx));
+        self.child.rawFree(memory, alignment, ret_addr);
+        self.shrink(memory.len);
+        _ = self.live_allocations.fetchSub(1, .monotonic);
+    }
+};
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "CountingAllocator: live and peak bytes" {
+    var counting = CountingAllocator.init(std.testing.allocator);
+    const a = counting.allocator();
+
+    const first = try a.alloc(u8, 100);
+    const second = try a.alloc(u8, 50);
+    try std.testing.expectEqual(@as(usize, 150), counting.stats().live_bytes);
+    try std.testing.expectEqual(@as(usize, 2), counting.stats().live_allocations);
+
+    a.free(first);
+    try std.testing.expectEqual(@as(usize, 50), counting.stats().live_bytes);
+    try std.testing.expectEqual(@as(usize, 150), counting.stats().peak_bytes);
+
+    a.free(second);
+    const stats = counting.stats();
+    try std.testing.expectEqual(@as(usize, 0), stats.live_bytes);
+    try std.testing.expectEqual(@as(usize, 0), stats.live_allocations);
+    try std.testing.expectEqual(@as(u64, 2), stats.total_allocations);
+    try std.testing.expectEqual(@as(u64, 150), stats.total_bytes);
+}
+
+test "CountingAllocator: tracks growth" {
+    var counting = CountingAllocator.init(std.testing.allocator);
+    const a = counting.allocator();
+
+    var list: std.ArrayListUnmanaged(u32) = .empty;
+    for (0..1000) |i| try list.append(a, @intCast(i));
+    try std.testing.expectEqual(list.capacity * @sizeOf(u32), counting.stats().live_bytes);
+
+    list.deinit(a);
+    try std.testing.expectEqual(@as(usize, 0), counting.stats().live_bytes);
+    try std.testing.expect(counting.stats().peak_bytes >= 1000 * @sizeOf(u32));
+    try std.testing.expect(counting.stats().total_bytes >= counting.stats().peak_bytes);
+}
@@ -0,0 +1,110 @@
+//! CPU feature detection
+//!
+//! Reads the SIMD features of the CPU the process is running on (CPUID and
+//! XGETBV on x86_64, so features the OS does not save across context
+//! switches are reported as missing). The build target only fixes the
+//! minimum; dispatch.zig uses these bits to pick kernels built for more.
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+/// SIMD features relevant to the kernels (bit values are the C API's)
+pub const Features = packed struct(u32) {
+    sse2: bool = false,
+    sse42: bool = false,
+    avx2: bool = false,
+    avx512bw: bool = false,
+    neon: bool = false,
+    _reserved: u27 = 0,
+
+    /// Bitmask for the C API
+    pub fn toBits(self: Features) u32 {
+        return @bitCast(self);
+    }
+};
+
+/// Features of the running CPU
+pub fn detect() Features {
+    return switch (builtin.cpu.arch) {
+        .x86_64 => detectX86(),
+        // Advanced SIMD is mandatory on AArch64
+        .aarch64, .aarch64_be => .{ .neon = true },
+        else => .{},
+    };
+}
+
+fn detectX86() Features {
+    var features: Features = .{};
+
+    const leaf0 = cpuid(0, 0);
+    const max_leaf = leaf0[0];
+
+    const leaf1 = cpuid(1, 0);
+    features.sse2 = bit(leaf1[3], 26);
+    features.sse42 = bit(leaf1[2], 20);
+
+    // AVX state must be enabled by the OS (OSXSAVE, then XCR0)
+    if (!bit(leaf1[2], 27) or max_leaf < 7) return features;
+    const xcr0 = xgetbv();
+    const ymm_enabled = xcr0 & 0x6 == 0x6;
+    const zmm_enabled = xcr0 & 0xE6 == 0xE6;
+
+    const leaf7 = cpuid(7, 0);
+    features.avx2 = ymm_enabled and bit(leaf7[1], 5);
+    features.avx512bw = zmm_enabled and bit(leaf7[1], 16) and bit(leaf7[1], 30);
+    return features;
+}
+
+fn bit(value: u32, comptime index: u5) bool {
+    return value & (@as(u32, 1) << index) != 0;
+}
+
+/// eax, ebx, ecx, edx of CPUID leaf/subleaf
+fn cpuid(leaf: u32, subleaf: u32) [4]u32 {
+    var eax: u32 = undefined;
+    var ebx: u32 = undefined;
+    var ecx: u32 = undefined;
+    var edx: u32 = undefined;
+    asm volatile ("cpuid"
+        : [eax] "={eax}" (eax),
+          [ebx] "={ebx}" (ebx),
+          [ecx] "={ecx}" (ecx),
+          [edx] "={edx}" (edx),
+        : [leaf] "{eax}" (leaf),
+          [subleaf] "{ecx}" (subleaf),
+    );
+    return .{ eax, ebx, ecx, edx };
+}
+
+/// XCR0: register state the OS saves
+fn xgetbv() u64 {
+    var lo: u32 = undefined;
+    var hi: u32 = undefined;
+    asm volatile ("xgetbv"
+        : [lo] "={eax}" (lo),
+          [hi] "={edx}" (hi),
+        : [index] "{ecx}" (@as(u32, 0)),
+    );
+    return @as(u64, hi) << 32 | lo;
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "cpu: detect is consistent" {
+    const features = detect();
+    switch (builtin.cpu.arch) {
+        // SSE2 is part of the x86_64 baseline
+        .x86_64 => try std.testing.expect(features.sse2),
+        .aarch64 => try std.testing.expect(features.neon),
+        else => {},
+    }
+    if (features.avx512bw) try std.testing.expect(features.avx2);
+    try std.testing.expectEqual(features, detect());
+}
+
+test "cpu: C bit values" {
+    try std.testing.expectEqual(@as(u32, 1 << 2), (Features{ .avx2 = true }).toBits());
+    try std.testing.expectEqual(@as(u32, 1 << 4), (Features{ .neon = true }).toBits());
+}
@@ -0,0 +1,164 @@
+//! Kernel dispatch
+//!
+//! Picks the widest set of SIMD kernels (simd.zig) the running CPU supports,
+//! once, on first use. The in-unit variant is built for the compile target:
+//! SSE2 on a baseline x86_64 build, NEON on AArch64. On x86_64, build.zig
+//! also compiles AVX2 and AVX-512 variants as separate objects, unless the
+//! target already implies them, so one binary runs on an SSE2-only VM and
+//! still uses 64-byte vectors on an AVX-512 host.
+//!
+//! ZREGEXP_CPU caps the choice, for testing slower paths on a fast machine:
+//! `scalar`, `baseline`, `avx2` or `avx512`. A level above what the CPU (or
+//! the build) supports falls back to the best one available.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const build_options = @import("build_options");
+const simd = @import("simd.zig");
+const cpu = @import("cpu.zig");
+
+const Table = simd.Table;
+
+/// Kernel variants, narrowest first
+pub const Level = enum(u8) {
+    /// Byte-at-a-time loops
+    scalar = 0,
+
+    /// Vectors the build target guarantees
+    baseline = 1,
+
+    /// 32-byte vectors (x86_64 AVX2)
+    avx2 = 2,
+
+    /// 64-byte vectors (x86_64 AVX-512BW)
+    avx512 = 3,
+};
+
+/// Vector width of the baseline kernels
+pub const baseline_width = std.simd.suggestVectorLength(u8) orelse 16;
+
+const scalar_table: Table = simd.Kernels(1).table;
+const baseline_table: Table = simd.Kernels(baseline_width).table;
+const avx2_table: ?*const Table = if (hasVariant("avx2")) &simd.externTable("avx2") else null;
+const avx512_table: ?*const Table = if (hasVariant("avx512")) &simd.externTable("avx512") else null;
+
+fn hasVariant(comptime name: []const u8) bool {
+    for (build_options.simd_variants) |variant| {
+        if (std.mem.eql(u8, variant, name)) return true;
+    }
+    return false;
+}
+
+var active = std.atomic.Value(?*const Table).init(null);
+var active_level = std.atomic.Value(Level).init(.baseline);
+
+/// Best level this build supports on a CPU with `features`
+pub fn supported(features: cpu.Features) Level {
+    if (avx512_table != null and features.avx512bw) return .avx512;
+    if (avx2_table != null and features.avx2) return .avx2;
+    return .baseline;
+}
+
+/// Switch to `requested`, or the best supported level below it; returns the level used
+pub fn select(requested: Level) Level {
+    const level: Level = @enumFromInt(@min(@intFromEnum(requested), @intFromEnum(supported(cpu.detect()))));
+    // supported() only reports levels whose variant was built
+    const table = tableFor(level) orelse &baseline_table;
+
+    active_level.store(level, .monotonic);
+    active.store(table, .release);
+    return level;
+}
+
+fn tableFor(level: Level) ?*const Table {
+    return switch (level) {
+        .scalar => &scalar_table,
+        .baseline => &baseline_table,
+        .avx2 => avx2_table,
+        .avx512 => avx512_table,
+    };
+}
+
+/// Level the kernels currently run at
+pub fn activeLevel() Level {
+    _ = kernels();
+    return active_level.load(.monotonic);
+}
+
+/// Level named by ZREGEXP_CPU, if set
+fn levelFromEnv() ?Level {
+    if (builtin.os.tag == .windows) return null;
+    const value = std.posix.getenv("ZREGEXP_CPU") orelse return null;
+    return std.meta.stringToEnum(Level, value);
+}
+
+fn kernels() *const Table {
+    if (active.load(.acquire)) |table| return table;
+    // Racing first calls select the same level
+    _ = select(levelFromEnv() orelse .avx512);
+    return active.load(.acquire).?;
+}
+
+fn found(index: usize) ?usize {
+    return if (index == simd.NOT_FOUND) null else index;
+}
+
+// =============================================================================
+// Kernels
+// =============================================================================
+
+/// Index of the first `needle` at or after `start`
+pub fn indexOfScalarPos(haystack: []const u8, start: usize, needle: u8) ?usize {
+    return found(kernels().index_of_scalar(haystack.ptr, haystack.len, start, needle));
+}
+
+/// Index of the last `needle`
+pub fn lastIndexOfScalar(haystack: []const u8, needle: u8) ?usize {
+    return found(kernels().last_index_of_scalar(haystack.ptr, haystack.len, needle));
+}
+
+/// End of the run of bytes in [lo, hi] starting at `start`
+pub fn spanInRange(haystack: []const u8, start: usize, lo: u8, hi: u8) usize {
+    return kernels().span_in_range(haystack.ptr, haystack.len, start, lo, hi);
+}
+
+/// Index of the first byte in [lo, hi] at or after `start`
+pub fn indexOfRange(haystack: []const u8, start: usize, lo: u8, hi: u8) ?usize {
+    return found(kernels().index_of_range(haystack.ptr, haystack.len, start, lo, hi));
+}
+
+/// Index of the first occurrence of `needle`
+pub fn indexOf(haystack: []const u8, needle: []const u8) ?usize {
+    return found(kernels().index_of(haystack.ptr, haystack.len, needle.ptr, needle.len));
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "dispatch: every available level gives the same answers" {
+    const previous = activeLevel();
+    defer _ = select(previous);
+
+    const text = "GET /index.html HTTP/1.1\r\nHost: example.com\r\nUser-Agent: curl/8.0\r\n\r\n";
+    for (std.enums.values(Level)) |level| {
+        const used = select(level);
+        try std.testing.expect(@intFromEnum(used) <= @intFromEnum(level));
+
+        try std.testing.expectEqual(@as(?usize, 24), indexOfScalarPos(text, 0, '\r'));
+        try std.testing.expectEqual(@as(?usize, 67), lastIndexOfScalar(text, '\r'));
+        try std.testing.expectEqual(@as(?usize, 26), indexOf(text, "Host"));
+        try std.testing.expectEqual(@as(?usize, null), indexOf(text, "Hosts"));
+        try std.testing.expectEqual(@as(usize, 3), spanInRange(text, 0, 'A', 'Z'));
+        try std.testing.expectEqual(@as(?usize, 5), indexOfRange(text, 0, 'a', 'z'));
+    }
+}
+
+test "dispatch: never selects above what the CPU supports" {
+    const previous = activeLevel();
+    defer _ = select(previous);
+
+    const best = supported(cpu.detect());
+    try std.testing.expectEqual(best, select(.avx512));
+    try std.testing.expectEqual(Level.scalar, select(.scalar));
+}
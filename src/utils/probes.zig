@@ -0,0 +1,106 @@
+//! USDT static probes
+//!
+//! Systemtap SDT probes under the provider "zregexp", compatible with
+//! bpftrace, perf and systemtap:
+//!
+//!     bpftrace -e 'usdt:./libzregexp.so:zregexp:search__done { @[arg0] = count(); }'
+//!
+//! Each probe site is a single `nop` plus an entry in the `.note.stapsdt`
+//! ELF section describing its address and argument registers. A tracer
+//! patches the nop into a breakpoint when it attaches; until then the probe
+//! costs one instruction. Arguments are passed as 64-bit values already in
+//! registers, so no work is done to compute them for an idle probe.
+//!
+//! On targets other than Linux x86_64/aarch64 every probe compiles to nothing.
+//!
+//! Probes:
+//! - compile__start(pattern_len)
+//! - compile__done(pattern_len, bytecode_len)
+//! - search__start(pattern_id, input_len)
+//! - search__done(pattern_id, input_len, outcome)  outcome: 0 no match, 1 match, 2 error
+//! - engine__select(pattern_id, engine)  engine: ExecStats.Engine value
+//! - prefilter__reject(pattern_id, input_len)
+//! - prefilter__candidate(pattern_id, offset)
+//! - budget__exceeded(kind, steps, depth)  kind: 0 steps, 1 recursion depth, 2 stack bytes
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+/// Whether probes are emitted for this target
+pub const enabled = builtin.os.tag == .linux and builtin.object_format == .elf and
+    (builtin.cpu.arch == .x86_64 or builtin.cpu.arch == .aarch64);
+
+/// Assembly for one probe site: the nop, its note and the shared base symbol
+fn note(comptime name: []const u8, comptime args: []const u8) []const u8 {
+    return "990: nop\n" ++
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n" ++
+        ".balign 4\n" ++
+        ".4byte 992f-991f, 994f-993f, 3\n" ++
+        "991: .asciz \"stapsdt\"\n" ++
+        "992: .balign 4\n" ++
+        "993: .8byte 990b\n" ++
+        ".8byte _.stapsdt.base\n" ++
+        ".8byte 0\n" ++ // no semaphore
+        ".asciz \"zregexp\"\n" ++
+        ".asciz \"" ++ name ++ "\"\n" ++
+        ".asciz \"" ++ args ++ "\"\n" ++
+        "994: .balign 4\n" ++
+        ".popsection\n" ++
+        ".ifndef _.stapsdt.base\n" ++
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" ++
+        ".weak _.stapsdt.base\n" ++
+        ".hidden _.stapsdt.base\n" ++
+        "_.stapsdt.base: .space 1\n" ++
+        ".size _.stapsdt.base, 1\n" ++
+        ".popsection\n" ++
+        ".endif\n";
+}
+
+/// Probe site without arguments
+pub inline fn probe0(comptime name: []const u8) void {
+    if (enabled) asm volatile (comptime note(name, ""));
+}
+
+/// Probe site with one argument
+pub inline fn probe1(comptime name: []const u8, a0: u64) void {
+    if (enabled) asm volatile (comptime note(name, "8@%[a0]")
+        :
+        : [a0] "r" (a0),
+    );
+}
+
+/// Probe site with two arguments
+pub inline fn probe2(comptime name: []const u8, a0: u64, a1: u64) void {
+    if (enabled) asm volatile (comptime note(name, "8@%[a0] 8@%[a1]")
+        :
+        : [a0] "r" (a0),
+          [a1] "r" (a1),
+    );
+}
+
+/// Probe site with three arguments
+pub inline fn probe3(comptime name: []const u8, a0: u64, a1: u64, a2: u64) void {
+    if (enabled) asm volatile (comptime note(name, "8@%[a0] 8@%[a1] 8@%[a2]")
+        :
+        : [a0] "r" (a0),
+          [a1] "r" (a1),
+          [a2] "r" (a2),
+    );
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+test "probes: sites assemble and are no-ops" {
+    probe0("test__probe0");
+    probe1("test__probe1", 1);
+    probe2("test__probe2", 1, 2);
+    probe3("test__probe3", 1, 2, 3);
+}
+
+test "probes: note names the provider and arguments" {
+    const text = comptime note("search__done", "8@%[a0]");
+    try std.testing.expect(std.mem.indexOf(u8, text, ".asciz \"zregexp\"") != null);
+    try std.testing.expect(std.mem.indexOf(u8, text, ".asciz \"search__done\"") != null);
+}
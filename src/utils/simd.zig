@@ -0,0 +1,255 @@
+//! SIMD scanning kernels
+//!
+//! The byte scans the engine leans on (memchr, memrchr, runs of a byte
+//! range, literal search), written once over @Vector(width, u8) and
+//! instantiated per vector width. Each instantiation can be turned into a
+//! Table of C-ABI function pointers, either in the current compilation unit
+//! (table) or as exported symbols of a separately compiled object built for
+//! a wider CPU (exportC, see simd_variant.zig and build.zig). dispatch.zig
+//! picks one table at runtime.
+//!
+//! Every kernel returns NOT_FOUND rather than an optional so the same
+//! signature works across the C ABI.
+
+const std = @import("std");
+
+/// Returned by a kernel that found nothing
+pub const NOT_FOUND = std.math.maxInt(usize);
+
+/// One set of kernels (pointers are C ABI so variants can live in other objects)
+pub const Table = struct {
+    /// First index >= start holding needle
+    index_of_scalar: *const fn (ptr: [*]const u8, len: usize, start: usize, needle: u8) callconv(.c) usize,
+
+    /// Last index holding needle
+    last_index_of_scalar: *const fn (ptr: [*]const u8, len: usize, needle: u8) callconv(.c) usize,
+
+    /// First index >= start whose byte is outside [lo, hi] (len if none)
+    span_in_range: *const fn (ptr: [*]const u8, len: usize, start: usize, lo: u8, hi: u8) callconv(.c) usize,
+
+    /// First index >= start whose byte is inside [lo, hi]
+    index_of_range: *const fn (ptr: [*]const u8, len: usize, start: usize, lo: u8, hi: u8) callconv(.c) usize,
+
+    /// First index of needle in haystack
+    index_of: *const fn (ptr: [*]const u8, len: usize, needle_ptr: [*]const u8, needle_len: usize) callconv(.c) usize,
+};
+
+/// Kernels over `width`-byte vectors (width 1 is plain scalar code)
+pub fn Kernels(comptime width: comptime_int) type {
+    return struct {
+        const V = @Vector(width, u8);
+        const Mask = std.meta.Int(.unsigned, width);
+
+        fn load(bytes: []const u8, i: usize) V {
+            return bytes[i..][0..width].*;
+        }
+
+        /// Bit i set where byte i of `block` is in [lo, hi]
+        fn inRange(block: V, lo: u8, hi: u8) Mask {
+            const offset: V = @splat(lo);
+            const span: V = @splat(hi -% lo);
+            return @bitCast((block -% offset) <= span);
+        }
+
+        pub fn indexOfScalar(haystack: []const u8, start: usize, needle: u8) usize {
+            const splat: V = @splat(needle);
+            var i = start;
+            while (i + width <= haystack.len) : (i += width) {
+                const mask: Mask = @bitCast(load(haystack, i) == splat);
+                if (mask != 0) return i + @ctz(mask);
+            }
+            while (i < haystack.len) : (i += 1) {
+                if (haystack[i] == needle) return i;
+            }
+            return NOT_FOUND;
+        }
+
+        pub fn lastIndexOfScalar(haystack: []const u8, needle: u8) usize {
+            const splat: V = @splat(needle);
+            var end = haystack.len;
+            while (end >= width) : (end -= width) {
+                const mask: Mask = @bitCast(load(haystack, end - width) == splat);
+                if (mask != 0) return end - 1 - @clz(mask);
+            }
+            while (end > 0) : (end -= 1) {
+                if (haystack[end - 1] == needle) return end - 1;
+            }
+            return NOT_FOUND;
+        }
+
+        pub fn spanInRange(haystack: []const u8, start: usize, lo: u8, hi: u8) usize {
+            var i = start;
+            while (i + width <= haystack.len) : (i += width) {
+                const outside = ~inRange(load(haystack, i), lo, hi);
+                if (outside != 0) return i + @ctz(outside);
+            }
+            while (i < haystack.len) : (i += 1) {
+                if (haystack[i] -% lo > hi -% lo) return i;
+            }
+            return haystack.len;
+        }
+
+        pub fn indexOfRange(haystack: []const u8, start: usize, lo: u8, hi: u8) usize {
+            var i = start;
+            while (i + width <= haystack.len) : (i += width) {
+                const inside = inRange(load(haystack, i), lo, hi);
+                if (inside != 0) return i + @ctz(inside);
+            }
+            while (i < haystack.len) : (i += 1) {
+                if (haystack[i] -% lo <= hi -% lo) return i;
+            }
+            return NOT_FOUND;
+        }
+
+        /// Compares the needle's first and last byte a block at a time and
+        /// only verifies positions where both agree
+        pub fn indexOf(haystack: []const u8, needle: []const u8) usize {
+            if (needle.len == 0) return 0;
+            if (needle.len > haystack.len) return NOT_FOUND;
+            if (needle.len == 1) return indexOfScalar(haystack, 0, needle[0]);
+
+            const last_offset = needle.len - 1;
+            const first: V = @splat(needle[0]);
+            const last: V = @splat(needle[last_offset]);
+            const candidates_end = haystack.len - last_offset;
+
+            var i: usize = 0;
+            while (i + width <= candidates_end) : (i += width) {
+                const first_eq: Mask = @bitCast(load(haystack, i) == first);
+                const last_eq: Mask = @bitCast(load(haystack, i + last_offset) == last);
+                var mask = first_eq & last_eq;
+                while (mask != 0) : (mask &= mask - 1) {
+                    const pos = i + @ctz(mask);
+                    if (std.mem.eql(u8, haystack[pos + 1 ..][0 .. needle.len - 2], needle[1..last_offset])) return pos;
+                }
+            }
+            while (i < candidates_end) : (i += 1) {
+                if (std.mem.eql(u8, haystack[i..][0..needle.len], needle)) return i;
+            }
+            return NOT_FOUND;
+        }
+
+        // C ABI adapters (the Table signatures)
+
+        fn cIndexOfScalar(ptr: [*]const u8, len: usize, start: usize, needle: u8) callconv(.c) usize {
+            return indexOfScalar(ptr[0..len], start, needle);
+        }
+
+        fn cLastIndexOfScalar(ptr: [*]const u8, len: usize, needle: u8) callconv(.c) usize {
+            return lastIndexOfScalar(ptr[0..len], needle);
+        }
+
+        fn cSpanInRange(ptr: [*]const u8, len: usize, start: usize, lo: u8, hi: u8) callconv(.c) usize {
+            return spanInRange(ptr[0..len], start, lo, hi);
+        }
+
+        fn cIndexOfRange(ptr: [*]const u8, len: usize, start: usize, lo: u8, hi: u8) callconv(.c) usize {
+            return indexOfRange(ptr[0..len], start, lo, hi);
+        }
+
+        fn cIndexOf(ptr: [*]const u8, len: usize, needle_ptr: [*]const u8, needle_len: usize) callconv(.c) usize {
+            return indexOf(ptr[0..len], needle_ptr[0..needle_len]);
+        }
+
+        pub const table: Table = .{
+            .index_of_scalar = cIndexOfScalar,
+            .last_index_of_scalar = cLastIndexOfScalar,
+            .span_in_range = cSpanInRange,
+            .index_of_range = cIndexOfRange,
+            .index_of = cIndexOf,
+        };
+    };
+}
+
+/// Table entry names, in Table field order
+const entry_names = [_][]const u8{ "index_of_scalar", "last_index_of_scalar", "span_in_range", "index_of_range", "index_of" };
+
+/// Symbol of one exported kernel of variant `name`
+pub fn symbolName(comptime name: []const u8, comptime entry: []const u8) []const u8 {
+    return "zregexp_simd_" ++ name ++ "_" ++ entry;
+}
+
+/// Export the kernels for `width` as zregexp_simd_<name>_<entry> (see externTable)
+pub fn exportC(comptime name: []const u8, comptime width: comptime_int) void {
+    const table = Kernels(width).table;
+    inline for (entry_names) |entry| {
+        @export(@field(table, entry), .{ .name = symbolName(name, entry) });
+    }
+}
+
+/// Table of the kernels another object exported with exportC(name, ...)
+pub fn externTable(comptime name: []const u8) Table {
+    var table: Table = undefined;
+    inline for (entry_names) |entry| {
+        const Fn = @typeInfo(@FieldType(Table, entry)).pointer.child;
+        @field(table, entry) = @extern(*const Fn, .{ .name = symbolName(name, entry) });
+    }
+    return table;
+}
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+fn expectKernelsMatchStd(comptime width: comptime_int) !void {
+    const K = Kernels(width);
+    var prng = std.Random.DefaultPrng.init(width);
+    const random = prng.random();
+
+    var buf: [300]u8 = undefined;
+    for (0..200) |_| {
+        const len = random.uintAtMost(usize, buf.len);
+        const haystack = buf[0..len];
+        // Small alphabet so needles and ranges actually occur
+        for (haystack) |*c| c.* = 'a' + random.uintLessThan(u8, 6);
+
+        const needle = 'a' + random.uintLessThan(u8, 7);
+        const start = random.uintAtMost(usize, len);
+        const lo = 'a' + random.uintLessThan(u8, 6);
+        const hi = lo + random.uintLessThan(u8, 3);
+
+        const expect_index = std.mem.indexOfScalarPos(u8, haystack, start, needle) orelse NOT_FOUND;
+        try std.testing.expectEqual(expect_index, K.indexOfScalar(haystack, start, needle));
+
+        const expect_last = std.mem.lastIndexOfScalar(u8, haystack, needle) orelse NOT_FOUND;
+        try std.testing.expectEqual(expect_last, K.lastIndexOfScalar(haystack, needle));
+
+        var span = start;
+        while (span < len and haystack[span] >= lo and haystack[span] <= hi) span += 1;
+        try std.testing.expectEqual(span, K.spanInRange(haystack, start, lo, hi));
+
+        var inside = start;
+        while (inside < len and (haystack[inside] < lo or haystack[inside] > hi)) inside += 1;
+        try std.testing.expectEqual(if (inside == len) NOT_FOUND else inside, K.indexOfRange(haystack, start, lo, hi));
+
+        const needle_len = random.uintAtMost(usize, @min(len, 5));
+        const needle_start = random.uintAtMost(usize, len - needle_len);
+        const literal = haystack[needle_start..][0..needle_len];
+        const expect_literal = std.mem.indexOf(u8, haystack, literal) orelse NOT_FOUND;
+        try std.testing.expectEqual(expect_literal, K.indexOf(haystack, literal));
+        try std.testing.expectEqual(std.mem.indexOf(u8, haystack, "abcabcz") orelse NOT_FOUND, K.indexOf(haystack, "abcabcz"));
+    }
+}
+
+test "simd: kernels agree with std.mem at every width" {
+    try expectKernelsMatchStd(1);
+    try expectKernelsMatchStd(16);
+    try expectKernelsMatchStd(32);
+    try expectKernelsMatchStd(64);
+}
+
+test "simd: range covering all bytes" {
+    const K = Kernels(16);
+    const input = [_]u8{ 0, 0x7F, 0x80, 0xFF } ** 9;
+    try std.testing.expectEqual(input.len, K.spanInRange(&input, 0, 0, 0xFF));
+    try std.testing.expectEqual(@as(usize, 2), K.spanInRange(&input, 0, 0, 0x7F));
+    try std.testing.expectEqual(@as(usize, 2), K.indexOfRange(&input, 0, 0x80, 0xFF));
+}
+
+test "simd: table calls through the C ABI" {
+    const table = Kernels(16).table;
+    const text = "the quick brown fox jumps over the lazy dog";
+    try std.testing.expectEqual(@as(usize, 16), table.index_of(text.ptr, text.len, "fox", 3));
+    try std.testing.expectEqual(@as(usize, 40), table.last_index_of_scalar(text.ptr, text.len, 'd'));
+    try std.testing.expectEqual(NOT_FOUND, table.index_of_scalar(text.ptr, text.len, 0, '!'));
+}
@@ -0,0 +1,13 @@
+//! Root of one SIMD kernel variant object
+//!
+//! build.zig compiles this file once per extra CPU level, with that level's
+//! features enabled, and links the objects into the library. Each exports
+//! the kernels of simd.zig under zregexp_simd_<name>_*; dispatch.zig calls
+//! them only on CPUs that have the features.
+
+const options = @import("simd_variant_options");
+const simd = @import("simd.zig");
+
+comptime {
+    simd.exportC(options.name, options.width);
+}
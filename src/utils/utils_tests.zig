@@ -11,4 +11,9 @@ test {
     _ = @import("bitset.zig");
     _ = @import("pool.zig");
     _ = @import("debug.zig");
+    _ = @import("probes.zig");
+    _ = @import("counting_allocator.zig");
+    _ = @import("simd.zig");
+    _ = @import("cpu.zig");
+    _ = @import("dispatch.zig");
 }
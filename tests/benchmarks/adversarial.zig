@@ -0,0 +1,251 @@
+//! Adversarial (ReDoS) benchmarks
+//!
+//! Pattern/input pairs that make a backtracking engine do exponential or
+//! polynomial work, run at growing input sizes. Each run records the time per
+//! call, the steps and recursion depth the matcher reached, and which budget
+//! (ExecOptions) stopped it, if any. With the default budgets every call must
+//! end quickly; a row whose time keeps growing with n while no budget trips is
+//! a regression.
+//!
+//! Every input contains the literal its pattern requires, so the prefilter
+//! passes it to the matcher; most end in `!` plus that literal, which makes
+//! every attempt over the a's fail. A run that takes no steps, or an
+//! exponential family that no budget stops from `trips_from` on, is marked
+//! and makes the suite fail (the runner exits non-zero).
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const harness = @import("harness.zig");
+
+const Allocator = std.mem.Allocator;
+const Regex = zregexp.Regex;
+const ExecStats = zregexp.ExecStats;
+const Options = harness.Options;
+
+/// Pattern and input of one case at size n (both owned by the caller)
+const Instance = struct {
+    pattern: []const u8,
+    input: []const u8,
+
+    fn deinit(self: Instance, allocator: Allocator) void {
+        allocator.free(self.pattern);
+        allocator.free(self.input);
+    }
+};
+
+const Case = struct {
+    name: []const u8,
+    build: *const fn (Allocator, usize) Allocator.Error!Instance,
+
+    /// Largest n worth running (the pattern may grow with n)
+    max_n: usize = std.math.maxInt(usize),
+
+    /// Smallest n at which the default budgets must stop the search
+    trips_from: usize = std.math.maxInt(usize),
+};
+
+/// The pathological families; names are stable so results can be compared across runs
+const cases = [_]Case{
+    .{ .name = "nested-quantifier", .build = nestedQuantifier, .trips_from = 32 },
+    .{ .name = "overlapping-alternation", .build = overlappingAlternation, .trips_from = 64 },
+    .{ .name = "optional-chain", .build = optionalChain, .max_n = 64, .trips_from = 32 },
+    .{ .name = "long-lookbehind", .build = longLookbehind },
+    .{ .name = "backref-explosion", .build = backrefExplosion, .trips_from = 32 },
+    .{ .name = "counted-repeat", .build = countedRepeat },
+};
+
+/// Input sizes, each capped by --size
+const sizes = [_]usize{ 8, 12, 16, 20, 24, 32, 64, 256, 1024, 4096, 16384, 65536 };
+
+/// `(a+)+b` against a^n!b: every split of the a's is tried before failing
+fn nestedQuantifier(allocator: Allocator, n: usize) Allocator.Error!Instance {
+    return .{
+        .pattern = try allocator.dupe(u8, "(a+)+b"),
+        .input = try repeatThen(allocator, "a", n, "!b"),
+    };
+}
+
+/// `(a|aa)*c` against a^n!c: the number of ways to cover n a's grows as Fibonacci,
+/// and every start position before the final c tries them all
+fn overlappingAlternation(allocator: Allocator, n: usize) Allocator.Error!Instance {
+    return .{
+        .pattern = try allocator.dupe(u8, "(a|aa)*c"),
+        .input = try repeatThen(allocator, "a", n, "!c"),
+    };
+}
+
+/// `a?^n a^n` against a^n: 2^n ways to skip optional a's, one of which matches
+fn optionalChain(allocator: Allocator, n: usize) Allocator.Error!Instance {
+    const optional = try repeat(allocator, "a?", n);
+    defer allocator.free(optional);
+    const required = try repeat(allocator, "a", n);
+    defer allocator.free(required);
+
+    return .{
+        .pattern = try std.mem.concat(allocator, u8, &.{ optional, required }),
+        .input = try repeat(allocator, "a", n),
+    };
+}
+
+/// `(?<=a+)b` against a^n!b: the lookbehind rescans the prefix at every position
+fn longLookbehind(allocator: Allocator, n: usize) Allocator.Error!Instance {
+    return .{
+        .pattern = try allocator.dupe(u8, "(?<=a+)b"),
+        .input = try repeatThen(allocator, "a", n, "!b"),
+    };
+}
+
+/// `^(a+)+\1b` against a^n!b: each split is re-verified through the backreference
+fn backrefExplosion(allocator: Allocator, n: usize) Allocator.Error!Instance {
+    return .{
+        .pattern = try allocator.dupe(u8, "^(a+)+\\1b"),
+        .input = try repeatThen(allocator, "a", n, "!b"),
+    };
+}
+
+/// `(a{1,32}){1,32}b` against a^n!b: large unrolled repeats, nested
+fn countedRepeat(allocator: Allocator, n: usize) Allocator.Error!Instance {
+    return .{
+        .pattern = try allocator.dupe(u8, "(a{1,32}){1,32}b"),
+        .input = try repeatThen(allocator, "a", n, "!b"),
+    };
+}
+
+fn repeat(allocator: Allocator, unit: []const u8, count: usize) Allocator.Error![]u8 {
+    return repeatThen(allocator, unit, count, "");
+}
+
+/// `unit` repeated `count` times, followed by `tail`
+fn repeatThen(allocator: Allocator, unit: []const u8, count: usize, tail: []const u8) Allocator.Error![]u8 {
+    const out = try allocator.alloc(u8, unit.len * count + tail.len);
+    for (0..count) |i| @memcpy(out[i * unit.len ..][0..unit.len], unit);
+    @memcpy(out[unit.len * count ..], tail);
+    return out;
+}
+
+/// One isMatch call; a tripped budget is an expected outcome, not a failure
+const Attempt = struct {
+    re: *const Regex,
+    input: []const u8,
+
+    fn call(self: *const Attempt) anyerror!u64 {
+        const matched = self.re.isMatch(self.input) catch |err| switch (err) {
+            error.StepLimitExceeded, error.RecursionLimitExceeded, error.ScratchLimitExceeded => return 0,
+            else => return err,
+        };
+        return @intFromBool(matched);
+    }
+};
+
+/// Run every case at every size and write a JSON array of results; fails
+/// after writing when a run did not behave as its family requires
+pub fn run(allocator: Allocator, options: Options, w: *std.Io.Writer) !void {
+    var regressed = false;
+    var sink: u64 = 0;
+    var first_result = true;
+    try w.writeByte('[');
+
+    for (cases) |case| {
+        if (!options.selects(case.name)) continue;
+
+        for (sizes) |n| {
+            if (n > options.size or n > case.max_n) break;
+            std.debug.print("redos: {s} n={d}\n", .{ case.name, n });
+
+            const instance = try case.build(allocator, n);
+            defer instance.deinit(allocator);
+
+            if (!first_result) try w.writeByte(',');
+            first_result = false;
+            if (!try runInstance(allocator, options, w, case, n, instance, &sink)) regressed = true;
+        }
+    }
+
+    try w.writeByte(']');
+    std.mem.doNotOptimizeAway(sink);
+    if (regressed) {
+        std.debug.print("redos: unexpected outcome\n", .{});
+        return error.RegressionDetected;
+    }
+}
+
+/// Write one run; returns false when it never reached the matcher, or when
+/// no budget stopped a family that must trip at this size
+fn runInstance(
+    allocator: Allocator,
+    options: Options,
+    w: *std.Io.Writer,
+    case: Case,
+    n: usize,
+    instance: Instance,
+    sink: *u64,
+) !bool {
+    var first = true;
+    try w.writeByte('{');
+    try harness.writeKey(w, &first, "name");
+    try harness.writeJsonString(w, case.name);
+    try harness.writeKey(w, &first, "n");
+    try w.print("{d}", .{n});
+    try harness.writeKey(w, &first, "pattern_len");
+    try w.print("{d}", .{instance.pattern.len});
+    try harness.writeKey(w, &first, "input_len");
+    try w.print("{d}", .{instance.input.len});
+
+    var compile_timer = try std.time.Timer.start();
+    const re = Regex.compile(allocator, instance.pattern) catch |err| {
+        try harness.writeKey(w, &first, "error");
+        try harness.writeJsonString(w, @errorName(err));
+        try w.writeByte('}');
+        return true;
+    };
+    defer re.deinit();
+    try harness.writeKey(w, &first, "compile_ns");
+    try w.print("{d}", .{compile_timer.read()});
+    try harness.writeKey(w, &first, "program_bytes");
+    try w.print("{d}", .{re.memoryUsage().program_bytes});
+    try harness.writeKey(w, &first, "budget");
+    try w.print("{{\"max_steps\":{d},\"max_recursion_depth\":{d},\"max_scratch_bytes\":{d}}}", .{
+        re.exec_options.max_steps, re.exec_options.max_recursion_depth, re.exec_options.max_scratch_bytes,
+    });
+
+    // One observed call for the work counters and outcome
+    var stats: ExecStats = .{};
+    const outcome: []const u8 = if (re.isMatchWithStats(instance.input, &stats)) |matched|
+        (if (matched) "matched" else "no_match")
+    else |err| switch (err) {
+        error.StepLimitExceeded => "step_limit",
+        error.RecursionLimitExceeded => "recursion_limit",
+        error.ScratchLimitExceeded => "scratch_limit",
+        else => @errorName(err),
+    };
+    const tripped = std.mem.endsWith(u8, outcome, "_limit");
+
+    try harness.writeKey(w, &first, "outcome");
+    try harness.writeJsonString(w, outcome);
+    try harness.writeKey(w, &first, "budget_tripped");
+    try w.writeAll(if (tripped) "true" else "false");
+    try harness.writeKey(w, &first, "steps");
+    try w.print("{d}", .{stats.steps});
+    try harness.writeKey(w, &first, "backtracks");
+    try w.print("{d}", .{stats.backtracks});
+    try harness.writeKey(w, &first, "max_depth");
+    try w.print("{d}", .{stats.max_depth});
+    try harness.writeKey(w, &first, "start_positions");
+    try w.print("{d}", .{stats.start_positions});
+
+    // A prefilter reject measures nothing about backtracking
+    const reached = stats.steps > 0;
+    const expected = reached and (tripped or n < case.trips_from);
+    try harness.writeKey(w, &first, "as_expected");
+    try w.writeAll(if (expected) "true" else "false");
+    if (!expected) {
+        std.debug.print("redos: {s} n={d} {s}\n", .{ case.name, n, if (reached) "tripped no budget" else "never reached the matcher" });
+    }
+
+    const attempt: Attempt = .{ .re = &re, .input = instance.input };
+    const time = try harness.measure(allocator, options, &attempt, Attempt.call, sink);
+    try harness.writeKey(w, &first, "ns");
+    try time.writeJson(w);
+    try w.writeByte('}');
+    return expected;
+}
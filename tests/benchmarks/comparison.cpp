@@ -0,0 +1,408 @@
+/**
+ * zregexp vs std::regex
+ *
+ * Runs the same patterns over the same lines through zregexp::Regex and
+ * std::regex (ECMAScript grammar), times isMatch, find, findAll and replace,
+ * and checks that both engines agree line by line. zregexp is called through
+ * zregexp.hpp, so the wrapper's string copies and exceptions are part of
+ * what is measured.
+ *
+ * Built and run by `zig build bench-compare`, which generates the corpora
+ * with gen_corpus.zig and passes them as kind=path arguments:
+ *
+ *   bench-compare weblog=... prose=... [--reps N] [--warmup N] [--filter S]
+ *
+ * Prints one JSON document to stdout.
+ */
+
+#include <zregexp.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// =============================================================================
+// Catalogue
+// =============================================================================
+
+struct Case {
+    const char* name;
+    const char* pattern;
+    const char* corpus;
+
+    /** std::regex lacks lookbehind; such cases run on zregexp only */
+    bool std_supported;
+};
+
+const Case kCatalogue[] = {
+    {"literal/mozilla", "Mozilla", "weblog", true},
+    {"literal/sherlock", "Sherlock", "prose", true},
+    {"literal/gattaca", "GATTACA", "dna", true},
+    {"class/digits", "[0-9]+", "weblog", true},
+    {"class/capitalized", "[A-Z][a-z]+", "prose", true},
+    {"class/tag", "<[a-z]+", "html", true},
+    {"alternation/names", "Sherlock|Holmes|Watson|Moriarty", "prose", true},
+    {"alternation/methods", "GET|POST|PUT|DELETE", "weblog", true},
+    {"anchored/ip", "^[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+", "weblog", true},
+    {"anchored/header", "^>seq[0-9]+", "dna", true},
+    {"lookaround/status", "[0-9]{3}(?= [0-9]+ \")", "weblog", true},
+    {"lookaround/href", "(?<=href=\")[^\"]+", "html", false},
+    {"backref/element", "<([a-z]+)[^>]*>[^<]*</\\1>", "html", true},
+    {"backref/repeated-word", "\\b([a-z]+) \\1\\b", "prose", true},
+};
+
+enum class Op { IsMatch, Find, FindAll, Replace };
+
+const Op kOps[] = {Op::IsMatch, Op::Find, Op::FindAll, Op::Replace};
+
+const char* opName(Op op) {
+    switch (op) {
+        case Op::IsMatch: return "is_match";
+        case Op::Find: return "find";
+        case Op::FindAll: return "find_all";
+        case Op::Replace: return "replace";
+    }
+    return "?";
+}
+
+/** Contains no $ escapes, so both engines insert it verbatim */
+const char kReplacement[] = "#";
+
+// =============================================================================
+// Engines
+// =============================================================================
+
+/**
+ * Run one op over one line. Returns the number of matches; when outcome is
+ * given, also fills it with a description both engines must agree on.
+ */
+size_t run(const zregexp::Regex& re, Op op, const std::string& line, std::string* outcome) {
+    switch (op) {
+        case Op::IsMatch: {
+            bool matched = re.isMatch(line);
+            if (outcome) *outcome = matched ? "1" : "0";
+            return matched ? 1 : 0;
+        }
+        case Op::Find: {
+            auto match = re.find(line);
+            if (!match) return 0;
+            if (outcome) *outcome = std::to_string(match->start()) + ":" + match->slice();
+            return 1;
+        }
+        case Op::FindAll: {
+            auto matches = re.findAll(line);
+            if (outcome) {
+                outcome->clear();
+                for (const auto& match : matches) *outcome += match.slice() + "\x1f";
+            }
+            return matches.size();
+        }
+        case Op::Replace: {
+            std::string replaced = re.replace(line, kReplacement);
+            if (outcome) *outcome = std::move(replaced);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t run(const std::regex& re, Op op, const std::string& line, std::string* outcome) {
+    switch (op) {
+        case Op::IsMatch: {
+            bool matched = std::regex_search(line, re);
+            if (outcome) *outcome = matched ? "1" : "0";
+            return matched ? 1 : 0;
+        }
+        case Op::Find: {
+            std::smatch match;
+            if (!std::regex_search(line, match, re)) return 0;
+            if (outcome) *outcome = std::to_string(match.position(0)) + ":" + match.str(0);
+            return 1;
+        }
+        case Op::FindAll: {
+            size_t count = 0;
+            if (outcome) outcome->clear();
+            for (std::sregex_iterator it(line.begin(), line.end(), re), end; it != end; ++it) {
+                if (outcome) *outcome += it->str(0) + "\x1f";
+                ++count;
+            }
+            return count;
+        }
+        case Op::Replace: {
+            std::string replaced = std::regex_replace(line, re, kReplacement);
+            if (outcome) *outcome = std::move(replaced);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// =============================================================================
+// Measurement
+// =============================================================================
+
+struct Options {
+    int warmup = 2;
+    int reps = 10;
+    std::string filter;
+    std::map<std::string, std::string> corpora;
+};
+
+struct Summary {
+    double min = 0, median = 0, mean = 0, stddev = 0, max = 0;
+
+    static Summary of(std::vector<double> samples) {
+        Summary s;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples) sum += v;
+        s.mean = sum / samples.size();
+        double squares = 0;
+        for (double v : samples) squares += (v - s.mean) * (v - s.mean);
+        s.stddev = std::sqrt(squares / samples.size());
+        size_t mid = samples.size() / 2;
+        s.median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+        s.min = samples.front();
+        s.max = samples.back();
+        return s;
+    }
+};
+
+/** Timings and outcomes of one engine on one case and op */
+struct EngineResult {
+    bool ran = false;
+    std::string error;
+    size_t matches = 0;
+    Summary ns;
+    std::vector<std::string> outcomes;
+};
+
+template <typename Engine>
+EngineResult measure(const Engine& re, Op op, const std::vector<std::string>& lines, const Options& options) {
+    EngineResult result;
+    result.ran = true;
+    try {
+        // Untimed pass records what every line produced
+        result.outcomes.resize(lines.size());
+        for (size_t i = 0; i < lines.size(); ++i) {
+            result.matches += run(re, op, lines[i], &result.outcomes[i]);
+        }
+
+        size_t sink = 0;
+        for (int i = 0; i < options.warmup; ++i) {
+            for (const auto& line : lines) sink += run(re, op, line, nullptr);
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < options.reps; ++i) {
+            auto begin = std::chrono::steady_clock::now();
+            for (const auto& line : lines) sink += run(re, op, line, nullptr);
+            auto elapsed = std::chrono::steady_clock::now() - begin;
+            samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count());
+        }
+        result.ns = Summary::of(std::move(samples));
+
+        volatile size_t keep = sink;
+        (void)keep;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        result.outcomes.clear();
+    }
+    return result;
+}
+
+// =============================================================================
+// Output
+// =============================================================================
+
+void writeString(const std::string& text) {
+    std::putchar('"');
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': std::fputs("\\\"", stdout); break;
+            case '\\': std::fputs("\\\\", stdout); break;
+            case '\n': std::fputs("\\n", stdout); break;
+            case '\r': std::fputs("\\r", stdout); break;
+            case '\t': std::fputs("\\t", stdout); break;
+            default:
+                if (c < 0x20 || c >= 0x7f) {
+                    std::printf("\\u%04x", c);
+                } else {
+                    std::putchar(c);
+                }
+        }
+    }
+    std::putchar('"');
+}
+
+void writeEngine(const char* key, const EngineResult& result, size_t bytes, size_t calls) {
+    std::printf(",\"%s\":", key);
+    if (!result.ran) {
+        std::fputs("null", stdout);
+        return;
+    }
+    if (!result.error.empty()) {
+        std::fputs("{\"error\":", stdout);
+        writeString(result.error);
+        std::putchar('}');
+        return;
+    }
+    const Summary& ns = result.ns;
+    std::printf("{\"matches\":%zu,\"ns\":{\"min\":%.0f,\"median\":%.0f,\"mean\":%.0f,\"stddev\":%.0f,\"max\":%.0f}",
+                result.matches, ns.min, ns.median, ns.mean, ns.stddev, ns.max);
+    std::printf(",\"mb_per_s\":%.2f,\"ns_per_call\":%.1f}",
+                ns.median > 0 ? bytes * 1000.0 / ns.median : 0.0,
+                calls > 0 ? ns.median / calls : 0.0);
+}
+
+// =============================================================================
+// Driver
+// =============================================================================
+
+[[noreturn]] void usage() {
+    std::fprintf(stderr, "usage: bench-compare <kind>=<path>... [--reps N] [--warmup N] [--filter S]\n");
+    std::exit(2);
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0) {
+            if (i + 1 >= argc) usage();
+            std::string value = argv[++i];
+            if (arg == "--reps") {
+                options.reps = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--warmup") {
+                options.warmup = std::max(0, std::atoi(value.c_str()));
+            } else if (arg == "--filter") {
+                options.filter = value;
+            } else {
+                usage();
+            }
+            continue;
+        }
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) usage();
+        options.corpora[arg.substr(0, eq)] = arg.substr(eq + 1);
+    }
+    return options;
+}
+
+/** Non-empty lines of a file */
+std::vector<std::string> readLines(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "bench-compare: cannot read %s\n", path.c_str());
+        std::exit(1);
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) lines.push_back(line);
+    }
+    return lines;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+
+    std::map<std::string, std::vector<std::string>> corpora;
+    for (const auto& entry : options.corpora) corpora[entry.first] = readLines(entry.second);
+
+    std::fputs("{\"zregexp\":", stdout);
+    writeString(zregexp::version());
+    std::printf(",\"options\":{\"reps\":%d,\"warmup\":%d},\"results\":[", options.reps, options.warmup);
+
+    bool first = true;
+    int disagreements = 0;
+    for (const Case& c : kCatalogue) {
+        if (!options.filter.empty() && std::strstr(c.name, options.filter.c_str()) == nullptr) continue;
+        auto lines = corpora.find(c.corpus);
+        if (lines == corpora.end()) continue;
+
+        size_t bytes = 0;
+        for (const auto& line : lines->second) bytes += line.size();
+
+        std::optional<zregexp::Regex> zre;
+        std::string zre_error;
+        try {
+            zre.emplace(zregexp::Regex::compile(c.pattern));
+        } catch (const zregexp::RegexError& e) {
+            zre_error = e.what();
+        }
+
+        std::optional<std::regex> sre;
+        std::string sre_error;
+        if (c.std_supported) {
+            try {
+                sre.emplace(c.pattern, std::regex::ECMAScript | std::regex::optimize);
+            } catch (const std::regex_error& e) {
+                sre_error = e.what();
+            }
+        }
+
+        for (Op op : kOps) {
+            std::fprintf(stderr, "compare: %s %s\n", c.name, opName(op));
+
+            EngineResult z, s;
+            if (zre) {
+                z = measure(*zre, op, lines->second, options);
+            } else {
+                z.ran = true;
+                z.error = zre_error;
+            }
+            if (sre) {
+                s = measure(*sre, op, lines->second, options);
+            } else if (c.std_supported) {
+                s.ran = true;
+                s.error = sre_error;
+            }
+
+            std::printf("%s{\"name\":", first ? "" : ",");
+            first = false;
+            writeString(c.name);
+            std::fputs(",\"pattern\":", stdout);
+            writeString(c.pattern);
+            std::printf(",\"corpus\":\"%s\",\"op\":\"%s\",\"bytes\":%zu,\"calls\":%zu",
+                        c.corpus, opName(op), bytes, lines->second.size());
+            writeEngine("zregexp", z, bytes, lines->second.size());
+            writeEngine("std_regex", s, bytes, lines->second.size());
+
+            // Agreement is only meaningful when both engines produced outcomes
+            if (!z.outcomes.empty() && !s.outcomes.empty()) {
+                size_t mismatches = 0;
+                long first_mismatch = -1;
+                for (size_t i = 0; i < z.outcomes.size(); ++i) {
+                    if (z.outcomes[i] != s.outcomes[i]) {
+                        if (first_mismatch < 0) first_mismatch = static_cast<long>(i);
+                        ++mismatches;
+                    }
+                }
+                std::printf(",\"agree\":%s,\"mismatched_lines\":%zu", mismatches == 0 ? "true" : "false", mismatches);
+                if (first_mismatch >= 0) std::printf(",\"first_mismatch\":%ld", first_mismatch);
+                if (mismatches > 0) ++disagreements;
+            }
+            if (z.ran && s.ran && z.ns.median > 0 && s.ns.median > 0) {
+                std::printf(",\"speedup\":%.2f", s.ns.median / z.ns.median);
+            }
+            std::putchar('}');
+        }
+    }
+
+    std::printf("],\"disagreements\":%d}\n", disagreements);
+    return disagreements == 0 ? 0 : 1;
+}
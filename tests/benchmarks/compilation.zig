@@ -0,0 +1,255 @@
+//! Compilation and startup benchmarks
+//!
+//! Compiles generated rule sets of 1k, 10k and 100k patterns (capped by
+//! --rules) in shapes found in real rule files: big keyword alternations,
+//! counted repeats, path and user-agent signatures. For each set it reports
+//! compile throughput, program bytes per pattern and the allocator's peak
+//! during compilation, then how long a process takes to become ready to
+//! match along each startup path:
+//!
+//! - `compile`: compile every pattern from source
+//! - `compile_prepare`: compile, then build the pre-decoded tier (Regex.prepare)
+//! - `registry`: map a registry file saved earlier (registry.zig) and
+//!   materialize every rule from it
+//!
+//! Each phase runs once per set: startup cost is paid once, and the larger
+//! sets take long enough that timer noise does not matter.
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const harness = @import("harness.zig");
+
+const Allocator = std.mem.Allocator;
+const Regex = zregexp.Regex;
+const Registry = zregexp.Registry;
+const CountingAllocator = zregexp.CountingAllocator;
+const Options = harness.Options;
+
+/// Rule set sizes, each capped by --rules
+const set_sizes = [_]usize{ 1_000, 10_000, 100_000 };
+
+/// Where the registry file is written (relative to the working directory)
+const registry_path = ".zig-cache/bench-rules.zrx";
+
+/// Generated patterns (owned)
+const RuleSet = struct {
+    patterns: [][]const u8,
+
+    fn deinit(self: RuleSet, allocator: Allocator) void {
+        for (self.patterns) |pattern| allocator.free(pattern);
+        allocator.free(self.patterns);
+    }
+};
+
+/// `count` patterns of mixed shapes
+fn generateRules(allocator: Allocator, count: usize, seed: u64) !RuleSet {
+    var prng = std.Random.DefaultPrng.init(seed);
+    const random = prng.random();
+
+    const patterns = try allocator.alloc([]const u8, count);
+    var generated: usize = 0;
+    errdefer {
+        for (patterns[0..generated]) |pattern| allocator.free(pattern);
+        allocator.free(patterns);
+    }
+
+    var buf: std.ArrayList(u8) = .empty;
+    defer buf.deinit(allocator);
+
+    for (patterns) |*pattern| {
+        buf.clearRetainingCapacity();
+        const w = buf.writer(allocator);
+        switch (random.uintLessThan(u8, 6)) {
+            // Keyword alternation, up to 64 words
+            0 => {
+                try w.writeAll("\\b(?:");
+                for (0..random.intRangeAtMost(usize, 8, 64)) |k| {
+                    if (k > 0) try w.writeByte('|');
+                    try writeWord(w, random);
+                }
+                try w.writeAll(")\\b");
+            },
+            // Counted repeats
+            1 => try w.print("[A-Z]{{2}}[0-9]{{{d},{d}}}-[a-z]{{1,{d}}}", .{
+                random.intRangeAtMost(u8, 1, 4),
+                random.intRangeAtMost(u8, 5, 12),
+                random.intRangeAtMost(u8, 2, 32),
+            }),
+            // Request path signature
+            2 => {
+                try w.writeAll("^/");
+                try writeWord(w, random);
+                try w.writeAll("/v[0-9]+/");
+                try writeWord(w, random);
+                try w.writeAll("/[0-9]+(\\?.*)?$");
+            },
+            // User-agent signature
+            3 => {
+                try w.writeAll("Mozilla/5\\.0 \\([^)]*");
+                try writeWord(w, random);
+                try w.writeAll("[ /][0-9]+\\.[0-9]+[^)]*\\)");
+            },
+            // Address with a fixed port
+            4 => try w.print("[0-9]{{1,3}}(\\.[0-9]{{1,3}}){{3}}:{d}", .{random.intRangeAtMost(u16, 1024, 65535)}),
+            // Literal with a capture and a backreference
+            else => {
+                try w.writeAll("<(");
+                try writeWord(w, random);
+                try w.writeAll(")[^>]*>.*</\\1>");
+            },
+        }
+        pattern.* = try allocator.dupe(u8, buf.items);
+        generated += 1;
+    }
+    return .{ .patterns = patterns };
+}
+
+fn writeWord(w: anytype, random: std.Random) !void {
+    for (0..random.intRangeAtMost(usize, 3, 10)) |_| {
+        try w.writeByte('a' + random.uintLessThan(u8, 26));
+    }
+}
+
+/// Compiled regexes of one set; failed patterns are skipped and counted
+const Compiled = struct {
+    regexes: std.ArrayList(Regex) = .empty,
+    failed: usize = 0,
+
+    fn deinit(self: *Compiled, allocator: Allocator) void {
+        for (self.regexes.items) |re| re.deinit();
+        self.regexes.deinit(allocator);
+    }
+};
+
+fn compileAll(allocator: Allocator, patterns: []const []const u8) !Compiled {
+    var compiled: Compiled = .{};
+    errdefer compiled.deinit(allocator);
+    try compiled.regexes.ensureTotalCapacity(allocator, patterns.len);
+
+    for (patterns) |pattern| {
+        const re = Regex.compile(allocator, pattern) catch |err| switch (err) {
+            error.OutOfMemory => return err,
+            else => {
+                compiled.failed += 1;
+                continue;
+            },
+        };
+        compiled.regexes.appendAssumeCapacity(re);
+    }
+    return compiled;
+}
+
+/// Run every set size and write a JSON array of results
+pub fn run(allocator: Allocator, options: Options, w: *std.Io.Writer) !void {
+    var first_result = true;
+    try w.writeByte('[');
+
+    for (set_sizes) |count| {
+        if (count > options.rules) break;
+        std.debug.print("compilation: {d} rules\n", .{count});
+
+        const rules = try generateRules(allocator, count, options.seed);
+        defer rules.deinit(allocator);
+
+        if (!first_result) try w.writeByte(',');
+        first_result = false;
+        try runSet(allocator, w, rules);
+    }
+
+    try w.writeByte(']');
+}
+
+fn runSet(allocator: Allocator, w: *std.Io.Writer, rules: RuleSet) !void {
+    var first = true;
+    try w.writeByte('{');
+    try harness.writeKey(w, &first, "rules");
+    try w.print("{d}", .{rules.patterns.len});
+
+    var pattern_bytes: usize = 0;
+    for (rules.patterns) |pattern| pattern_bytes += pattern.len;
+    try harness.writeKey(w, &first, "pattern_bytes");
+    try w.print("{d}", .{pattern_bytes});
+
+    // Compile from source, counting every allocation
+    var counting = CountingAllocator.init(allocator);
+    const counted = counting.allocator();
+
+    var timer = try std.time.Timer.start();
+    var compiled = try compileAll(counted, rules.patterns);
+    defer compiled.deinit(counted);
+    const compile_ns = timer.read();
+
+    const n = compiled.regexes.items.len;
+    var program_bytes: usize = 0;
+    for (compiled.regexes.items) |re| program_bytes += re.memoryUsage().program_bytes;
+    const after_compile = counting.stats();
+
+    try harness.writeKey(w, &first, "compiled");
+    try w.print("{d}", .{n});
+    try harness.writeKey(w, &first, "failed");
+    try w.print("{d}", .{compiled.failed});
+    try harness.writeKey(w, &first, "compile_ns");
+    try w.print("{d}", .{compile_ns});
+    try harness.writeKey(w, &first, "patterns_per_s");
+    try w.print("{d:.0}", .{harness.perSecond(rules.patterns.len, @floatFromInt(compile_ns))});
+    try harness.writeKey(w, &first, "ns_per_pattern");
+    try w.print("{d:.0}", .{@as(f64, @floatFromInt(compile_ns)) / @as(f64, @floatFromInt(rules.patterns.len))});
+    try harness.writeKey(w, &first, "program_bytes_per_pattern");
+    try w.print("{d:.1}", .{perPattern(program_bytes, n)});
+    try harness.writeKey(w, &first, "retained_bytes_per_pattern");
+    try w.print("{d:.1}", .{perPattern(after_compile.live_bytes, n)});
+    try harness.writeKey(w, &first, "compile_peak_bytes");
+    try w.print("{d}", .{after_compile.peak_bytes});
+    try harness.writeKey(w, &first, "compile_allocations");
+    try w.print("{d}", .{after_compile.total_allocations});
+
+    // Precompile: build the decoded tier of every rule
+    timer.reset();
+    for (compiled.regexes.items) |*re| try re.prepare(.{});
+    const prepare_ns = timer.read();
+    try harness.writeKey(w, &first, "prepare_ns");
+    try w.print("{d}", .{prepare_ns});
+    try harness.writeKey(w, &first, "prepared_peak_bytes");
+    try w.print("{d}", .{counting.stats().peak_bytes});
+
+    // Serialize, then start up from the file as a fresh process would
+    timer.reset();
+    const image = try zregexp.registry.serialize(allocator, compiled.regexes.items);
+    defer allocator.free(image);
+    const serialize_ns = timer.read();
+
+    const dir = std.fs.cwd();
+    try dir.makePath(std.fs.path.dirname(registry_path).?);
+    try dir.writeFile(.{ .sub_path = registry_path, .data = image });
+    defer dir.deleteFile(registry_path) catch {};
+
+    var loading = CountingAllocator.init(allocator);
+    timer.reset();
+    const registry = try Registry.open(loading.allocator(), dir, registry_path);
+    defer registry.deinit();
+    const open_ns = timer.read();
+    for (0..registry.len()) |id| _ = try registry.get(id);
+    const materialize_ns = timer.read() - open_ns;
+
+    try harness.writeKey(w, &first, "serialize_ns");
+    try w.print("{d}", .{serialize_ns});
+    try harness.writeKey(w, &first, "registry_bytes");
+    try w.print("{d}", .{image.len});
+    try harness.writeKey(w, &first, "registry_open_ns");
+    try w.print("{d}", .{open_ns});
+    try harness.writeKey(w, &first, "registry_materialize_ns");
+    try w.print("{d}", .{materialize_ns});
+    try harness.writeKey(w, &first, "registry_peak_bytes");
+    try w.print("{d}", .{loading.stats().peak_bytes});
+
+    try harness.writeKey(w, &first, "ready_ns");
+    try w.print("{{\"compile\":{d},\"compile_prepare\":{d},\"registry\":{d}}}", .{
+        compile_ns, compile_ns + prepare_ns, open_ns + materialize_ns,
+    });
+    try w.writeByte('}');
+}
+
+fn perPattern(bytes: usize, count: usize) f64 {
+    if (count == 0) return 0;
+    return @as(f64, @floatFromInt(bytes)) / @as(f64, @floatFromInt(count));
+}
@@ -0,0 +1,188 @@
+//! Benchmark corpora
+//!
+//! Generated inputs, so benchmarks need no downloads and every run sees the
+//! same bytes: the same kind, size and seed always produce the same corpus.
+//! The generators aim for the statistics that matter to a regex engine (line
+//! lengths, alphabet, how often common literals occur), not for realism.
+
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+
+/// Kinds of generated input
+pub const Kind = enum {
+    /// Combined-format HTTP access log lines
+    weblog,
+
+    /// Nested tags with attributes and text
+    html,
+
+    /// English-like sentences and paragraphs
+    prose,
+
+    /// FASTA records over ACGT
+    dna,
+
+    /// Uniformly random bytes
+    binary,
+};
+
+/// Exactly `size` bytes of `kind` (caller frees)
+pub fn generate(allocator: Allocator, kind: Kind, size: usize, seed: u64) Allocator.Error![]u8 {
+    var prng = std.Random.DefaultPrng.init(seed ^ @intFromEnum(kind));
+    const random = prng.random();
+
+    var out: std.ArrayList(u8) = .empty;
+    errdefer out.deinit(allocator);
+    try out.ensureTotalCapacity(allocator, size + 1024);
+
+    while (out.items.len < size) {
+        switch (kind) {
+            .weblog => try weblogLine(allocator, &out, random),
+            .html => try htmlBlock(allocator, &out, random, 0),
+            .prose => try proseParagraph(allocator, &out, random),
+            .dna => try dnaRecord(allocator, &out, random),
+            .binary => {
+                const start = out.items.len;
+                try out.resize(allocator, size);
+                random.bytes(out.items[start..]);
+            },
+        }
+    }
+    out.shrinkRetainingCapacity(size);
+    return out.toOwnedSlice(allocator);
+}
+
+/// Split `text` into lines without their terminators (caller frees the slice)
+pub fn lines(allocator: Allocator, text: []const u8) Allocator.Error![]const []const u8 {
+    var result: std.ArrayList([]const u8) = .empty;
+    errdefer result.deinit(allocator);
+    var it = std.mem.splitScalar(u8, text, '\n');
+    while (it.next()) |line| {
+        if (line.len > 0) try result.append(allocator, line);
+    }
+    return result.toOwnedSlice(allocator);
+}
+
+// =============================================================================
+// Generators
+// =============================================================================
+
+const methods = [_][]const u8{ "GET", "GET", "GET", "POST", "PUT", "DELETE", "HEAD" };
+const statuses = [_]u16{ 200, 200, 200, 200, 301, 304, 404, 500 };
+const path_parts = [_][]const u8{ "api", "v1", "users", "static", "img", "index.html", "search", "login", "cart", "assets" };
+const months = [_][]const u8{ "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+const agents = [_][]const u8{
+    "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36",
+    "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:121.0) Gecko/20100101 Firefox/121.0",
+    "Mozilla/5.0 (iPhone; CPU iPhone OS 17_1 like Mac OS X) AppleWebKit/605.1.15 Mobile/15E148",
+    "curl/8.4.0",
+    "Googlebot/2.1 (+http://www.google.com/bot.html)",
+};
+
+fn weblogLine(allocator: Allocator, out: *std.ArrayList(u8), random: std.Random) Allocator.Error!void {
+    const w = out.writer(allocator);
+    try w.print("{d}.{d}.{d}.{d} - - ", .{
+        random.intRangeAtMost(u8, 1, 223),
+        random.int(u8),
+        random.int(u8),
+        random.intRangeAtMost(u8, 1, 254),
+    });
+    try w.print("[{d:0>2}/{s}/2024:{d:0>2}:{d:0>2}:{d:0>2} +0000] ", .{
+        random.intRangeAtMost(u8, 1, 28),
+        months[random.uintLessThan(usize, months.len)],
+        random.uintLessThan(u8, 24),
+        random.uintLessThan(u8, 60),
+        random.uintLessThan(u8, 60),
+    });
+    try w.print("\"{s} ", .{methods[random.uintLessThan(usize, methods.len)]});
+    for (0..random.intRangeAtMost(usize, 1, 4)) |_| {
+        try w.print("/{s}", .{path_parts[random.uintLessThan(usize, path_parts.len)]});
+    }
+    if (random.boolean()) try w.print("?id={d}", .{random.uintLessThan(u32, 100000)});
+    try w.print(" HTTP/1.1\" {d} {d} \"-\" \"{s}\"\n", .{
+        statuses[random.uintLessThan(usize, statuses.len)],
+        random.uintLessThan(u32, 50000),
+        agents[random.uintLessThan(usize, agents.len)],
+    });
+}
+
+const words = [_][]const u8{
+    "the", "of", "and", "to", "a", "in", "that", "is", "was", "he", "for", "it", "with", "as",
+    "his", "on", "be", "at", "by", "had", "not", "are", "but", "from", "or", "have", "an", "they",
+    "which", "one", "you", "were", "her", "all", "she", "there", "would", "their", "we", "him",
+    "been", "has", "when", "who", "will", "more", "no", "if", "out", "so", "time", "people", "year",
+    "way", "day", "man", "thing", "woman", "life", "child", "world", "school", "state", "family",
+    "student", "group", "country", "problem", "hand", "part", "place", "case", "week", "company",
+    "system", "program", "question", "work", "government", "number", "night", "point", "home",
+    "water", "room", "mother", "area", "money", "story", "fact", "Sherlock", "Holmes", "Watson",
+    "London", "Baker", "Street", "Moriarty", "Lestrade", "Hudson", "Adler",
+};
+
+fn proseParagraph(allocator: Allocator, out: *std.ArrayList(u8), random: std.Random) Allocator.Error!void {
+    for (0..random.intRangeAtMost(usize, 2, 6)) |_| {
+        const count = random.intRangeAtMost(usize, 5, 20);
+        for (0..count) |i| {
+            const word = words[random.uintLessThan(usize, words.len)];
+            if (i == 0) {
+                try out.append(allocator, std.ascii.toUpper(word[0]));
+                try out.appendSlice(allocator, word[1..]);
+            } else {
+                try out.appendSlice(allocator, word);
+            }
+            if (i + 1 < count) {
+                try out.appendSlice(allocator, if (random.uintLessThan(u8, 10) == 0) ", " else " ");
+            }
+        }
+        try out.appendSlice(allocator, switch (random.uintLessThan(u8, 8)) {
+            0 => "? ",
+            1 => "! ",
+            else => ". ",
+        });
+    }
+    try out.appendSlice(allocator, "\n\n");
+}
+
+const tags = [_][]const u8{ "div", "span", "p", "a", "li", "ul", "section", "em", "strong" };
+const attributes = [_][]const u8{ "class", "id", "href", "title", "data-id" };
+
+fn htmlBlock(allocator: Allocator, out: *std.ArrayList(u8), random: std.Random, depth: usize) Allocator.Error!void {
+    const tag = tags[random.uintLessThan(usize, tags.len)];
+    const w = out.writer(allocator);
+
+    try w.print("<{s}", .{tag});
+    for (0..random.uintLessThan(usize, 3)) |_| {
+        const name = attributes[random.uintLessThan(usize, attributes.len)];
+        if (std.mem.eql(u8, name, "href")) {
+            try w.print(" href=\"https://example.com/{s}/{d}\"", .{ words[random.uintLessThan(usize, words.len)], random.uintLessThan(u32, 1000) });
+        } else {
+            try w.print(" {s}=\"{s}-{d}\"", .{ name, words[random.uintLessThan(usize, words.len)], random.uintLessThan(u32, 100) });
+        }
+    }
+    try out.append(allocator, '>');
+
+    for (0..random.intRangeAtMost(usize, 1, 4)) |_| {
+        if (depth < 4 and random.boolean()) {
+            try htmlBlock(allocator, out, random, depth + 1);
+        } else {
+            for (0..random.intRangeAtMost(usize, 1, 8)) |_| {
+                try w.print("{s} ", .{words[random.uintLessThan(usize, words.len)]});
+            }
+            if (random.uintLessThan(u8, 8) == 0) try out.appendSlice(allocator, "&amp; ");
+        }
+    }
+    try w.print("</{s}>", .{tag});
+    if (depth <= 1) try out.append(allocator, '\n');
+}
+
+fn dnaRecord(allocator: Allocator, out: *std.ArrayList(u8), random: std.Random) Allocator.Error!void {
+    const w = out.writer(allocator);
+    try w.print(">seq{d} synthetic\n", .{random.uintLessThan(u32, 1_000_000)});
+
+    const bases = "ACGT";
+    for (0..random.intRangeAtMost(usize, 4, 40)) |_| {
+        var line: [60]u8 = undefined;
+        for (&line) |*c| c.* = bases[random.uintLessThan(usize, 4)];
+        try out.appendSlice(allocator, &line);
+        try out.append(allocator, '\n');
+    }
+}
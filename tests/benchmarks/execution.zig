@@ -0,0 +1,235 @@
+//! Execution benchmarks
+//!
+//! Runs a fixed pattern catalogue over the generated corpora (corpus.zig) in
+//! every execution tier and search strategy the engine has:
+//!
+//! - engine: `interpreted` (bytecode decoded per step) or `decoded` (the
+//!   pre-decoded program built by Regex.prepare)
+//! - strategy: `whole` (one call over the full corpus) or `lines` (one call
+//!   per line, the shape of log and record processing)
+//! - op: isMatch, find, findAll or replace
+//!
+//! Each combination reports MB/s, matches/s and ns per call, with the
+//! distribution of per-repetition times. A call that fails (for example on
+//! the step budget) is reported with its error instead of timings.
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const corpus = @import("corpus.zig");
+const harness = @import("harness.zig");
+
+const Allocator = std.mem.Allocator;
+const Regex = zregexp.Regex;
+const Options = harness.Options;
+const Op = harness.Op;
+
+/// Pattern families in the catalogue
+pub const Category = enum {
+    literal,
+    class,
+    alternation,
+    anchored,
+    lookaround,
+    backref,
+};
+
+/// One catalogue entry
+pub const Case = struct {
+    name: []const u8,
+    category: Category,
+    pattern: []const u8,
+    corpus: corpus.Kind,
+};
+
+/// Fixed pattern catalogue; names are stable so results can be compared across runs
+pub const catalogue = [_]Case{
+    .{ .name = "literal/mozilla", .category = .literal, .pattern = "Mozilla", .corpus = .weblog },
+    .{ .name = "literal/sherlock", .category = .literal, .pattern = "Sherlock", .corpus = .prose },
+    .{ .name = "literal/gattaca", .category = .literal, .pattern = "GATTACA", .corpus = .dna },
+    .{ .name = "literal/elf", .category = .literal, .pattern = "\x7fELF", .corpus = .binary },
+
+    .{ .name = "class/digits", .category = .class, .pattern = "[0-9]+", .corpus = .weblog },
+    .{ .name = "class/capitalized", .category = .class, .pattern = "[A-Z][a-z]+", .corpus = .prose },
+    .{ .name = "class/tag", .category = .class, .pattern = "<[a-z]+", .corpus = .html },
+    .{ .name = "class/gc-run", .category = .class, .pattern = "[GC]{6}", .corpus = .dna },
+    .{ .name = "class/control", .category = .class, .pattern = "[\x00-\x08]{4}", .corpus = .binary },
+
+    .{ .name = "alternation/names", .category = .alternation, .pattern = "Sherlock|Holmes|Watson|Moriarty", .corpus = .prose },
+    .{ .name = "alternation/methods", .category = .alternation, .pattern = "GET|POST|PUT|DELETE", .corpus = .weblog },
+    .{ .name = "alternation/motifs", .category = .alternation, .pattern = "AGT(A|C)GT|TTT(G|T)AA", .corpus = .dna },
+
+    .{ .name = "anchored/ip", .category = .anchored, .pattern = "^[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+", .corpus = .weblog },
+    .{ .name = "anchored/header", .category = .anchored, .pattern = "^>seq[0-9]+", .corpus = .dna },
+    .{ .name = "anchored/sentence-end", .category = .anchored, .pattern = "[a-z]+[.!?] $", .corpus = .prose },
+
+    .{ .name = "lookaround/href", .category = .lookaround, .pattern = "(?<=href=\")[^\"]+", .corpus = .html },
+    .{ .name = "lookaround/status", .category = .lookaround, .pattern = "[0-9]{3}(?= [0-9]+ \")", .corpus = .weblog },
+    .{ .name = "lookaround/not-street", .category = .lookaround, .pattern = "\\b[A-Z][a-z]+(?! Street)", .corpus = .prose },
+
+    .{ .name = "backref/element", .category = .backref, .pattern = "<([a-z]+)[^>]*>[^<]*</\\1>", .corpus = .html },
+    .{ .name = "backref/repeated-word", .category = .backref, .pattern = "\\b([a-z]+) \\1\\b", .corpus = .prose },
+    .{ .name = "backref/triplet", .category = .backref, .pattern = "([ACGT]{3})\\1\\1", .corpus = .dna },
+};
+
+pub const Engine = enum {
+    interpreted,
+    decoded,
+};
+
+pub const Strategy = enum {
+    whole,
+    lines,
+};
+
+/// Generated corpora and their lines, one per kind
+const Corpora = struct {
+    text: [std.meta.fields(corpus.Kind).len][]const u8,
+    lines: [std.meta.fields(corpus.Kind).len][]const []const u8,
+
+    fn init(allocator: Allocator, options: Options) !Corpora {
+        var self: Corpora = undefined;
+        for (std.enums.values(corpus.Kind), 0..) |kind, i| {
+            self.text[i] = try corpus.generate(allocator, kind, options.size, options.seed);
+            self.lines[i] = try corpus.lines(allocator, self.text[i]);
+        }
+        return self;
+    }
+
+    fn deinit(self: Corpora, allocator: Allocator) void {
+        for (self.text, self.lines) |text, lines| {
+            allocator.free(lines);
+            allocator.free(text);
+        }
+    }
+
+    fn inputs(self: *const Corpora, kind: corpus.Kind, strategy: Strategy) []const []const u8 {
+        const i = @intFromEnum(kind);
+        return switch (strategy) {
+            .whole => (&self.text[i])[0..1],
+            .lines => self.lines[i],
+        };
+    }
+};
+
+/// One timed combination: an op over every input
+const Run = struct {
+    re: *const Regex,
+    inputs: []const []const u8,
+    op: Op,
+
+    fn call(self: *const Run) anyerror!u64 {
+        var matches: u64 = 0;
+        for (self.inputs) |input| matches += try harness.runOp(self.re, self.op, input);
+        return matches;
+    }
+};
+
+/// Run the catalogue and write a JSON array of results
+pub fn run(allocator: Allocator, options: Options, w: *std.Io.Writer) !void {
+    const corpora = try Corpora.init(allocator, options);
+    defer corpora.deinit(allocator);
+
+    var sink: u64 = 0;
+    var first_result = true;
+    try w.writeByte('[');
+
+    for (catalogue) |case| {
+        if (!options.selects(case.name)) continue;
+
+        for (std.enums.values(Engine)) |engine| {
+            var re = Regex.compile(allocator, case.pattern) catch |err| {
+                try writeCompileFailure(w, &first_result, case, engine, err);
+                continue;
+            };
+            defer re.deinit();
+            if (engine == .decoded) try re.prepare(.{});
+
+            for (std.enums.values(Strategy)) |strategy| {
+                for (std.enums.values(Op)) |op| {
+                    std.debug.print("execution: {s} {s} {s} {s}\n", .{ case.name, @tagName(engine), @tagName(strategy), @tagName(op) });
+                    const r: Run = .{ .re = &re, .inputs = corpora.inputs(case.corpus, strategy), .op = op };
+                    try measureRun(allocator, options, w, &first_result, case, engine, strategy, &r, &sink);
+                }
+            }
+        }
+    }
+
+    try w.writeByte(']');
+    std.mem.doNotOptimizeAway(sink);
+}
+
+fn measureRun(
+    allocator: Allocator,
+    options: Options,
+    w: *std.Io.Writer,
+    first_result: *bool,
+    case: Case,
+    engine: Engine,
+    strategy: Strategy,
+    r: *const Run,
+    sink: *u64,
+) !void {
+    if (!first_result.*) try w.writeByte(',');
+    first_result.* = false;
+
+    var first = true;
+    try w.writeByte('{');
+    try writeCaseFields(w, &first, case, engine);
+    try harness.writeKey(w, &first, "strategy");
+    try harness.writeJsonString(w, @tagName(strategy));
+    try harness.writeKey(w, &first, "op");
+    try harness.writeJsonString(w, @tagName(r.op));
+
+    var bytes: usize = 0;
+    for (r.inputs) |input| bytes += input.len;
+    try harness.writeKey(w, &first, "bytes");
+    try w.print("{d}", .{bytes});
+    try harness.writeKey(w, &first, "calls");
+    try w.print("{d}", .{r.inputs.len});
+
+    // The first call doubles as a correctness probe: a budget error skips timing
+    const matches = r.call() catch |err| {
+        try harness.writeKey(w, &first, "error");
+        try harness.writeJsonString(w, @errorName(err));
+        try w.writeByte('}');
+        return;
+    };
+    try harness.writeKey(w, &first, "matches");
+    try w.print("{d}", .{matches});
+
+    const time = try harness.measure(allocator, options, r, Run.call, sink);
+    try harness.writeKey(w, &first, "ns");
+    try time.writeJson(w);
+    try harness.writeKey(w, &first, "mb_per_s");
+    try w.print("{d:.2}", .{harness.megabytesPerSecond(bytes, time.median)});
+    try harness.writeKey(w, &first, "matches_per_s");
+    try w.print("{d:.0}", .{harness.perSecond(matches, time.median)});
+    try harness.writeKey(w, &first, "ns_per_call");
+    try w.print("{d:.1}", .{if (r.inputs.len == 0) 0 else time.median / @as(f64, @floatFromInt(r.inputs.len))});
+    try w.writeByte('}');
+}
+
+fn writeCaseFields(w: *std.Io.Writer, first: *bool, case: Case, engine: Engine) !void {
+    try harness.writeKey(w, first, "name");
+    try harness.writeJsonString(w, case.name);
+    try harness.writeKey(w, first, "category");
+    try harness.writeJsonString(w, @tagName(case.category));
+    try harness.writeKey(w, first, "pattern");
+    try harness.writeJsonString(w, case.pattern);
+    try harness.writeKey(w, first, "corpus");
+    try harness.writeJsonString(w, @tagName(case.corpus));
+    try harness.writeKey(w, first, "engine");
+    try harness.writeJsonString(w, @tagName(engine));
+}
+
+fn writeCompileFailure(w: *std.Io.Writer, first_result: *bool, case: Case, engine: Engine, err: anyerror) !void {
+    if (!first_result.*) try w.writeByte(',');
+    first_result.* = false;
+
+    var first = true;
+    try w.writeByte('{');
+    try writeCaseFields(w, &first, case, engine);
+    try harness.writeKey(w, &first, "error");
+    try harness.writeJsonString(w, @errorName(err));
+    try w.writeByte('}');
+}
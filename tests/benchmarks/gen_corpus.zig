@@ -0,0 +1,30 @@
+//! Corpus writer
+//!
+//! `gen-corpus <kind> <size> <seed> <path>` writes one generated corpus
+//! (corpus.zig) to a file, so benchmarks outside Zig see the same bytes as
+//! the Zig suites.
+
+const std = @import("std");
+const corpus = @import("corpus.zig");
+
+pub fn main() !void {
+    const allocator = std.heap.smp_allocator;
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+    if (args.len != 5) {
+        std.debug.print("usage: gen-corpus <kind> <size> <seed> <path>\n", .{});
+        std.process.exit(2);
+    }
+
+    const kind = std.meta.stringToEnum(corpus.Kind, args[1]) orelse {
+        std.debug.print("gen-corpus: unknown kind '{s}'\n", .{args[1]});
+        std.process.exit(2);
+    };
+    const size = try std.fmt.parseInt(usize, args[2], 10);
+    const seed = try std.fmt.parseInt(u64, args[3], 10);
+
+    const text = try corpus.generate(allocator, kind, size, seed);
+    defer allocator.free(text);
+    try std.fs.cwd().writeFile(.{ .sub_path = args[4], .data = text });
+}
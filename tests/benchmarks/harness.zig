@@ -0,0 +1,241 @@
+//! Benchmark harness
+//!
+//! Shared pieces of the benchmark suites: command-line options, timing with
+//! warm-up and repetitions, summary statistics and a small JSON writer. Every
+//! suite prints one JSON document to stdout so results can be stored and
+//! diffed between commits.
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+
+const Regex = zregexp.Regex;
+
+/// Options common to all suites
+pub const Options = struct {
+    /// Untimed runs before measuring
+    warmup: usize = 2,
+
+    /// Timed runs per measurement
+    reps: usize = 10,
+
+    /// Corpus size in bytes
+    size: usize = 256 * 1024,
+
+    /// Only run cases whose name contains this
+    filter: ?[]const u8 = null,
+
+    /// Seed for generated inputs
+    seed: u64 = 0x5eed,
+
+    /// Largest generated rule set
+    rules: usize = 100_000,
+
+    /// Whether a case named `name` passes the filter
+    pub fn selects(self: Options, name: []const u8) bool {
+        const filter = self.filter orelse return true;
+        return std.mem.indexOf(u8, name, filter) != null;
+    }
+};
+
+pub const ParseError = error{InvalidArgument};
+
+/// Parse `--warmup N --reps N --size N --filter S --seed N --rules N`; returns the
+/// remaining positional arguments in `rest`
+pub fn parseOptions(args: []const []const u8, rest: *std.ArrayList([]const u8), allocator: std.mem.Allocator) !Options {
+    var options: Options = .{};
+    var i: usize = 0;
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+        if (!std.mem.startsWith(u8, arg, "--")) {
+            try rest.append(allocator, arg);
+            continue;
+        }
+        if (i + 1 >= args.len) return error.InvalidArgument;
+        const value = args[i + 1];
+        i += 1;
+
+        if (std.mem.eql(u8, arg, "--warmup")) {
+            options.warmup = try parseCount(value);
+        } else if (std.mem.eql(u8, arg, "--reps")) {
+            options.reps = @max(1, try parseCount(value));
+        } else if (std.mem.eql(u8, arg, "--size")) {
+            options.size = try parseCount(value);
+        } else if (std.mem.eql(u8, arg, "--seed")) {
+            options.seed = try parseCount(value);
+        } else if (std.mem.eql(u8, arg, "--rules")) {
+            options.rules = try parseCount(value);
+        } else if (std.mem.eql(u8, arg, "--filter")) {
+            options.filter = value;
+        } else {
+            return error.InvalidArgument;
+        }
+    }
+    return options;
+}
+
+/// Decimal count with an optional k/m/g suffix (powers of 1024)
+fn parseCount(text: []const u8) ParseError!usize {
+    if (text.len == 0) return error.InvalidArgument;
+    const multiplier: usize = switch (std.ascii.toLower(text[text.len - 1])) {
+        'k' => 1 << 10,
+        'm' => 1 << 20,
+        'g' => 1 << 30,
+        else => 1,
+    };
+    const digits = if (multiplier == 1) text else text[0 .. text.len - 1];
+    const value = std.fmt.parseInt(usize, digits, 10) catch return error.InvalidArgument;
+    return std.math.mul(usize, value, multiplier) catch error.InvalidArgument;
+}
+
+/// Summary of a set of timings, in nanoseconds
+pub const Summary = struct {
+    min: f64,
+    median: f64,
+    mean: f64,
+    stddev: f64,
+    max: f64,
+
+    /// Summarize `samples` (sorted in place)
+    pub fn of(samples: []u64) Summary {
+        std.debug.assert(samples.len > 0);
+        std.mem.sort(u64, samples, {}, std.sort.asc(u64));
+
+        var sum: f64 = 0;
+        for (samples) |s| sum += @floatFromInt(s);
+        const mean = sum / @as(f64, @floatFromInt(samples.len));
+
+        var squares: f64 = 0;
+        for (samples) |s| {
+            const d = @as(f64, @floatFromInt(s)) - mean;
+            squares += d * d;
+        }
+
+        const mid = samples.len / 2;
+        const median: f64 = if (samples.len % 2 == 1)
+            @floatFromInt(samples[mid])
+        else
+            (@as(f64, @floatFromInt(samples[mid - 1])) + @as(f64, @floatFromInt(samples[mid]))) / 2;
+
+        return .{
+            .min = @floatFromInt(samples[0]),
+            .median = median,
+            .mean = mean,
+            .stddev = @sqrt(squares / @as(f64, @floatFromInt(samples.len))),
+            .max = @floatFromInt(samples[samples.len - 1]),
+        };
+    }
+
+    pub fn writeJson(self: Summary, w: *std.Io.Writer) !void {
+        try w.print("{{\"min\":{d:.0},\"median\":{d:.0},\"mean\":{d:.0},\"stddev\":{d:.0},\"max\":{d:.0}}}", .{
+            self.min, self.median, self.mean, self.stddev, self.max,
+        });
+    }
+};
+
+/// Time `reps` calls of `func(context)` after `warmup` untimed calls
+/// `func` returns a value folded into `sink` so the work is not optimized away.
+pub fn measure(
+    allocator: std.mem.Allocator,
+    options: Options,
+    context: anytype,
+    comptime func: fn (@TypeOf(context)) anyerror!u64,
+    sink: *u64,
+) !Summary {
+    for (0..options.warmup) |_| sink.* +%= try func(context);
+
+    const samples = try allocator.alloc(u64, options.reps);
+    defer allocator.free(samples);
+
+    for (samples) |*sample| {
+        var timer = try std.time.Timer.start();
+        sink.* +%= try func(context);
+        sample.* = timer.read();
+    }
+    return Summary.of(samples);
+}
+
+/// Search operations the suites time
+pub const Op = enum {
+    is_match,
+    find,
+    find_all,
+    replace,
+};
+
+/// Replacement text for `.replace` (no group references)
+pub const replacement = "#";
+
+/// Run `op` once over `input`; returns the number of matches
+pub fn runOp(re: *const Regex, op: Op, input: []const u8) !u64 {
+    switch (op) {
+        .is_match => return @intFromBool(try re.isMatch(input)),
+        .find => {
+            const match = try re.find(input) orelse return 0;
+            match.deinit();
+            return 1;
+        },
+        .find_all => {
+            var matches = try re.findAll(input);
+            defer {
+                for (matches.items) |match| match.deinit();
+                matches.deinit(re.allocator);
+            }
+            return matches.items.len;
+        },
+        // What zregexp_replace does, minus the final C string copy
+        .replace => {
+            var matches = try re.findAll(input);
+            defer {
+                for (matches.items) |match| match.deinit();
+                matches.deinit(re.allocator);
+            }
+
+            var out: std.ArrayList(u8) = .empty;
+            defer out.deinit(re.allocator);
+            var last_end: usize = 0;
+            for (matches.items) |match| {
+                try out.appendSlice(re.allocator, input[last_end..match.start]);
+                try out.appendSlice(re.allocator, replacement);
+                last_end = match.end;
+            }
+            try out.appendSlice(re.allocator, input[last_end..]);
+            return matches.items.len;
+        },
+    }
+}
+
+/// Bytes per nanosecond to MB/s (10^6 bytes)
+pub fn megabytesPerSecond(bytes: usize, ns: f64) f64 {
+    if (ns == 0) return 0;
+    return @as(f64, @floatFromInt(bytes)) * 1000.0 / ns;
+}
+
+/// Events per nanosecond to events per second
+pub fn perSecond(count: u64, ns: f64) f64 {
+    if (ns == 0) return 0;
+    return @as(f64, @floatFromInt(count)) * 1e9 / ns;
+}
+
+/// JSON string literal with escapes
+pub fn writeJsonString(w: *std.Io.Writer, text: []const u8) !void {
+    try w.writeByte('"');
+    for (text) |c| switch (c) {
+        '"' => try w.writeAll("\\\""),
+        '\\' => try w.writeAll("\\\\"),
+        '\n' => try w.writeAll("\\n"),
+        '\r' => try w.writeAll("\\r"),
+        '\t' => try w.writeAll("\\t"),
+        0...8, 11, 12, 14...0x1F, 0x7F...0xFF => try w.print("\\u{x:0>4}", .{c}),
+        else => try w.writeByte(c),
+    };
+    try w.writeByte('"');
+}
+
+/// `"key":` prefix, with a comma unless it is the first member
+pub fn writeKey(w: *std.Io.Writer, first: *bool, key: []const u8) !void {
+    if (!first.*) try w.writeByte(',');
+    first.* = false;
+    try writeJsonString(w, key);
+    try w.writeByte(':');
+}
+
@@ -0,0 +1,229 @@
+//! Tail-latency benchmarks
+//!
+//! Times every call on its own and reports the distribution (p50, p90, p99,
+//! p99.9, max) rather than an average, so the rare slow call shows: a lazy
+//! setup on first use, an allocation spike, a start-position loop over a
+//! large body. Calls go into a metrics.LogHistogram with 128 sub-buckets per
+//! power of two (under 1% error).
+//!
+//! Inputs are slices of the case's corpus whose sizes follow a request mix:
+//! log-normal short strings (median 64 bytes), plus an occasional large body of
+//! 16-256 KiB (capped by --size). Each op runs in two modes:
+//!
+//! - `warm`: --warmup untimed passes over the inputs, then 2000 x --reps timed
+//!   calls back to back
+//! - `cold`: a few calls, each after overwriting a buffer larger than the
+//!   last-level cache
+//!
+//! Each case also records how long the first search after compilation took.
+//! The regex is not prepared beforehand, so that time includes lazy setup.
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const corpus = @import("corpus.zig");
+const execution = @import("execution.zig");
+const harness = @import("harness.zig");
+
+const Allocator = std.mem.Allocator;
+const Regex = zregexp.Regex;
+const Options = harness.Options;
+const Op = harness.Op;
+
+/// Timed warm calls per --reps
+const calls_per_rep = 2000;
+
+/// Timed calls in cold mode (each pays for a cache flush)
+const cold_calls = 100;
+
+/// Bytes overwritten before a cold call; larger than common last-level caches
+const evict_bytes = 64 * 1024 * 1024;
+
+/// Short inputs: log-normal sizes around this median
+const short_median = 64.0;
+const short_sigma = 1.0;
+
+/// Share of calls on a large body, and its size range
+const large_fraction = 0.01;
+const large_min = 16 * 1024;
+const large_max = 256 * 1024;
+
+const Mode = enum {
+    warm,
+    cold,
+};
+
+/// Histogram of call times (or input sizes); 7 sub-bucket bits keep values within 1%
+const Histogram = zregexp.metrics.LogHistogram(7, 40);
+
+/// A histogram plus the exact extremes, written as one JSON object
+const Distribution = struct {
+    histogram: Histogram = .{},
+    min: u64 = std.math.maxInt(u64),
+    max: u64 = 0,
+
+    fn record(self: *Distribution, value: u64) void {
+        self.histogram.record(value);
+        self.min = @min(self.min, value);
+        self.max = @max(self.max, value);
+    }
+
+    /// Value at quantile `q`, kept within the recorded extremes
+    fn quantile(self: *const Distribution, q: f64) u64 {
+        return std.math.clamp(self.histogram.percentile(q), self.min, self.max);
+    }
+
+    fn writeJson(self: *const Distribution, w: *std.Io.Writer) !void {
+        const total = self.histogram.count();
+        if (total == 0) return w.writeAll("{\"count\":0,\"min\":0,\"p50\":0,\"p90\":0,\"p99\":0,\"p999\":0,\"max\":0,\"mean\":0}");
+        const mean = @as(f64, @floatFromInt(self.histogram.sum)) / @as(f64, @floatFromInt(total));
+        try w.print("{{\"count\":{d},\"min\":{d},\"p50\":{d},\"p90\":{d},\"p99\":{d},\"p999\":{d},\"max\":{d},\"mean\":{d:.0}}}", .{
+            total,
+            self.min,
+            self.quantile(0.5),
+            self.quantile(0.9),
+            self.quantile(0.99),
+            self.quantile(0.999),
+            self.max,
+            mean,
+        });
+    }
+};
+
+/// `count` slices of `text` with request-like sizes
+fn sampleInputs(allocator: Allocator, text: []const u8, count: usize, seed: u64) Allocator.Error![]const []const u8 {
+    var prng = std.Random.DefaultPrng.init(seed);
+    const random = prng.random();
+
+    const inputs = try allocator.alloc([]const u8, count);
+    for (inputs) |*input| {
+        const wanted: usize = if (random.float(f64) < large_fraction)
+            random.intRangeAtMost(usize, large_min, large_max)
+        else
+            @intFromFloat(@min(@exp(@log(short_median) + short_sigma * random.floatNorm(f64)), large_min));
+        const len = @min(@max(wanted, 1), text.len);
+        const start = random.uintAtMost(usize, text.len - len);
+        input.* = text[start..][0..len];
+    }
+    return inputs;
+}
+
+/// Touch every cache line of `buffer` so the next call starts with cold caches
+fn evictCaches(buffer: []u8) void {
+    const bytes: [*]volatile u8 = buffer.ptr;
+    var i: usize = 0;
+    while (i < buffer.len) : (i += 64) bytes[i] +%= 1;
+}
+
+/// Run the catalogue and write a JSON array of results
+pub fn run(allocator: Allocator, options: Options, w: *std.Io.Writer) !void {
+    const evict = try allocator.alloc(u8, evict_bytes);
+    defer allocator.free(evict);
+    @memset(evict, 0);
+
+    var corpora: [std.meta.fields(corpus.Kind).len]?[]u8 = @splat(null);
+    defer {
+        for (corpora) |text| {
+            if (text) |t| allocator.free(t);
+        }
+    }
+
+    var sink: u64 = 0;
+    var first_result = true;
+    try w.writeByte('[');
+
+    for (execution.catalogue) |case| {
+        if (!options.selects(case.name)) continue;
+        std.debug.print("latency: {s}\n", .{case.name});
+
+        const slot = &corpora[@intFromEnum(case.corpus)];
+        if (slot.* == null) slot.* = try corpus.generate(allocator, case.corpus, options.size, options.seed);
+        const inputs = try sampleInputs(allocator, slot.*.?, calls_per_rep * options.reps, options.seed);
+        defer allocator.free(inputs);
+
+        if (!first_result) try w.writeByte(',');
+        first_result = false;
+        try runCase(allocator, options, w, case, inputs, evict, &sink);
+    }
+
+    try w.writeByte(']');
+    std.mem.doNotOptimizeAway(sink);
+}
+
+fn runCase(
+    allocator: Allocator,
+    options: Options,
+    w: *std.Io.Writer,
+    case: execution.Case,
+    inputs: []const []const u8,
+    evict: []u8,
+    sink: *u64,
+) !void {
+    var first = true;
+    try w.writeByte('{');
+    try harness.writeKey(w, &first, "name");
+    try harness.writeJsonString(w, case.name);
+    try harness.writeKey(w, &first, "pattern");
+    try harness.writeJsonString(w, case.pattern);
+
+    var sizes: Distribution = .{};
+    for (inputs) |input| sizes.record(input.len);
+    try harness.writeKey(w, &first, "input_bytes");
+    try sizes.writeJson(w);
+
+    var timer = try std.time.Timer.start();
+    const re = Regex.compile(allocator, case.pattern) catch |err| {
+        try harness.writeKey(w, &first, "error");
+        try harness.writeJsonString(w, @errorName(err));
+        try w.writeByte('}');
+        return;
+    };
+    defer re.deinit();
+    try harness.writeKey(w, &first, "compile_ns");
+    try w.print("{d}", .{timer.read()});
+
+    timer.reset();
+    const first_call = re.isMatch(inputs[0]);
+    try harness.writeKey(w, &first, "first_call_ns");
+    try w.print("{d}", .{timer.read()});
+    if (first_call) |matched| sink.* +%= @intFromBool(matched) else |_| {}
+
+    for (std.enums.values(Op)) |op| {
+        try harness.writeKey(w, &first, @tagName(op));
+        var op_first = true;
+        try w.writeByte('{');
+        inline for (comptime std.enums.values(Mode)) |mode| {
+            const passes = if (mode == .warm) options.warmup else 0;
+            for (0..passes) |_| {
+                for (inputs) |input| sink.* +%= harness.runOp(&re, op, input) catch 0;
+            }
+
+            var times: Distribution = .{};
+            const calls = if (mode == .warm) inputs else inputs[0..@min(inputs.len, cold_calls)];
+            const errors = try timeCalls(&re, op, calls, if (mode == .cold) evict else null, &times, sink);
+
+            try harness.writeKey(w, &op_first, @tagName(mode));
+            try times.writeJson(w);
+            // Errors (such as a tripped step budget) are timed like any other call
+            if (errors > 0) {
+                try harness.writeKey(w, &op_first, @tagName(mode) ++ "_errors");
+                try w.print("{d}", .{errors});
+            }
+        }
+        try w.writeByte('}');
+    }
+    try w.writeByte('}');
+}
+
+/// Time each call on its own; returns the number of calls that failed
+fn timeCalls(re: *const Regex, op: Op, inputs: []const []const u8, evict: ?[]u8, times: *Distribution, sink: *u64) !u64 {
+    var errors: u64 = 0;
+    var timer = try std.time.Timer.start();
+    for (inputs) |input| {
+        if (evict) |buffer| evictCaches(buffer);
+        timer.reset();
+        const result = harness.runOp(re, op, input);
+        times.record(timer.read());
+        if (result) |matches| sink.* +%= matches else |_| errors += 1;
+    }
+    return errors;
+}
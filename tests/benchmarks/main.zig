@@ -0,0 +1,102 @@
+//! Benchmark runner
+//!
+//! `zig build bench -- [suite...] [--size N] [--reps N] [--warmup N]
+//! [--filter S] [--seed N] [--rules N]` runs the named suites (all of them
+//! when none is given) and prints one JSON document to stdout; progress goes
+//! to stderr. Sizes and counts accept k/m/g suffixes. Build with
+//! -Dbench-optimize to change the optimization mode (ReleaseFast by default).
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const harness = @import("harness.zig");
+const execution = @import("execution.zig");
+const adversarial = @import("adversarial.zig");
+const compilation = @import("compilation.zig");
+const memory = @import("memory.zig");
+const scaling = @import("scaling.zig");
+const latency = @import("latency.zig");
+
+const Allocator = std.mem.Allocator;
+const Options = harness.Options;
+
+const Suite = struct {
+    name: []const u8,
+    run: *const fn (Allocator, Options, *std.Io.Writer) anyerror!void,
+};
+
+const suites = [_]Suite{
+    .{ .name = "execution", .run = execution.run },
+    .{ .name = "redos", .run = adversarial.run },
+    .{ .name = "compilation", .run = compilation.run },
+    .{ .name = "allocations", .run = memory.run },
+    .{ .name = "scaling", .run = scaling.run },
+    .{ .name = "latency", .run = latency.run },
+};
+
+pub fn main() !void {
+    const allocator = std.heap.smp_allocator;
+
+    const argv = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, argv);
+    const args = try allocator.alloc([]const u8, argv.len - 1);
+    defer allocator.free(args);
+    for (args, argv[1..]) |*arg, raw| arg.* = raw;
+
+    var names: std.ArrayList([]const u8) = .empty;
+    defer names.deinit(allocator);
+    const options = harness.parseOptions(args, &names, allocator) catch usage();
+    for (names.items) |name| {
+        if (findSuite(name) == null) usage();
+    }
+
+    var buffer: [64 * 1024]u8 = undefined;
+    var stdout = std.fs.File.stdout().writer(&buffer);
+    const w = &stdout.interface;
+
+    try w.writeAll("{\"zregexp\":");
+    try harness.writeJsonString(w, zregexp.version);
+    try w.writeAll(",\"simd_level\":");
+    try harness.writeJsonString(w, @tagName(zregexp.dispatch.activeLevel()));
+    try w.print(",\"options\":{{\"size\":{d},\"reps\":{d},\"warmup\":{d},\"seed\":{d},\"rules\":{d}}}", .{
+        options.size, options.reps, options.warmup, options.seed, options.rules,
+    });
+    try w.writeAll(",\"suites\":{");
+
+    // A suite over its ceilings, or with a run that regressed, still completes
+    // the document, then fails the run
+    var failed = false;
+    var first = true;
+    for (suites) |suite| {
+        if (names.items.len > 0 and !contains(names.items, suite.name)) continue;
+        try harness.writeKey(w, &first, suite.name);
+        suite.run(allocator, options, w) catch |err| switch (err) {
+            error.CeilingExceeded, error.RegressionDetected => failed = true,
+            else => return err,
+        };
+    }
+
+    try w.writeAll("}}\n");
+    try w.flush();
+    if (failed) std.process.exit(1);
+}
+
+fn findSuite(name: []const u8) ?Suite {
+    for (suites) |suite| {
+        if (std.mem.eql(u8, suite.name, name)) return suite;
+    }
+    return null;
+}
+
+fn contains(names: []const []const u8, name: []const u8) bool {
+    for (names) |n| {
+        if (std.mem.eql(u8, n, name)) return true;
+    }
+    return false;
+}
+
+fn usage() noreturn {
+    std.debug.print("usage: bench [suite...] [--size N] [--reps N] [--warmup N] [--filter S] [--seed N] [--rules N]\nsuites:", .{});
+    for (suites) |suite| std.debug.print(" {s}", .{suite.name});
+    std.debug.print("\n", .{});
+    std.process.exit(2);
+}
@@ -0,0 +1,189 @@
+//! Allocation benchmarks
+//!
+//! Compiles each pattern of the execution catalogue (execution.zig) with a
+//! CountingAllocator and runs every search op once per line of its corpus,
+//! reporting allocations, frees and bytes allocated per call, and per
+//! compile. Counts do not depend on timing, so one pass is enough.
+//!
+//! Each op has a ceiling: allocations per call, plus an allowance per match
+//! for the results the caller receives. A row over its ceiling is marked and
+//! makes the suite fail (the runner exits non-zero), so an allocation added
+//! to a search path is caught. Lower the ceilings as allocations are removed.
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const corpus = @import("corpus.zig");
+const execution = @import("execution.zig");
+const harness = @import("harness.zig");
+
+const Allocator = std.mem.Allocator;
+const Regex = zregexp.Regex;
+const CountingAllocator = zregexp.CountingAllocator;
+const AllocStats = zregexp.AllocStats;
+const Options = harness.Options;
+const Op = harness.Op;
+
+/// Lines searched per pattern
+const max_lines = 1000;
+
+/// Allowed allocations for one call
+const Ceiling = struct {
+    /// Fixed allowance per call (scratch, list growth)
+    per_call: f64,
+
+    /// Allowance per match returned to the caller
+    per_match: f64,
+
+    fn allows(self: Ceiling, allocations: u64, calls: u64, matches: u64) bool {
+        const limit = self.per_call * @as(f64, @floatFromInt(calls)) + self.per_match * @as(f64, @floatFromInt(matches));
+        return @as(f64, @floatFromInt(allocations)) <= limit;
+    }
+};
+
+/// Current ceilings, by op
+fn ceiling(op: Op) Ceiling {
+    return switch (op) {
+        // Existence only: nothing to hand back
+        .is_match => .{ .per_call = 0, .per_match = 0 },
+        // The match's capture array
+        .find => .{ .per_call = 0, .per_match = 1 },
+        // Capture arrays plus growth of the result list
+        .find_all => .{ .per_call = 16, .per_match = 1 },
+        // find_all plus growth of the output buffer
+        .replace => .{ .per_call = 32, .per_match = 1 },
+    };
+}
+
+/// Run the catalogue and write a JSON array of results; fails after writing
+/// when any op exceeds its ceiling
+pub fn run(allocator: Allocator, options: Options, w: *std.Io.Writer) !void {
+    var exceeded = false;
+    var first_result = true;
+    try w.writeByte('[');
+
+    var corpora: [std.meta.fields(corpus.Kind).len]?[]u8 = @splat(null);
+    defer {
+        for (corpora) |text| {
+            if (text) |t| allocator.free(t);
+        }
+    }
+
+    for (execution.catalogue) |case| {
+        if (!options.selects(case.name)) continue;
+        std.debug.print("allocations: {s}\n", .{case.name});
+
+        const slot = &corpora[@intFromEnum(case.corpus)];
+        if (slot.* == null) slot.* = try corpus.generate(allocator, case.corpus, options.size, options.seed);
+        const lines = try corpus.lines(allocator, slot.*.?);
+        defer allocator.free(lines);
+        const inputs = lines[0..@min(lines.len, max_lines)];
+
+        if (!first_result) try w.writeByte(',');
+        first_result = false;
+        if (!try runCase(allocator, w, case, inputs)) exceeded = true;
+    }
+
+    try w.writeByte(']');
+    if (exceeded) {
+        std.debug.print("allocations: ceiling exceeded\n", .{});
+        return error.CeilingExceeded;
+    }
+}
+
+/// Counters between two snapshots
+const Delta = struct {
+    allocations: u64,
+    frees: u64,
+    bytes: u64,
+
+    fn between(before: AllocStats, after: AllocStats) Delta {
+        const allocations = after.total_allocations - before.total_allocations;
+        const still_live = @as(i64, @intCast(after.live_allocations)) - @as(i64, @intCast(before.live_allocations));
+        return .{
+            .allocations = allocations,
+            .frees = @intCast(@as(i64, @intCast(allocations)) - still_live),
+            .bytes = after.total_bytes - before.total_bytes,
+        };
+    }
+
+    fn writeJson(self: Delta, w: *std.Io.Writer, first: *bool, calls: u64) !void {
+        const n: f64 = @floatFromInt(@max(calls, 1));
+        try harness.writeKey(w, first, "allocations_per_call");
+        try w.print("{d:.2}", .{@as(f64, @floatFromInt(self.allocations)) / n});
+        try harness.writeKey(w, first, "frees_per_call");
+        try w.print("{d:.2}", .{@as(f64, @floatFromInt(self.frees)) / n});
+        try harness.writeKey(w, first, "bytes_per_call");
+        try w.print("{d:.1}", .{@as(f64, @floatFromInt(self.bytes)) / n});
+    }
+};
+
+/// Write one case; returns false when an op exceeded its ceiling
+fn runCase(allocator: Allocator, w: *std.Io.Writer, case: execution.Case, inputs: []const []const u8) !bool {
+    var counting = CountingAllocator.init(allocator);
+    const counted = counting.allocator();
+
+    var first = true;
+    try w.writeByte('{');
+    try harness.writeKey(w, &first, "name");
+    try harness.writeJsonString(w, case.name);
+    try harness.writeKey(w, &first, "pattern");
+    try harness.writeJsonString(w, case.pattern);
+    try harness.writeKey(w, &first, "calls");
+    try w.print("{d}", .{inputs.len});
+
+    const before_compile = counting.stats();
+    const re = Regex.compile(counted, case.pattern) catch |err| {
+        try harness.writeKey(w, &first, "error");
+        try harness.writeJsonString(w, @errorName(err));
+        try w.writeByte('}');
+        return true;
+    };
+    defer re.deinit();
+    const after_compile = counting.stats();
+
+    try harness.writeKey(w, &first, "compile");
+    var compile_first = true;
+    try w.writeByte('{');
+    try Delta.between(before_compile, after_compile).writeJson(w, &compile_first, 1);
+    try harness.writeKey(w, &compile_first, "retained_allocations");
+    try w.print("{d}", .{after_compile.live_allocations - before_compile.live_allocations});
+    try w.writeByte('}');
+
+    var within = true;
+    for (std.enums.values(Op)) |op| {
+        try harness.writeKey(w, &first, @tagName(op));
+        var op_first = true;
+        try w.writeByte('{');
+
+        const before = counting.stats();
+        var matches: u64 = 0;
+        const failure: ?anyerror = for (inputs) |input| {
+            matches += harness.runOp(&re, op, input) catch |err| break err;
+        } else null;
+        const delta = Delta.between(before, counting.stats());
+
+        if (failure) |err| {
+            try harness.writeKey(w, &op_first, "error");
+            try harness.writeJsonString(w, @errorName(err));
+        }
+        try harness.writeKey(w, &op_first, "matches");
+        try w.print("{d}", .{matches});
+        try delta.writeJson(w, &op_first, inputs.len);
+
+        const limit = ceiling(op);
+        const ok = limit.allows(delta.allocations, inputs.len, matches);
+        try harness.writeKey(w, &op_first, "ceiling");
+        try w.print("{{\"per_call\":{d},\"per_match\":{d}}}", .{ limit.per_call, limit.per_match });
+        try harness.writeKey(w, &op_first, "within_ceiling");
+        try w.writeAll(if (ok) "true" else "false");
+        try w.writeByte('}');
+
+        if (!ok) {
+            std.debug.print("allocations: {s} {s} made {d} allocations in {d} calls\n", .{ case.name, @tagName(op), delta.allocations, inputs.len });
+            within = false;
+        }
+    }
+
+    try w.writeByte('}');
+    return within;
+}
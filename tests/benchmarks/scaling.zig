@@ -0,0 +1,338 @@
+//! Multi-threaded scaling benchmarks
+//!
+//! Runs the same search on 1, 2, 4 … threads up to the core count and reports
+//! how throughput grows. Every thread searches every line of the case's corpus
+//! once per repetition (fixed work per thread), so perfect scaling keeps the
+//! per-thread throughput flat and `efficiency` at 1.0:
+//!
+//!     efficiency(N) = throughput(N) / (N * throughput(1))
+//!
+//! Each case runs isMatch, find and findAll along two axes:
+//!
+//! - sharing: `shared` (one Regex used by every thread) or `per_thread` (each
+//!   thread compiles its own copy); a gap between them points at state the
+//!   threads contend on inside a Regex
+//! - allocator: `process` (the runner's thread-safe allocator) or `c_api` (a
+//!   DebugAllocator behind a CountingAllocator, as c_api.zig sets up for every
+//!   handle); a gap points at the allocator lock
+//!
+//! The ShardedSet worker pool is measured separately: the catalogue patterns
+//! as one rule set, run over the lines with matchBitmapBatch (throughput mode)
+//! and matchBitmap (latency mode) with N workers. Those rows do a fixed amount
+//! of work in total, so the same efficiency formula applies.
+
+const std = @import("std");
+const zregexp = @import("zregexp");
+const corpus = @import("corpus.zig");
+const execution = @import("execution.zig");
+const harness = @import("harness.zig");
+
+const Allocator = std.mem.Allocator;
+const Regex = zregexp.Regex;
+const ShardedSet = zregexp.ShardedSet;
+const CountingAllocator = zregexp.CountingAllocator;
+const Options = harness.Options;
+const Op = harness.Op;
+
+/// Catalogue entries run per thread count (one per family that allocates
+/// differently); --filter applies on top
+const case_names = [_][]const u8{
+    "literal/mozilla",
+    "class/digits",
+    "alternation/methods",
+    "lookaround/status",
+    "backref/element",
+};
+
+/// Ops run per case
+const ops = [_]Op{ .is_match, .find, .find_all };
+
+const Sharing = enum {
+    shared,
+    per_thread,
+};
+
+/// Allocator the regexes are compiled with (and search with)
+const Heap = enum {
+    process,
+    c_api,
+};
+
+/// Rules per ShardedSet shard, small enough that the catalogue makes several shards
+const max_shard_size = 2;
+
+/// Thread count after `n`: doubling, then the core count itself
+fn nextThreadCount(n: usize, cores: usize) ?usize {
+    if (n >= cores) return null;
+    return @min(n * 2, cores);
+}
+
+/// One thread's share of a run
+const Worker = struct {
+    re: *const Regex,
+    inputs: []const []const u8,
+    op: Op,
+    matches: u64 = 0,
+    err: ?anyerror = null,
+
+    fn work(self: *Worker) void {
+        self.matches = 0;
+        self.err = null;
+        for (self.inputs) |input| {
+            self.matches += harness.runOp(self.re, self.op, input) catch |err| {
+                self.err = err;
+                return;
+            };
+        }
+    }
+};
+
+/// N workers started together; the calling thread runs the first one
+/// Thread start-up is inside the timed region; it is small next to a pass over the corpus.
+const Team = struct {
+    workers: []Worker,
+    threads: []std.Thread,
+
+    fn call(self: *const Team) anyerror!u64 {
+        for (self.workers[1..], self.threads[0 .. self.workers.len - 1], 0..) |*worker, *thread, spawned| {
+            thread.* = std.Thread.spawn(.{}, Worker.work, .{worker}) catch |err| {
+                for (self.threads[0..spawned]) |t| t.join();
+                return err;
+            };
+        }
+        self.workers[0].work();
+        for (self.threads[0 .. self.workers.len - 1]) |thread| thread.join();
+
+        var matches: u64 = 0;
+        for (self.workers) |worker| {
+            if (worker.err) |err| return err;
+            matches += worker.matches;
+        }
+        return matches;
+    }
+};
+
+/// Run every case and the pool modes; writes a JSON object with both
+pub fn run(allocator: Allocator, options: Options, w: *std.Io.Writer) !void {
+    const cores = std.Thread.getCpuCount() catch 1;
+
+    try w.print("{{\"cores\":{d},\"regex\":[", .{cores});
+    var first_result = true;
+    for (execution.catalogue) |case| {
+        if (!isScalingCase(case.name) or !options.selects(case.name)) continue;
+
+        const text = try corpus.generate(allocator, case.corpus, options.size, options.seed);
+        defer allocator.free(text);
+        const lines = try corpus.lines(allocator, text);
+        defer allocator.free(lines);
+
+        for (ops) |op| {
+            for (std.enums.values(Heap)) |heap| {
+                for (std.enums.values(Sharing)) |sharing| {
+                    std.debug.print("scaling: {s} {s} {s} {s}\n", .{ case.name, @tagName(op), @tagName(heap), @tagName(sharing) });
+                    if (!first_result) try w.writeByte(',');
+                    first_result = false;
+                    try runRegexCase(allocator, options, w, cores, case, lines, op, heap, sharing);
+                }
+            }
+        }
+    }
+
+    try w.writeAll("],\"sharded_set\":[");
+    if (options.selects("sharded-set")) try runPool(allocator, options, w, cores);
+    try w.writeAll("]}");
+}
+
+fn isScalingCase(name: []const u8) bool {
+    for (case_names) |n| {
+        if (std.mem.eql(u8, n, name)) return true;
+    }
+    return false;
+}
+
+/// Throughput at one thread count, and the 1-thread baseline it is compared to
+const Point = struct {
+    threads: usize,
+    calls: u64,
+    bytes: u64,
+    time: harness.Summary,
+
+    fn callsPerSecond(self: Point) f64 {
+        return harness.perSecond(self.calls, self.time.median);
+    }
+
+    fn writeJson(self: Point, w: *std.Io.Writer, baseline: f64) !void {
+        const total = self.callsPerSecond();
+        const threads: f64 = @floatFromInt(self.threads);
+        try w.print("{{\"threads\":{d},\"calls_per_s\":{d:.0},\"calls_per_s_per_thread\":{d:.0},\"mb_per_s\":{d:.2},\"efficiency\":{d:.3},\"ns\":", .{
+            self.threads,
+            total,
+            total / threads,
+            harness.megabytesPerSecond(self.bytes, self.time.median),
+            if (baseline == 0) 0 else total / (threads * baseline),
+        });
+        try self.time.writeJson(w);
+        try w.writeByte('}');
+    }
+};
+
+fn runRegexCase(
+    allocator: Allocator,
+    options: Options,
+    w: *std.Io.Writer,
+    cores: usize,
+    case: execution.Case,
+    lines: []const []const u8,
+    op: Op,
+    heap: Heap,
+    sharing: Sharing,
+) !void {
+    var first = true;
+    try w.writeByte('{');
+    try harness.writeKey(w, &first, "name");
+    try harness.writeJsonString(w, case.name);
+    try harness.writeKey(w, &first, "op");
+    try harness.writeJsonString(w, @tagName(op));
+    try harness.writeKey(w, &first, "allocator");
+    try harness.writeJsonString(w, @tagName(heap));
+    try harness.writeKey(w, &first, "sharing");
+    try harness.writeJsonString(w, @tagName(sharing));
+
+    // Same setup as the C API's global allocator
+    var debug: std.heap.DebugAllocator(.{}) = .init;
+    defer _ = debug.deinit();
+    var counting = CountingAllocator.init(debug.allocator());
+    const regex_allocator = switch (heap) {
+        .process => allocator,
+        .c_api => counting.allocator(),
+    };
+
+    // Every copy is compiled and prepared up front, so no thread triggers a
+    // lazy tier promotion during the timed runs
+    const copies = try allocator.alloc(Regex, if (sharing == .shared) 1 else cores);
+    defer allocator.free(copies);
+    var compiled: usize = 0;
+    defer for (copies[0..compiled]) |re| re.deinit();
+    for (copies) |*re| {
+        re.* = Regex.compile(regex_allocator, case.pattern) catch |err| {
+            try harness.writeKey(w, &first, "error");
+            try harness.writeJsonString(w, @errorName(err));
+            try w.writeByte('}');
+            return;
+        };
+        compiled += 1;
+        try re.prepare(.{});
+    }
+
+    var line_bytes: u64 = 0;
+    for (lines) |line| line_bytes += line.len;
+
+    const workers = try allocator.alloc(Worker, cores);
+    defer allocator.free(workers);
+    const threads = try allocator.alloc(std.Thread, cores);
+    defer allocator.free(threads);
+    for (workers, 0..) |*worker, i| {
+        worker.* = .{ .re = &copies[if (sharing == .shared) 0 else i], .inputs = lines, .op = op };
+    }
+
+    try harness.writeKey(w, &first, "points");
+    try w.writeByte('[');
+    var sink: u64 = 0;
+    var baseline: f64 = 0;
+    var n: ?usize = 1;
+    while (n) |count| : (n = nextThreadCount(count, cores)) {
+        const team: Team = .{ .workers = workers[0..count], .threads = threads };
+        const time = harness.measure(allocator, options, &team, Team.call, &sink) catch |err| {
+            try w.writeAll("]");
+            try harness.writeKey(w, &first, "error");
+            try harness.writeJsonString(w, @errorName(err));
+            try w.writeByte('}');
+            return;
+        };
+        const point: Point = .{ .threads = count, .calls = count * lines.len, .bytes = count * line_bytes, .time = time };
+        if (count == 1) baseline = point.callsPerSecond() else try w.writeByte(',');
+        try point.writeJson(w, baseline);
+    }
+    try w.writeByte(']');
+    try w.writeByte('}');
+    std.mem.doNotOptimizeAway(sink);
+}
+
+/// Pool modes of ShardedSet
+const PoolMode = enum {
+    batch,
+    latency,
+};
+
+/// One pass of a pool mode over every line
+const PoolRun = struct {
+    set: *const ShardedSet,
+    inputs: []const []const u8,
+    mode: PoolMode,
+    bitmaps: []u64,
+
+    fn call(self: *const PoolRun) anyerror!u64 {
+        const words = self.set.bitmapWords();
+        switch (self.mode) {
+            .batch => try self.set.matchBitmapBatch(self.inputs, self.bitmaps),
+            .latency => {
+                for (self.inputs, 0..) |input, i| {
+                    try self.set.matchBitmap(input, self.bitmaps[i * words ..][0..words]);
+                }
+            },
+        }
+        var hits: u64 = 0;
+        for (self.bitmaps[0 .. self.inputs.len * words]) |word| hits += @popCount(word);
+        return hits;
+    }
+};
+
+/// The catalogue as one rule set over the weblog lines, per pool size
+fn runPool(allocator: Allocator, options: Options, w: *std.Io.Writer, cores: usize) !void {
+    var patterns: [execution.catalogue.len][]const u8 = undefined;
+    for (&patterns, execution.catalogue) |*pattern, case| pattern.* = case.pattern;
+
+    const text = try corpus.generate(allocator, .weblog, options.size, options.seed);
+    defer allocator.free(text);
+    const lines = try corpus.lines(allocator, text);
+    defer allocator.free(lines);
+    var line_bytes: u64 = 0;
+    for (lines) |line| line_bytes += line.len;
+
+    for (std.enums.values(PoolMode), 0..) |mode, m| {
+        std.debug.print("scaling: sharded-set {s}\n", .{@tagName(mode)});
+        if (m > 0) try w.writeByte(',');
+
+        var first = true;
+        try w.writeByte('{');
+        try harness.writeKey(w, &first, "name");
+        try harness.writeJsonString(w, "sharded-set");
+        try harness.writeKey(w, &first, "mode");
+        try harness.writeJsonString(w, @tagName(mode));
+        try harness.writeKey(w, &first, "rules");
+        try w.print("{d}", .{patterns.len});
+        try harness.writeKey(w, &first, "points");
+        try w.writeByte('[');
+
+        var sink: u64 = 0;
+        var baseline: f64 = 0;
+        var n: ?usize = 1;
+        while (n) |count| : (n = nextThreadCount(count, cores)) {
+            var set = try ShardedSet.compile(allocator, &patterns, .{}, .{ .max_shard_size = max_shard_size, .n_jobs = count });
+            defer set.deinit();
+            try set.prepare(.{});
+
+            const bitmaps = try allocator.alloc(u64, lines.len * set.bitmapWords());
+            defer allocator.free(bitmaps);
+
+            const pass: PoolRun = .{ .set = &set, .inputs = lines, .mode = mode, .bitmaps = bitmaps };
+            const time = try harness.measure(allocator, options, &pass, PoolRun.call, &sink);
+            const point: Point = .{ .threads = count, .calls = lines.len, .bytes = line_bytes, .time = time };
+            if (count == 1) baseline = point.callsPerSecond() else try w.writeByte(',');
+            try point.writeJson(w, baseline);
+        }
+
+        try w.writeAll("]}");
+        std.mem.doNotOptimizeAway(sink);
+    }
+}